@@ -4,14 +4,49 @@ import QtQuick.Controls 2.15
 import ManualAppCorePlugin 1.0
 
 Item {
+    id: root
+
+    // Template load started from the TO selection, -1 while none is running
+    property int loadJob: -1
+    property string loadNumberTO: ""
 
     StackView {
         id: stackView
 
         anchors.fill: parent
+        enabled: root.loadJob === -1
         initialItem: toSelectionScreen
     }
 
+    BusyIndicator {
+        anchors.centerIn: parent
+        running: root.loadJob !== -1
+    }
+
+    Connections {
+        target: DataManager
+
+        function onJobFinished(jobId, success, error) {
+            if (jobId !== root.loadJob)
+                return;
+            root.loadJob = -1;
+            if (!success)
+                return;
+            if (root.loadNumberTO === "TO-2") {
+                stackView.push("UploadReport.qml", {
+                    mode: "before",
+                    stackView: stackView,
+                    toSelectionScreen: toSelectionScreen
+                }, StackView.Immediate);
+            } else {
+                stackView.push("Services.qml", {
+                    stackView: stackView,
+                    toSelectionScreen: toSelectionScreen
+                }, StackView.Immediate);
+            }
+        }
+    }
+
     Component {
         id: toSelectionScreen
 
@@ -19,20 +54,10 @@ Item {
             onToSelected: function (file, numberTO) {
                 DataManager.setStartTime(Qt.formatDateTime(new Date(), "yyyy-MM-dd"));
                 DataManager.setCurrentNumberTO(numberTO);
-                DataManager.save(true);
-                if (DataManager.load(":/media/jsons/" + file))
-                    if(numberTO === "TO-2"){
-                        stackView.push("UploadReport.qml", {
-                            mode: "before",
-                            stackView: stackView,
-                            toSelectionScreen: toSelectionScreen
-                        }, StackView.Immediate);
-                    } else {
-                        stackView.push("Services.qml", {
-                            stackView: stackView,
-                            toSelectionScreen: toSelectionScreen
-                        }, StackView.Immediate);
-                    }
+                // Both jobs are queued under the new report, the load runs once the folder exists
+                DataManager.saveAsync(true);
+                root.loadNumberTO = numberTO;
+                root.loadJob = DataManager.loadAsync(":/media/jsons/" + file);
             }
         }
     }
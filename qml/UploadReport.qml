@@ -14,6 +14,8 @@ ColumnLayout {
     property string selectedFolderPath: ""
     property bool isProcessing: false
     property string mode
+    property int archiveJobId: -1
+    property real archiveProgress: 0
 
     property var stackView
     property var toSelectionScreen
@@ -29,30 +31,37 @@ ColumnLayout {
         }
 
         isProcessing = true;
+        archiveProgress = 0;
+        archiveJobId = DataManager.createArchiveAsync(selectedFolderPath, mode); // Pass mode
+    }
+
+    Connections {
+        target: DataManager
+
+        function onJobProgress(jobId, done, total) {
+            if (jobId === root.archiveJobId && total > 0)
+                root.archiveProgress = done / total;
+        }
 
-        var timer = Qt.createQmlObject('import QtQuick 2.0; Timer {}', parent);
-        timer.interval = 50;
-        timer.repeat = false;
-        timer.triggered.connect(function () {
-            var success = DataManager.createArchive(selectedFolderPath, mode); // Pass mode
-            isProcessing = false;
+        function onJobFinished(jobId, success, error) {
+            if (jobId !== root.archiveJobId)
+                return;
+            root.archiveJobId = -1;
+            root.isProcessing = false;
 
             if (success) {
-                if (mode == "before") {
-                    stackView.push("Services.qml", {
-                        stackView: stackView,
-                        toSelectionScreen: toSelectionScreen
+                if (root.mode == "before") {
+                    root.stackView.push("Services.qml", {
+                        stackView: root.stackView,
+                        toSelectionScreen: root.toSelectionScreen
                     }, StackView.Immediate);
                 } else {
-                    stackView.push("UploadWindow.qml", {
-                        stackView: stackView
+                    root.stackView.push("UploadWindow.qml", {
+                        stackView: root.stackView
                     }, StackView.Immediate);
                 }
             }
-
-            timer.destroy();
-        });
-        timer.start();
+        }
     }
 
     FolderDialog {
@@ -86,6 +95,13 @@ ColumnLayout {
         visible: root.isProcessing
     }
 
+    ProgressBar {
+        Layout.alignment: Qt.AlignHCenter
+        Layout.preferredWidth: 300
+        visible: root.isProcessing
+        value: root.archiveProgress
+    }
+
     Column {
         spacing: 10
         Layout.alignment: Qt.AlignHCenter
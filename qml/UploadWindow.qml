@@ -9,6 +9,8 @@ Item {
     id: root
 
     property var stackView
+    // Local save that has to finish before the upload steps start, -1 while none is running
+    property int saveJob: -1
     anchors.margins: 20
 
     Column {
@@ -19,7 +21,7 @@ Item {
 
         BusyIndicator {
             anchors.horizontalCenter: parent.horizontalCenter
-            running: uploadProcess.running
+            running: root.saveJob !== -1 || uploadProcess.running
             Material.accent: Theme.colorButtonPrimary
         }
 
@@ -50,7 +52,7 @@ Item {
             id: progressText
             topPadding: 2
             anchors.horizontalCenter: parent.horizontalCenter
-            text: qsTr("Step %1 of 4").arg(uploadProgress.value)
+            text: qsTr("Step %1 of 4").arg(Math.floor(uploadProgress.value))
             font.pixelSize: 14
             color: Theme.colorTextPrimary
         }
@@ -74,17 +76,6 @@ Item {
         running: false
         property bool hasError: false
 
-        ScriptAction {
-            script: {
-                statusText.text = qsTr("Saving data locally...");
-                DataManager.save(false);
-                uploadProgress.value = 1;
-            }
-        }
-        PauseAnimation {
-            duration: 1000
-        }
-
         ScriptAction {
             script: {
                 if (!uploadProcess.hasError) {
@@ -140,6 +131,27 @@ Item {
 
     Connections {
         target: DataManager
+
+        function onJobProgress(jobId, done, total) {
+            if (jobId === root.saveJob && total > 0)
+                uploadProgress.value = done / total;
+        }
+
+        function onJobFinished(jobId, success, error) {
+            if (jobId !== root.saveJob)
+                return;
+            root.saveJob = -1;
+            if (!success) {
+                statusText.text = qsTr("Error: %1").arg(error);
+                uploadProcess.hasError = true;
+                closeButton.visible = true;
+                closeButton.enabled = true;
+                return;
+            }
+            uploadProgress.value = 1;
+            uploadProcess.start();
+        }
+
         function onErrorOccurred(errorMessage) {
             statusText.text = qsTr("Error: %1").arg(errorMessage);
             uploadProcess.hasError = true;
@@ -149,5 +161,8 @@ Item {
         }
     }
 
-    Component.onCompleted: uploadProcess.start()
+    Component.onCompleted: {
+        statusText.text = qsTr("Saving data locally...");
+        root.saveJob = DataManager.saveAsync(false);
+    }
 }
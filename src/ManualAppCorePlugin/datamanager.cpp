@@ -9,10 +9,16 @@
 
 #include "file/fileservice.h"
 #include "file/loger.h"
+#include "file/reportindex.h"
+#include "file/reportioexecutor.h"
 #include "installmanager.h"
+#include "network/networkaccesspool.h"
+#include "network/reportsync.h"
+#include "network/reportuploader.h"
 #include "networkservice.h"
 #include "reportmanager.h"
 #include "settings/settingsmanager.h"
+#include "settings/settingsstore.h"
 #include "software/licensehandler.h"
 
 
@@ -20,11 +26,15 @@ DataManager::DataManager(QObject* parent)
     : QObject(parent)
 {
   FileService* fileService = new FileService(this);
+  Logger::startFileSink(fileService->getFullFilePath("logs"));
   NetworkService* networkService = new NetworkService(fileService, nullptr, this);
   m_reportManager = std::make_unique<ReportManager>(fileService, networkService, this);
   networkService->setReportManager(m_reportManager.get());
   m_licenseHandler = std::make_unique<LicenseHandler>(this);
   m_installManager = std::make_unique<InstallManager>(this, m_reportManager.get(), m_licenseHandler.get());
+  m_reportSync = std::make_unique<ReportSync>(
+      fileService->getFullFilePath("sync_manifest.json"), m_reportManager->reportIndex(),
+      m_reportManager->ioExecutor(), networkService->reportUploader(), this);
 
 
   DEBUG_COLORED("DataManager", "Constructor", "DataManager initialized", COLOR_CYAN, COLOR_CYAN);
@@ -37,6 +47,24 @@ DataManager::DataManager(QObject* parent)
   connect(m_reportManager.get(), &ReportManager::reportLoaded, this, &DataManager::dataLoaded);
   connect(m_reportManager.get(), &ReportManager::errorOccurred, this,
           [this](const QString& error) { setError(error); });
+
+  ReportIoExecutor* ioExecutor = m_reportManager->ioExecutor();
+  connect(ioExecutor, &ReportIoExecutor::jobStarted, this, &DataManager::jobStarted);
+  connect(ioExecutor, &ReportIoExecutor::jobProgress, this, &DataManager::jobProgress);
+  connect(ioExecutor, &ReportIoExecutor::jobFinished, this, &DataManager::jobFinished);
+  connect(ioExecutor, &ReportIoExecutor::pendingJobsChanged, this, [this]() {
+    emit pendingJobsChanged();
+    emit loadingChanged();
+  });
+
+  ReportUploader* uploader = networkService->reportUploader();
+  connect(uploader, &ReportUploader::progressChanged, this,
+          [this](int finishedReports, int totalReports, qint64 bytesSent, double bytesPerSecond) {
+            Q_UNUSED(bytesSent)
+            emit reportsUploadProgress(finishedReports, totalReports, bytesPerSecond);
+          });
+  connect(m_reportSync.get(), &ReportSync::listingFinished, this, [this]() { setLoading(false); });
+  connect(m_reportSync.get(), &ReportSync::finished, this, &DataManager::onReportUploadsFinished);
 }
 DataManager::~DataManager()
 {
@@ -47,8 +75,13 @@ void DataManager::shutdown()
 {
   DEBUG_COLORED("DataManager", "shutdown", "Stopping all operations", COLOR_CYAN, COLOR_CYAN);
 
-  m_pendingReports.clear();
-  m_isUploading = false;
+  m_reportSync->shutdown();
+  // Pending saves and archives still reach the disk
+  m_reportManager->ioExecutor()->waitForDone();
+  m_reportManager->reportIndex()->flush();
+  m_reportSync->flush();
+  SettingsStore::instance().flush();
+  Logger::stopFileSink();
 }
 QString DataManager::title() const
 {
@@ -134,6 +167,63 @@ bool DataManager::uploadReport(const QString& sourceFolderPath, bool after)
   return result;
 }
 
+int DataManager::loadAsync(const QString& filePath)
+{
+  DEBUG_COLORED("DataManager", "loadAsync", QString("Loading file: %1").arg(filePath), COLOR_CYAN,
+                COLOR_CYAN);
+  setError("");
+  return m_reportManager->loadReportAsync(filePath);
+}
+
+int DataManager::saveJsonAsync(const QString& path)
+{
+  DEBUG_COLORED("DataManager", "saveJsonAsync", QString("Saving JSON to: %1").arg(path), COLOR_CYAN,
+                COLOR_CYAN);
+  return m_reportManager->saveReportJsonAsync(path);
+}
+
+int DataManager::exportPdfAsync(const QString& path)
+{
+  DEBUG_COLORED("DataManager", "exportPdfAsync", QString("Exporting PDF to: %1").arg(path), COLOR_CYAN,
+                COLOR_CYAN);
+  return m_reportManager->exportReportToPdfAsync(path);
+}
+
+int DataManager::saveAsync(const bool first_save)
+{
+  DEBUG_COLORED("DataManager", "saveAsync", QString("Saving report, first save: %1").arg(first_save),
+                COLOR_CYAN, COLOR_CYAN);
+  return m_reportManager->saveReportAsync(first_save);
+}
+
+int DataManager::uploadReportAsync(const QString& sourceFolderPath, bool after)
+{
+  DEBUG_COLORED("DataManager", "uploadReportAsync",
+                QString("Uploading report from: %1, after: %2").arg(sourceFolderPath).arg(after), COLOR_CYAN,
+                COLOR_CYAN);
+  return m_reportManager->uploadReportAsync(sourceFolderPath, after);
+}
+
+int DataManager::createArchiveAsync(const QString& folderPath, const QString& mode)
+{
+  DEBUG_COLORED("DataManager", "createArchiveAsync",
+                QString("Creating archive from: %1 mode: %2").arg(folderPath).arg(mode), COLOR_CYAN,
+                COLOR_CYAN);
+  return m_reportManager->createArchiveAsync(folderPath, mode);
+}
+
+int DataManager::regenerateAllPdfs()
+{
+  DEBUG_COLORED("DataManager", "regenerateAllPdfs", "Regenerating PDFs of all stored reports", COLOR_CYAN,
+                COLOR_CYAN);
+  return m_reportManager->regenerateAllPdfsAsync();
+}
+
+int DataManager::pendingJobs() const
+{
+  return m_reportManager->ioExecutor()->pendingJobs();
+}
+
 void DataManager::setStepStatus(int index, Step::CompletionStatus status)
 {
   DEBUG_COLORED("DataManager", "setStepStatus", QString("Setting status for step: %1").arg(index), COLOR_CYAN,
@@ -148,10 +238,7 @@ void DataManager::setDefectDetails(int index, const QString& description, const
   DEBUG_COLORED("DataManager", "setDefectDetails", QString("Setting defect details for step: %1").arg(index),
                 COLOR_CYAN, COLOR_CYAN);
   if (index >= 0 && index < m_reportManager->stepsModel()->rowCount()) {
-    Step step = m_reportManager->stepsModel()->get(index);
-    step.completionStatus = Step::CompletionStatus::HasDefect;
-    step.defectDetails = {description, repairMethod, fixStatus};
-    m_reportManager->stepsModel()->updateStep(index, step);
+    m_reportManager->stepsModel()->setDefectDetails(index, {description, repairMethod, fixStatus});
     emit stepUpdated(index);
   }
 }
@@ -348,169 +435,21 @@ void DataManager::syncReportsWithServer()
                         COLOR_CYAN);
     return;
   }
-  QUrl apiUrl(QString(djangoBaseUrl() + "/api/" + SettingsManager().currentModel() + "/%1/get_reports")
-                  .arg(serialNumber));
+  const QString model = SettingsManager::instance()->currentModel();
 
   setLoading(true);
-  m_reportManager->networkService()->getJsonFromDjango(
-      apiUrl,
-      [this, serialNumber](const QJsonObject& json) {
-        processServerReports(json, serialNumber);
-        setLoading(false);
-      },
-      [this](const QString& error) {
-        DEBUG_ERROR_COLORED("DataManager", "syncReportsWithServer", "Error when receiving data: " + error,
-                            COLOR_CYAN, COLOR_CYAN);
-        setLoading(false);
-      });
+  m_reportSync->start(djangoBaseUrl(), serialNumber, model);
 }
 
-void DataManager::processServerReports(const QJsonObject& serverReports, const QString& serialNumber)
+void DataManager::onReportUploadsFinished(int succeeded, int failed)
 {
-  QString basePath = getReportDirPath();
-
-  m_pendingReports.clear();
-
-  QDate oneMonthAgo = QDate::currentDate().addMonths(-1).addDays(-1);
-
-  for (auto const& number_to : NumbersTO) {
-    QString toPath = basePath + number_to + "/";
-    QDir reportDir(toPath);
-
-    if (!reportDir.exists()) {
-      continue;
-    }
-
-    QStringList localReports = reportDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
-    QJsonArray onlineReports = serverReports[number_to].toArray();
-
-    QMap<QString, QJsonObject> onlineReportMap;
-
-    for (const auto& val : onlineReports) {
-      if (val.isObject()) {
-        QJsonObject reportObj = val.toObject();
-        QString date = reportObj["date"].toString();
-        onlineReportMap[date] = reportObj;
-      }
-    }
-    for (const auto& localReport : localReports) {
-      QDate reportDate = QDate::fromString(localReport, "yyyy-MM-dd");
-      QString fullReportPath = toPath + localReport;
-      QDir reportDir(fullReportPath);
-      if (reportDir.isEmpty()) {
-        if (reportDir.removeRecursively()) {
-          DEBUG_COLORED("DataManager", "processServerReports",
-                        QString("Deleted empty report: %1/%2").arg(number_to).arg(localReport), COLOR_CYAN,
-                        COLOR_CYAN);
-          continue;
-        } else {
-          DEBUG_ERROR_COLORED("DataManager", "processServerReports",
-                              QString("Failed to delete empty report: %1/%2").arg(number_to).arg(localReport),
-                              COLOR_CYAN, COLOR_CYAN);
-        }
-      }
-      if (reportDate.isValid() && reportDate < oneMonthAgo) {
-        if (QDir(fullReportPath).removeRecursively()) {
-          DEBUG_COLORED("DataManager", "processServerReports",
-                        QString("Deleted old report: %1/%2").arg(number_to).arg(localReport), COLOR_CYAN,
-                        COLOR_CYAN);
-        } else {
-          DEBUG_ERROR_COLORED("DataManager", "processServerReports",
-                              QString("Failed to delete old report: %1/%2").arg(number_to).arg(localReport),
-                              COLOR_CYAN, COLOR_CYAN);
-        }
-        continue;
-      }
-      if (onlineReportMap.contains(localReport)) {
-        QJsonObject serverReport = onlineReportMap[localReport];
-        bool jsonExists = serverReport["json"].toBool();
-        bool pdfExists = serverReport["pdf"].toBool();
-
-        if (!jsonExists || !pdfExists) {
-          m_pendingReports.enqueue({toPath + localReport + '/', localReport, number_to});
-        }
-      } else {
-        m_pendingReports.enqueue({toPath + localReport + '/', localReport, number_to});
-      }
-    }
-  }
-
-  DEBUG_COLORED("DataManager", "processServerReports",
-                QString("Found %1 reports to upload").arg(m_pendingReports.size()), COLOR_CYAN, COLOR_CYAN);
-
-  if (!m_pendingReports.isEmpty()) {
-    startNextUpload();
-  } else {
-    m_isUploading = false;
-    DEBUG_COLORED("DataManager", "processServerReports", "No reports to upload", COLOR_CYAN, COLOR_CYAN);
-  }
-}
-
-void DataManager::startNextUpload()
-{
-  if (QCoreApplication::closingDown()) {
-    DEBUG_COLORED("DataManager", "startNextUpload", "App is closing, stopping upload", COLOR_CYAN,
-                  COLOR_CYAN);
-    return;
-  }
-
-
-  if (m_pendingReports.isEmpty()) {
-    m_isUploading = false;
-    DEBUG_COLORED("DataManager", "startNextUpload", "All reports uploaded successfully", COLOR_CYAN,
-                  COLOR_CYAN);
-    emit allReportsUploaded();
-    return;
-  }
-
-  try {
-    m_isUploading = true;
-    QList nextReportList = m_pendingReports.dequeue();
-
-    DEBUG_COLORED("DataManager", "startNextUpload",
-                  QString("Starting upload of report: %1, remaining: %2")
-                      .arg(nextReportList[0])
-                      .arg(m_pendingReports.size()),
-                  COLOR_CYAN, COLOR_CYAN);
-
-    // Синхронная загрузка отчета
-    bool success = uploadReportSynchronous(nextReportList[0], nextReportList[1], nextReportList[2]);
-
-    if (!success) {
-      DEBUG_ERROR_COLORED("DataManager", "startNextUpload",
-                          QString("Failed to upload report: %1").arg(nextReportList[0]), COLOR_CYAN,
-                          COLOR_CYAN);
-    }
-
-    QCoreApplication::processEvents();
-    startNextUpload();
-
-  } catch (const std::exception& e) {
-    DEBUG_ERROR_COLORED("DataManager", "startNextUpload", QString("Exception: %1").arg(e.what()), COLOR_CYAN,
-                        COLOR_CYAN);
-    QCoreApplication::processEvents();
-    startNextUpload();
-  }
-}
-
-bool DataManager::uploadReportSynchronous(const QString& reportPath, const QString& uploadTime,
-                                          const QString& numberTO)
-{
-  DEBUG_COLORED("DataManager", "uploadReportSynchronous", QString("Synchronous upload: %1").arg(reportPath),
-                COLOR_CYAN, COLOR_CYAN);
-
-  QString apiUrl = djangoBaseUrl() + "/api/report/";
-  auto* networkService = m_reportManager->networkService();
-
-  QDir reportDir(reportPath);
-  if (!reportDir.exists()) {
-    DEBUG_ERROR_COLORED("DataManager", "uploadReportSynchronous",
-                        QString("Report directory doesn't exist: %1").arg(reportPath), COLOR_CYAN,
-                        COLOR_CYAN);
-    return false;
-  }
-
-  return networkService->uploadReportSynchronous(QUrl(apiUrl), reportPath, uploadTime, numberTO);
+  DEBUG_COLORED("DataManager", "onReportUploadsFinished",
+                QString("Reports uploaded: %1, failed: %2").arg(succeeded).arg(failed), COLOR_CYAN,
+                COLOR_CYAN);
+  DEBUG_COLORED("DataManager", "onReportUploadsFinished",
+                QString("Network usage: %1").arg(NetworkAccessPool::instance().statistics()), COLOR_CYAN,
+                COLOR_CYAN);
+  emit allReportsUploaded();
 }
 
 QStringList DataManager::getFixStatusOptions() const
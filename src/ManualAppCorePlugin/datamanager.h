@@ -6,7 +6,6 @@
 #include <QCoreApplication>
 #include <QObject>
 #include <QQmlEngine>
-#include <QQueue>
 #include <memory>
 
 #include "file/configmanager.h"
@@ -19,6 +18,7 @@
 class NetworkService;
 class FileService;
 class InstallManager;
+class ReportSync;
 
 class DataManager : public QObject
 {
@@ -30,6 +30,7 @@ class DataManager : public QObject
   Q_PROPERTY(QString title READ title NOTIFY titleChanged)
   Q_PROPERTY(bool isLoading READ isLoading NOTIFY loadingChanged)
   Q_PROPERTY(bool loading READ isLoading NOTIFY loadingChanged)
+  Q_PROPERTY(int pendingJobs READ pendingJobs NOTIFY pendingJobsChanged)
   Q_PROPERTY(QString error READ error NOTIFY errorOccurred)
   Q_PROPERTY(StepModel* stepsModel READ stepsModel CONSTANT)
   Q_PROPERTY(SettingsManager* settingsManager READ settingsManager WRITE setSettingsManager NOTIFY
@@ -50,6 +51,16 @@ public:
   Q_INVOKABLE void save(bool first_save);
   Q_INVOKABLE void revoke();
 
+  // Q_INVOKABLE methods - Asynchronous File Operations
+  // The work runs on the report I/O executor; each call returns a job id for jobProgress/jobFinished
+  Q_INVOKABLE int loadAsync(const QString& filePath);
+  Q_INVOKABLE int saveJsonAsync(const QString& path);
+  Q_INVOKABLE int exportPdfAsync(const QString& path);
+  Q_INVOKABLE int saveAsync(bool first_save);
+  Q_INVOKABLE int uploadReportAsync(const QString& sourceFolderPath, bool after);
+  Q_INVOKABLE int createArchiveAsync(const QString& folderPath, const QString& mode);
+  Q_INVOKABLE int regenerateAllPdfs();
+
   // Q_INVOKABLE methods - Report Operations
   Q_INVOKABLE bool uploadReport(const QString& sourceFolderPath, bool after);
   Q_INVOKABLE void uploadReportToDjango(const QUrl& apiUrl);
@@ -88,7 +99,9 @@ public:
 
   // Property getters
   QString title() const;
-  bool isLoading() const { return m_loading; }
+  // Also true while asynchronous jobs are queued or running
+  bool isLoading() const { return m_loading || pendingJobs() > 0; }
+  int pendingJobs() const;
   QString error() const { return m_error; }
   SettingsManager* settingsManager() const;
   StepModel* stepsModel();
@@ -104,11 +117,6 @@ public:
   Q_INVOKABLE void setSettingsManager(SettingsManager* manager);
   bool isValidApiUrl(const QUrl& apiUrl);
 
-  // Internal upload management
-  void startNextUpload();
-  void startNextUpload(const QUrl& apiUrl);
-  void processServerReports(const QJsonObject& serverReports, const QString& serialNumber);
-
   // Dir getters
   Q_INVOKABLE QString applicationDirPath() { return QCoreApplication::applicationDirPath(); }
 signals:
@@ -121,34 +129,32 @@ signals:
   void startTimeChanged();
   void settingsSyncFinished(bool success);
   void settingsUploadFinished(bool success);
+  void pendingJobsChanged();
 
   // Operation signals
   void dataLoaded();
   void stepUpdated(int index);
   void allReportsUploaded();
+  void reportsUploadProgress(int finishedReports, int totalReports, double bytesPerSecond);
+  void jobStarted(int jobId);
+  void jobProgress(int jobId, qint64 done, qint64 total);
+  void jobFinished(int jobId, bool success, const QString& error);
 
 private:
   // Private setters
   void setLoading(bool loading);
   void setError(const QString& error);
-
-  // Synchronous upload methods
-  bool uploadReportSynchronous(const QString& reportPath, const QString& uploadTime, const QString& numberTO);
+  void onReportUploadsFinished(int succeeded, int failed);
 
 private:
   // State management
   bool m_loading = false;
   QString m_error;
-  bool m_isUploading = false;
 
   // Core components
   std::unique_ptr<ReportManager> m_reportManager;
   std::unique_ptr<InstallManager> m_installManager;
   std::unique_ptr<LicenseHandler> m_licenseHandler;
 
-  // Upload queue management
-  QQueue<QList<QString>> m_pendingReports;
-
-  // Constants
-  static constexpr std::array<const char*, 3> NumbersTO = {"TO-1", "TO-2", "TO-3"};
+  std::unique_ptr<ReportSync> m_reportSync;
 };
\ No newline at end of file
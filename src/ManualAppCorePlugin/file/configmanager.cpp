@@ -34,6 +34,65 @@ QString ConfigManager::appVersion() const
 {
   return m_settings->value("app_version", "-").toString();
 }
+int ConfigManager::uploadConcurrency() const
+{
+  return qBound(1, m_settings->value("upload_concurrency", 2).toInt(), 8);
+}
+bool ConfigManager::deltaSync() const
+{
+  return m_settings->value("delta_sync", true).toBool();
+}
+int ConfigManager::uploadChunkSize() const
+{
+  // Size in KiB, 0 disables chunked uploads
+  const int sizeKb = m_settings->value("upload_chunk_size_kb", 0).toInt();
+  return sizeKb <= 0 ? 0 : qBound(256, sizeKb, 65536) * 1024;
+}
+int ConfigManager::archiveCompressionLevel() const
+{
+  // zlib level, -1 selects the zlib default
+  return qBound(-1, m_settings->value("archive_compression_level", -1).toInt(), 9);
+}
+int ConfigManager::archiveThreadCount() const
+{
+  // 0 uses every available core
+  return qMax(0, m_settings->value("archive_threads", 0).toInt());
+}
+int ConfigManager::progressUpdateRate() const
+{
+  // Progress signals per second at most
+  return qBound(1, m_settings->value("progress_update_hz", 20).toInt(), 100);
+}
+double ConfigManager::progressUpdateStep() const
+{
+  // Percent of the transfer between progress signals
+  return qBound(0.0, m_settings->value("progress_update_step", 1.0).toDouble(), 100.0);
+}
+bool ConfigManager::reportCbor() const
+{
+  // Also store reports as report.cbor, read in preference to report.json
+  return m_settings->value("report_cbor", false).toBool();
+}
+bool ConfigManager::cborUpload() const
+{
+  // Send report metadata as application/cbor, servers answering 415 get JSON
+  return m_settings->value("cbor_upload", false).toBool();
+}
+bool ConfigManager::gzipRequests() const
+{
+  // Request bodies go out with Content-Encoding: gzip
+  return m_settings->value("gzip_requests", false).toBool();
+}
+qint64 ConfigManager::gzipMinSize() const
+{
+  // Smaller bodies are not worth compressing
+  return qMax<qint64>(0, m_settings->value("gzip_min_bytes", 1024).toLongLong());
+}
+bool ConfigManager::dedupUpload() const
+{
+  // Archives are sent as content-defined chunks the server does not hold yet
+  return m_settings->value("dedup_upload", false).toBool();
+}
 void ConfigManager::printConfig() const
 {
   qDebug() << "Config path:" << m_configPath;
@@ -14,6 +14,18 @@ public:
 
   QString djangoBaseUrl() const;
   QString appVersion() const;
+  int uploadConcurrency() const;
+  bool deltaSync() const;
+  int uploadChunkSize() const;
+  int archiveCompressionLevel() const;
+  int archiveThreadCount() const;
+  int progressUpdateRate() const;
+  double progressUpdateStep() const;
+  bool reportCbor() const;
+  bool cborUpload() const;
+  bool gzipRequests() const;
+  qint64 gzipMinSize() const;
+  bool dedupUpload() const;
 
   void printConfig() const;
 
@@ -0,0 +1,83 @@
+#include "contentchunker.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <array>
+
+
+namespace
+{
+
+constexpr qint64 ReadBlockSize = 1024 * 1024;
+
+// 256 pseudo-random words from splitmix64 with a fixed seed
+const std::array<quint64, 256>& gearTable()
+{
+  static const std::array<quint64, 256> table = []() {
+    std::array<quint64, 256> result{};
+    quint64 state = 0x9e3779b97f4a7c15ULL;
+    for (quint64& value : result) {
+      state += 0x9e3779b97f4a7c15ULL;
+      quint64 z = state;
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      value = z ^ (z >> 31);
+    }
+    return result;
+  }();
+  return table;
+}
+
+} // namespace
+
+ContentChunker::Result ContentChunker::split(const QString& filePath)
+{
+  Result result;
+
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    result.error = QString("Cannot open %1").arg(filePath);
+    return result;
+  }
+
+  const std::array<quint64, 256>& gear = gearTable();
+  QCryptographicHash fileHash(QCryptographicHash::Sha256);
+  QCryptographicHash chunkHash(QCryptographicHash::Sha256);
+  QByteArray block(ReadBlockSize, Qt::Uninitialized);
+
+  quint64 hash = 0;
+  qint64 chunkStart = 0;
+  qint64 offset = 0;
+  for (;;) {
+    const qint64 read = file.read(block.data(), block.size());
+    if (read < 0) {
+      result.error = QString("Cannot read %1").arg(filePath);
+      return result;
+    }
+    if (read == 0) break;
+
+    fileHash.addData(QByteArrayView(block.constData(), read));
+    const auto* data = reinterpret_cast<const uchar*>(block.constData());
+    // Start of the part of the block not yet added to chunkHash
+    qint64 hashed = 0;
+    for (qint64 i = 0; i < read; ++i) {
+      hash = (hash << 1) + gear[data[i]];
+      const qint64 length = offset + i + 1 - chunkStart;
+      if ((length < MinChunkSize || (hash & BoundaryMask) != 0) && length < MaxChunkSize) continue;
+
+      chunkHash.addData(QByteArrayView(block.constData() + hashed, i + 1 - hashed));
+      result.chunks.append({chunkStart, length, chunkHash.result()});
+      chunkHash.reset();
+      hash = 0;
+      chunkStart = offset + i + 1;
+      hashed = i + 1;
+    }
+    chunkHash.addData(QByteArrayView(block.constData() + hashed, read - hashed));
+    offset += read;
+  }
+
+  if (offset > chunkStart) result.chunks.append({chunkStart, offset - chunkStart, chunkHash.result()});
+  result.fileSize = offset;
+  result.sha256 = fileHash.result();
+  return result;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+// Content-defined chunking with a gear rolling hash.
+// A chunk ends where the top bits of the hash over the last 64 bytes are clear, so boundaries follow the
+// content rather than fixed offsets: bytes inserted into or removed from a file only change the
+// chunks around the edit and every other chunk keeps its SHA-256. The gear table is fixed, the same
+// input gives the same chunks on every device.
+class ContentChunker
+{
+public:
+  struct Chunk {
+    qint64 offset = 0;
+    qint64 size = 0;
+    QByteArray sha256;
+  };
+
+  struct Result {
+    QList<Chunk> chunks;
+    qint64 fileSize = 0;
+    QByteArray sha256;
+    QString error;
+  };
+
+  static constexpr qint64 MinChunkSize = 16 * 1024;
+  static constexpr qint64 MaxChunkSize = 256 * 1024;
+  // 16 bits: a boundary every 64 KiB on average past MinChunkSize. The hash shifts left once per byte,
+  // so bit k depends on the last k + 1 bytes only; the top bits see a 49 to 64 byte window
+  static constexpr quint64 BoundaryMask = 0xffff000000000000ULL;
+
+  // Reads the file block by block; blocking, meant for a worker thread
+  static Result split(const QString& filePath);
+};
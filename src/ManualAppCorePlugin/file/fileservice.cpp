@@ -1,8 +1,10 @@
 #include "fileservice.h"
 
 #include <QFileInfo>
+#include <QSaveFile>
 
 #include "loger.h"
+#include "reportcodec.h"
 
 
 FileService::FileService(QObject* parent)
@@ -33,21 +35,21 @@ bool FileService::saveJsonToFile(const QString& filePath, const QJsonObject& jso
     }
   }
 
-  QFile file(filePath);
+  // Written to a temporary file and renamed over the target, a crash never leaves a torn report.json
+  QSaveFile file(filePath);
   if (!file.open(QIODevice::WriteOnly)) {
     logFileOperation("saveJsonToFile", filePath, false, "Failed to open file: " + file.errorString());
     return false;
   }
 
-  QJsonDocument jsonDoc(jsonObject);
-  QByteArray jsonData = jsonDoc.toJson();
+  // *.cbor files get the CBOR encoding of the same document
+  QByteArray jsonData = ReportCodec::encode(jsonObject, ReportCodec::formatFor(filePath));
   DEBUG_COLORED("FileService", "saveJsonToFile", QString("JSON data size: %1 bytes").arg(jsonData.size()),
                 COLOR_MAGENTA, COLOR_MAGENTA);
 
   qint64 bytesWritten = file.write(jsonData);
-  file.close();
 
-  if (bytesWritten == -1) {
+  if (bytesWritten == -1 || !file.commit()) {
     logFileOperation("saveJsonToFile", filePath, false, "Failed to write to file: " + file.errorString());
     return false;
   }
@@ -73,23 +75,16 @@ QJsonObject FileService::loadJsonFromFile(const QString& filePath)
   DEBUG_COLORED("FileService", "loadJsonFromFile", QString("Read %1 bytes from file").arg(jsonData.size()),
                 COLOR_MAGENTA, COLOR_MAGENTA);
 
-  QJsonParseError parseError;
-  QJsonDocument jsonDoc = QJsonDocument::fromJson(jsonData, &parseError);
-
-  if (parseError.error != QJsonParseError::NoError) {
-    logFileOperation(
-        "loadJsonFromFile", filePath, false,
-        QString("JSON parse error at offset %1: %2").arg(parseError.offset).arg(parseError.errorString()));
-    return QJsonObject();
-  }
-
-  if (!jsonDoc.isObject()) {
-    logFileOperation("loadJsonFromFile", filePath, false, "Document is not a JSON object");
+  // report.cbor and report.json are both accepted, the format is told by content
+  QString parseError;
+  QJsonObject jsonObject = ReportCodec::decode(jsonData, &parseError);
+  if (!parseError.isEmpty()) {
+    logFileOperation("loadJsonFromFile", filePath, false, parseError);
     return QJsonObject();
   }
 
   logFileOperation("loadJsonFromFile", filePath, true, "Successfully parsed JSON object");
-  return jsonDoc.object();
+  return jsonObject;
 }
 
 bool FileService::deleteFile(const QString& filePath)
@@ -138,15 +133,9 @@ QString FileService::getFileSize(const QString& filePath)
 void FileService::logFileOperation(const QString& operation, const QString& filePath, bool success,
                                    const QString& additionalInfo)
 {
-  QString logMessage = QString("%1: %2").arg(success ? "Success" : "Failed").arg(filePath);
-
-  if (!additionalInfo.isEmpty()) {
-    logMessage += " | " + additionalInfo;
-  }
-  if (success)
-    DEBUG_COLORED("FileService", operation, logMessage, COLOR_MAGENTA, COLOR_MAGENTA);
-  else
-    DEBUG_ERROR_COLORED("FileService", operation, logMessage, COLOR_MAGENTA, COLOR_MAGENTA);
+  const Logger::Level level = success ? Logger::Level::Debug : Logger::Level::Warning;
+  MANUALAPP_LOG(level, "FileService", operation, success ? "Success" : "Failed", COLOR_MAGENTA, COLOR_MAGENTA,
+                {"path", filePath}, {"info", additionalInfo});
 }
 
 QString FileService::ensureAppDataDirectory()
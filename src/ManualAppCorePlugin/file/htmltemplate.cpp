@@ -0,0 +1,91 @@
+#include "htmltemplate.h"
+
+
+HtmlTemplate::HtmlTemplate(const QString& source)
+    : m_source(source)
+{
+  qsizetype position = 0;
+  while (position < m_source.size()) {
+    const qsizetype open = m_source.indexOf(u"{{", position);
+    const qsizetype close = open < 0 ? -1 : m_source.indexOf(u"}}", open + 2);
+    const qsizetype literalEnd = close < 0 ? m_source.size() : open;
+
+    if (literalEnd > position) {
+      m_segments.append({position, literalEnd - position, -1, false});
+      m_literalSize += literalEnd - position;
+    }
+    if (close < 0) break;
+
+    QStringView name = QStringView(m_source).mid(open + 2, close - open - 2).trimmed();
+    Segment field;
+    if (name.startsWith(u'&')) {
+      field.escape = false;
+      name = name.mid(1).trimmed();
+    }
+    field.field = fieldIndex(name);
+    if (field.field < 0) {
+      field.field = m_fields.size();
+      m_fields.append(name.toString());
+    }
+    m_segments.append(field);
+    position = close + 2;
+  }
+}
+
+int HtmlTemplate::fieldIndex(QStringView name) const
+{
+  for (int i = 0; i < m_fields.size(); ++i)
+    if (m_fields.at(i) == name) return i;
+  return -1;
+}
+
+void HtmlTemplate::renderTo(QString& out, std::initializer_list<QStringView> values) const
+{
+  const QStringView* value = values.begin();
+  const int valueCount = static_cast<int>(values.size());
+
+  for (const Segment& segment : m_segments) {
+    if (segment.field < 0) {
+      out.append(QStringView(m_source).mid(segment.offset, segment.length));
+    } else if (segment.field < valueCount) {
+      // Missing values render as empty
+      if (segment.escape)
+        appendEscaped(out, value[segment.field]);
+      else
+        out.append(value[segment.field]);
+    }
+  }
+}
+
+QString HtmlTemplate::render(std::initializer_list<QStringView> values) const
+{
+  qsizetype size = m_literalSize;
+  for (QStringView value : values) size += value.size();
+
+  QString out;
+  out.reserve(size);
+  renderTo(out, values);
+  return out;
+}
+
+void HtmlTemplate::appendEscaped(QString& out, QStringView text)
+{
+  // Copies runs of plain text at once, only the special characters are expanded
+  qsizetype runStart = 0;
+  for (qsizetype i = 0; i < text.size(); ++i) {
+    const char16_t c = text.at(i).unicode();
+    const char* entity = nullptr;
+    switch (c) {
+      case u'<': entity = "&lt;"; break;
+      case u'>': entity = "&gt;"; break;
+      case u'&': entity = "&amp;"; break;
+      case u'"': entity = "&quot;"; break;
+      case u'\'': entity = "&#39;"; break;
+      default: continue;
+    }
+    out.append(text.mid(runStart, i - runStart));
+    out.append(QLatin1StringView(entity));
+    runStart = i + 1;
+  }
+  out.append(text.mid(runStart));
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <initializer_list>
+
+// HTML template parsed once into literal segments and placeholder slots.
+// "{{name}}" is replaced by an HTML-escaped value, "{{&name}}" by the value as is. Fields are numbered
+// in order of first appearance and values are passed in that order, so rendering is a single pass that
+// appends into the caller's buffer without rescanning the template.
+class HtmlTemplate
+{
+public:
+  explicit HtmlTemplate(const QString& source);
+
+  // Index of a named field, -1 if the template has none
+  int fieldIndex(QStringView name) const;
+  int fieldCount() const { return m_fields.size(); }
+  // Characters the template contributes besides its values, used to reserve output buffers
+  qsizetype literalSize() const { return m_literalSize; }
+
+  void renderTo(QString& out, std::initializer_list<QStringView> values) const;
+  QString render(std::initializer_list<QStringView> values) const;
+
+  static void appendEscaped(QString& out, QStringView text);
+
+private:
+  struct Segment {
+    // Range in m_source for literals, field index otherwise
+    qsizetype offset = 0;
+    qsizetype length = 0;
+    int field = -1;
+    bool escape = true;
+  };
+
+  QString m_source;
+  QList<Segment> m_segments;
+  QStringList m_fields;
+  qsizetype m_literalSize = 0;
+};
@@ -9,6 +9,8 @@
 #include <QString>
 #include <QTextStream>
 
+#include "logger.h"
+
 #define COLOR_RESET "\033[0m"
 #define COLOR_RED "\033[31m"
 #define COLOR_GREEN "\033[32m"
@@ -18,19 +20,12 @@
 #define COLOR_CYAN "\033[36m"
 #define COLOR_WHITE "\033[37m"
 
+// Message and colors are only evaluated when the category is enabled, see Logger
 #define DEBUG_COLORED(module, action, message, colorModule, colorAction)                                     \
-  do {                                                                                                       \
-    QString msg = QString(colorModule) + "[" + module + "]" + colorAction + "[" + action + "] " +            \
-                  COLOR_RESET + message;                                                                     \
-    qDebug().noquote() << msg;                                                                               \
-  } while (false)
+  MANUALAPP_LOG(Logger::Level::Debug, module, action, message, colorModule, colorAction, )
 
 #define DEBUG_ERROR_COLORED(module, action, message, colorModule, colorAction)                               \
-  do {                                                                                                       \
-    QString msg = QString(colorModule) + "[" + module + "]" + colorAction + "[" + action + "] " +            \
-                  COLOR_RED + message + COLOR_RESET;                                                         \
-    qWarning().noquote() << msg;                                                                             \
-  } while (false)
+  MANUALAPP_LOG(Logger::Level::Warning, module, action, message, colorModule, colorAction, )
 
 
 inline QString resolveResourcePath(const QString& filePath)
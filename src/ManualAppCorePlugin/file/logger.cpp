@@ -0,0 +1,329 @@
+#include "logger.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStringList>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+
+namespace
+{
+
+constexpr const char* ColorReset = "\033[0m";
+constexpr const char* ColorRed = "\033[31m";
+constexpr size_t RingCapacity = 4096;
+
+struct Record {
+  qint64 timeMs = 0;
+  Logger::Level level = Logger::Level::Debug;
+  QByteArray category;
+  QString action;
+  QString message;
+};
+
+// Bounded multi-producer queue: every slot carries a sequence number telling producers and the
+// consumer whose turn it is, so pushing is one compare-and-swap and never blocks on a lock
+class RingBuffer
+{
+public:
+  explicit RingBuffer(size_t capacity)
+      : m_slots(new Slot[capacity])
+      , m_mask(capacity - 1)
+  {
+    for (size_t i = 0; i < capacity; ++i) m_slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  bool push(Record&& record)
+  {
+    size_t position = m_head.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot& slot = m_slots[position & m_mask];
+      const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+      if (diff == 0) {
+        if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          slot.record = std::move(record);
+          slot.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        position = m_head.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool pop(Record& record)
+  {
+    size_t position = m_tail.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot& slot = m_slots[position & m_mask];
+      const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+      if (diff == 0) {
+        if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          record = std::move(slot.record);
+          slot.sequence.store(position + m_mask + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        position = m_tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+private:
+  struct Slot {
+    std::atomic<size_t> sequence;
+    Record record;
+  };
+
+  std::unique_ptr<Slot[]> m_slots;
+  const size_t m_mask;
+  alignas(64) std::atomic<size_t> m_head{0};
+  alignas(64) std::atomic<size_t> m_tail{0};
+};
+
+Logger::Level levelFromName(const QString& name)
+{
+  const QString level = name.trimmed().toLower();
+  if (level == "debug") return Logger::Level::Debug;
+  if (level == "info") return Logger::Level::Info;
+  if (level == "warning") return Logger::Level::Warning;
+  return Logger::Level::Error;
+}
+
+// Calls apply(module, level) for every "module=level" pair of a comma-separated rule list
+template <typename Apply>
+void forEachRule(const QString& rules, Apply apply)
+{
+  for (const QString& rule : rules.split(',', Qt::SkipEmptyParts)) {
+    const QStringList parts = rule.split('=');
+    if (parts.size() == 2) apply(parts.at(0).trimmed().toUtf8(), levelFromName(parts.at(1)));
+  }
+}
+
+struct Registry {
+  QMutex mutex;
+  QHash<QByteArray, Logger::Category*> categories;
+  QHash<QByteArray, int> rules;
+  int defaultLevel = 0;
+};
+
+Registry& registry()
+{
+  // Never destroyed: call sites keep references to the categories until the process exits
+  static Registry* instance = []() {
+    auto* created = new Registry;
+    const auto addRule = [created](const QByteArray& module, Logger::Level level) {
+      if (module == "*")
+        created->defaultLevel = static_cast<int>(level);
+      else
+        created->rules.insert(module, static_cast<int>(level));
+    };
+    forEachRule(qEnvironmentVariable("MANUALAPP_LOG"), addRule);
+    return created;
+  }();
+  return *instance;
+}
+
+struct FileSink {
+  QMutex mutex;
+  // Allocated on first start and kept, so producers never see it freed
+  std::atomic<RingBuffer*> ring{nullptr};
+  std::atomic<bool> running{false};
+  // Drops not yet reported in the file, and all drops since start
+  std::atomic<quint64> dropped{0};
+  std::atomic<quint64> droppedTotal{0};
+  std::thread thread;
+};
+
+FileSink& fileSink()
+{
+  static FileSink* sink = new FileSink;
+  return *sink;
+}
+
+const char* levelName(Logger::Level level)
+{
+  switch (level) {
+    case Logger::Level::Debug: return "DEBUG";
+    case Logger::Level::Info: return "INFO ";
+    case Logger::Level::Warning: return "WARN ";
+    case Logger::Level::Error: return "ERROR";
+  }
+  return "";
+}
+
+void appendFields(QString& message, std::initializer_list<Logger::Field> fields)
+{
+  for (const Logger::Field& field : fields) {
+    // Fields without a value are left out
+    const QString value = field.second.toString();
+    if (value.isEmpty()) continue;
+
+    message += ' ';
+    message += QLatin1StringView(field.first);
+    message += '=';
+    if (value.contains(' '))
+      message += '"' + value + '"';
+    else
+      message += value;
+  }
+}
+
+void rotate(QFile& file, const QString& dirPath, int maxFiles)
+{
+  file.close();
+  QDir dir(dirPath);
+  dir.remove(QString("manualapp.%1.log").arg(maxFiles));
+  for (int i = maxFiles - 1; i >= 1; --i)
+    dir.rename(QString("manualapp.%1.log").arg(i), QString("manualapp.%1.log").arg(i + 1));
+  dir.rename("manualapp.log", "manualapp.1.log");
+  file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
+}
+
+void runFileSink(RingBuffer* ring, QString dirPath, qint64 maxBytes, int maxFiles)
+{
+  FileSink& sink = fileSink();
+  QFile file(QDir(dirPath).filePath("manualapp.log"));
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+    qWarning().noquote() << "[Logger][runFileSink] Cannot open" << file.fileName();
+    sink.running.store(false);
+    return;
+  }
+
+  QByteArray batch;
+  Record record;
+  for (;;) {
+    // Read the flag first: records pushed before stopFileSink() are still drained below
+    const bool keepRunning = sink.running.load(std::memory_order_acquire);
+
+    batch.clear();
+    while (ring->pop(record)) {
+      batch += QDateTime::fromMSecsSinceEpoch(record.timeMs).toString(Qt::ISODateWithMs).toUtf8();
+      batch += ' ';
+      batch += levelName(record.level);
+      batch += " [" + record.category + "][" + record.action.toUtf8() + "] ";
+      batch += record.message.toUtf8();
+      batch += '\n';
+    }
+
+    const quint64 dropped = sink.dropped.exchange(0);
+    if (dropped > 0) batch += QString("%1 log records dropped\n").arg(dropped).toUtf8();
+
+    if (!batch.isEmpty()) {
+      file.write(batch);
+      file.flush();
+      if (file.size() > maxBytes) rotate(file, dirPath, maxFiles);
+    }
+
+    if (!keepRunning) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+}
+
+} // namespace
+
+Logger::Category& Logger::category(const char* module)
+{
+  Registry& reg = registry();
+  QMutexLocker locker(&reg.mutex);
+
+  const QByteArray name(module);
+  Category*& entry = reg.categories[name];
+  if (!entry) {
+    entry = new Category;
+    entry->name = name;
+    entry->minLevel.store(reg.rules.value(name, reg.defaultLevel), std::memory_order_relaxed);
+  }
+  return *entry;
+}
+
+void Logger::configure(const QString& rules)
+{
+  forEachRule(rules, [](const QByteArray& module, Level level) { setLevel(module, level); });
+}
+
+void Logger::setLevel(const QByteArray& module, Level level)
+{
+  Registry& reg = registry();
+  QMutexLocker locker(&reg.mutex);
+
+  const int value = static_cast<int>(level);
+  if (module == "*") {
+    reg.defaultLevel = value;
+    for (auto it = reg.categories.begin(); it != reg.categories.end(); ++it)
+      if (!reg.rules.contains(it.key())) it.value()->minLevel.store(value, std::memory_order_relaxed);
+    return;
+  }
+
+  reg.rules.insert(module, value);
+  if (Category* entry = reg.categories.value(module)) entry->minLevel.store(value, std::memory_order_relaxed);
+}
+
+void Logger::write(Level level, const Category& category, const QString& action, const QString& message,
+                   const char* colorModule, const char* colorAction, std::initializer_list<Field> fields)
+{
+  QString text = message;
+  appendFields(text, fields);
+
+  const bool isError = level >= Level::Warning;
+  const QString line = QString(colorModule ? colorModule : "") + "[" + QLatin1StringView(category.name) +
+                       "]" + (colorAction ? colorAction : "") + "[" + action + "] " +
+                       (isError ? ColorRed : ColorReset) + text + (isError ? ColorReset : "");
+  if (isError)
+    qWarning().noquote() << line;
+  else
+    qDebug().noquote() << line;
+
+  FileSink& sink = fileSink();
+  if (!sink.running.load(std::memory_order_relaxed)) return;
+
+  RingBuffer* ring = sink.ring.load(std::memory_order_acquire);
+  Record record{QDateTime::currentMSecsSinceEpoch(), level, category.name, action, std::move(text)};
+  if (!ring->push(std::move(record))) {
+    sink.dropped.fetch_add(1, std::memory_order_relaxed);
+    sink.droppedTotal.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void Logger::startFileSink(const QString& dirPath, qint64 maxBytes, int maxFiles)
+{
+  FileSink& sink = fileSink();
+  QMutexLocker locker(&sink.mutex);
+  if (sink.running.load()) return;
+  if (!QDir().mkpath(dirPath)) {
+    qWarning().noquote() << "[Logger][startFileSink] Cannot create" << dirPath;
+    return;
+  }
+
+  if (sink.thread.joinable()) sink.thread.join();
+  if (!sink.ring.load()) sink.ring.store(new RingBuffer(RingCapacity), std::memory_order_release);
+
+  sink.running.store(true, std::memory_order_release);
+  sink.thread = std::thread(runFileSink, sink.ring.load(), dirPath, maxBytes, qMax(1, maxFiles));
+}
+
+void Logger::stopFileSink()
+{
+  FileSink& sink = fileSink();
+  QMutexLocker locker(&sink.mutex);
+  sink.running.store(false, std::memory_order_release);
+  if (sink.thread.joinable()) sink.thread.join();
+}
+
+quint64 Logger::droppedRecords()
+{
+  return fileSink().droppedTotal.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+#include <atomic>
+#include <initializer_list>
+#include <utility>
+
+// Calls below this level compile to nothing: 0 debug, 1 info, 2 warning, 3 error.
+// Release builds can pass -DMANUALAPP_LOG_MIN_LEVEL=1 to drop debug logging entirely.
+#ifndef MANUALAPP_LOG_MIN_LEVEL
+#define MANUALAPP_LOG_MIN_LEVEL 0
+#endif
+
+// Level-filtered logging behind the LOG_* and DEBUG_*COLORED macros.
+// Every call site resolves its category once; a disabled call costs one relaxed atomic load and
+// never evaluates its message or fields. Enabled records go to the console and, once
+// startFileSink() has run, through a lock-free ring buffer to a rotating file written on a
+// background thread, so field devices keep a persistent log.
+class Logger
+{
+public:
+  enum class Level { Debug = 0, Info, Warning, Error };
+
+  struct Category {
+    QByteArray name;
+    std::atomic<int> minLevel{0};
+  };
+
+  // Structured key/value data attached to a record, e.g. {"bytes", size}
+  using Field = std::pair<const char*, QVariant>;
+
+  // Categories live for the whole process, so call sites may keep the reference
+  static Category& category(const char* module);
+  static bool isEnabled(const Category& category, Level level)
+  {
+    return static_cast<int>(level) >= category.minLevel.load(std::memory_order_relaxed);
+  }
+
+  // Rules like "*=info,ReportManager=debug", read from MANUALAPP_LOG on first use.
+  // "*" sets the level of every category without a rule of its own.
+  static void configure(const QString& rules);
+  static void setLevel(const QByteArray& module, Level level);
+
+  static void write(Level level, const Category& category, const QString& action, const QString& message,
+                    const char* colorModule, const char* colorAction,
+                    std::initializer_list<Field> fields = {});
+
+  // Writes records to dirPath/manualapp.log, which is rotated into manualapp.1.log and so on once it
+  // grows past maxBytes; only the newest maxFiles rotated files are kept
+  static void startFileSink(const QString& dirPath, qint64 maxBytes = 4 * 1024 * 1024, int maxFiles = 5);
+  // Writes every queued record and stops the sink thread
+  static void stopFileSink();
+  // Records lost because the sink fell behind and the ring buffer was full
+  static quint64 droppedRecords();
+};
+
+#define MANUALAPP_LOG(level, module, action, message, colorModule, colorAction, ...)                        \
+  do {                                                                                                       \
+    if (static_cast<int>(level) < MANUALAPP_LOG_MIN_LEVEL) break;                                            \
+    static Logger::Category& logCategory = Logger::category(module);                                         \
+    if (!Logger::isEnabled(logCategory, level)) break;                                                       \
+    Logger::write(level, logCategory, action, message, colorModule, colorAction, {__VA_ARGS__});             \
+  } while (false)
+
+// Structured variants; fields follow the message: LOG_INFO("Module", "action", "text", {"key", value})
+#define LOG_DEBUG(module, action, message, ...)                                                              \
+  MANUALAPP_LOG(Logger::Level::Debug, module, action, message, nullptr, nullptr, __VA_ARGS__)
+#define LOG_INFO(module, action, message, ...)                                                               \
+  MANUALAPP_LOG(Logger::Level::Info, module, action, message, nullptr, nullptr, __VA_ARGS__)
+#define LOG_WARNING(module, action, message, ...)                                                            \
+  MANUALAPP_LOG(Logger::Level::Warning, module, action, message, nullptr, nullptr, __VA_ARGS__)
+#define LOG_ERROR(module, action, message, ...)                                                              \
+  MANUALAPP_LOG(Logger::Level::Error, module, action, message, nullptr, nullptr, __VA_ARGS__)
@@ -0,0 +1,246 @@
+#include "parallelarchiver.h"
+
+#include <quazip.h>
+#include <quazipfile.h>
+#include <quazipnewinfo.h>
+#include <zlib.h>
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include "loger.h"
+
+
+namespace
+{
+
+constexpr qint64 ReadBlockSize = 256 * 1024;
+
+} // namespace
+
+ParallelArchiver::ParallelArchiver(QObject* parent)
+    : ParallelArchiver(Options(), parent)
+{
+}
+
+ParallelArchiver::ParallelArchiver(const Options& options, QObject* parent)
+    : QObject(parent)
+    , m_options(options)
+{
+}
+
+bool ParallelArchiver::compressDir(const QString& zipPath, const QString& dirPath)
+{
+  m_error.clear();
+  m_sizeLimitExceeded = false;
+  m_totalSize = 0;
+
+  QDir sourceDir(dirPath);
+  if (!sourceDir.exists()) {
+    m_error = QString("Directory does not exist: %1").arg(dirPath);
+    return false;
+  }
+
+  QElapsedTimer timer;
+  timer.start();
+
+  const QString absoluteZipPath = QFileInfo(zipPath).absoluteFilePath();
+  QList<Entry> entries;
+  if (!collectEntries(sourceDir.absolutePath(), sourceDir.absolutePath(), absoluteZipPath, entries)) {
+    m_sizeLimitExceeded = true;
+    m_error = QString("Folder exceeds %1 bytes").arg(m_options.maxTotalSize);
+    DEBUG_ERROR_COLORED("ParallelArchiver", "compressDir", m_error, COLOR_MAGENTA, COLOR_MAGENTA);
+    return false;
+  }
+  const qint64 expectedSize = m_totalSize;
+  emit progressChanged(0, expectedSize);
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(m_options.threadCount > 0 ? m_options.threadCount : QThread::idealThreadCount());
+
+  // Results come back in input order; the writer below consumes them while later entries still compress
+  const int level = m_options.compressionLevel;
+  QFuture<CompressedEntry> future =
+      QtConcurrent::mapped(&pool, entries, [level](const Entry& entry) -> CompressedEntry {
+        if (entry.isDir) return CompressedEntry();
+        return deflateFile(entry.sourcePath, level);
+      });
+
+  QDir().mkpath(QFileInfo(zipPath).absolutePath());
+  QuaZip zip(zipPath);
+  if (!zip.open(QuaZip::mdCreate)) {
+    future.cancel();
+    future.waitForFinished();
+    m_error = QString("Cannot create archive: %1").arg(zipPath);
+    return false;
+  }
+
+  qint64 totalSize = 0;
+  qint64 compressedSize = 0;
+  for (int i = 0; i < entries.size() && m_error.isEmpty(); ++i) {
+    const Entry& entry = entries.at(i);
+    const CompressedEntry compressed = future.resultAt(i);
+
+    QuaZipFile zipFile(&zip);
+    if (entry.isDir) {
+      if (!zipFile.open(QIODevice::WriteOnly, QuaZipNewInfo(entry.name, entry.sourcePath), nullptr, 0, 0))
+        m_error = QString("Cannot add directory %1").arg(entry.name);
+      zipFile.close();
+      continue;
+    }
+
+    if (!compressed.error.isEmpty()) {
+      m_error = compressed.error;
+      break;
+    }
+
+    QuaZipNewInfo info(entry.name, entry.sourcePath);
+    info.uncompressedSize = static_cast<ulong>(compressed.size);
+    if (!zipFile.open(QIODevice::WriteOnly, info, nullptr, compressed.crc, Z_DEFLATED, level, true) ||
+        zipFile.write(compressed.data) != compressed.data.size()) {
+      m_error = QString("Cannot write %1 to archive").arg(entry.name);
+    }
+    zipFile.close();
+    if (zipFile.getZipError() != ZIP_OK && m_error.isEmpty())
+      m_error = QString("Cannot write %1 to archive").arg(entry.name);
+
+    totalSize += compressed.size;
+    compressedSize += compressed.data.size();
+    emit progressChanged(totalSize, qMax(totalSize, expectedSize));
+
+    // Files may have grown after the walk; the budget applies to what was actually archived
+    if (m_options.maxTotalSize > 0 && totalSize > m_options.maxTotalSize) {
+      m_sizeLimitExceeded = true;
+      m_totalSize = totalSize;
+      m_error = QString("Folder exceeds %1 bytes").arg(m_options.maxTotalSize);
+    }
+  }
+
+  future.cancel();
+  future.waitForFinished();
+
+  zip.close();
+  if (m_error.isEmpty() && zip.getZipError() != ZIP_OK) m_error = "Cannot finalize archive";
+
+  if (!m_error.isEmpty()) {
+    DEBUG_ERROR_COLORED("ParallelArchiver", "compressDir", m_error, COLOR_MAGENTA, COLOR_MAGENTA);
+    QFile::remove(zipPath);
+    return false;
+  }
+
+  DEBUG_COLORED("ParallelArchiver", "compressDir",
+                QString("%1 entries, %2 -> %3 bytes in %4 ms on %5 threads")
+                    .arg(entries.size())
+                    .arg(totalSize)
+                    .arg(compressedSize)
+                    .arg(timer.elapsed())
+                    .arg(pool.maxThreadCount()),
+                COLOR_MAGENTA, COLOR_MAGENTA);
+  return true;
+}
+
+bool ParallelArchiver::collectEntries(const QString& dirPath, const QString& rootPath, const QString& zipPath,
+                                      QList<Entry>& entries)
+{
+  QDir dir(dirPath);
+  QDir rootDir(rootPath);
+
+  // Same order as JlCompress::compressSubDir: directory entry, subdirectories, then files
+  if (dirPath != rootPath) entries.append({rootDir.relativeFilePath(dirPath) + "/", dirPath, true});
+
+  // One listing per directory; QFileInfo caches the stat done while listing
+  const QFileInfoList children = dir.entryInfoList(QDir::AllDirs | QDir::Files | QDir::NoDotAndDotDot);
+  for (const QFileInfo& child : children) {
+    if (child.isDir() && !collectEntries(child.absoluteFilePath(), rootPath, zipPath, entries)) return false;
+  }
+
+  for (const QFileInfo& child : children) {
+    if (!child.isFile() || child.absoluteFilePath() == zipPath) continue;
+
+    m_totalSize += child.size();
+    if (m_options.maxTotalSize > 0 && m_totalSize > m_options.maxTotalSize) return false;
+
+    entries.append({rootDir.relativeFilePath(child.absoluteFilePath()), child.absoluteFilePath(), false});
+  }
+  return true;
+}
+
+ParallelArchiver::CompressedEntry ParallelArchiver::deflateFile(const QString& filePath, int level)
+{
+  CompressedEntry result;
+
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    result.error = QString("Cannot open %1").arg(filePath);
+    return result;
+  }
+
+  z_stream stream{};
+  // Negative window bits: raw deflate without zlib header, as stored in zip entries
+  if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    result.error = QString("Cannot initialize deflate for %1").arg(filePath);
+    return result;
+  }
+
+  result.data.resize(static_cast<qsizetype>(deflateBound(&stream, static_cast<uLong>(file.size()))));
+  stream.next_out = reinterpret_cast<Bytef*>(result.data.data());
+  stream.avail_out = static_cast<uInt>(result.data.size());
+
+  uLong crc = crc32(0L, Z_NULL, 0);
+  int status = Z_OK;
+  int flush = Z_NO_FLUSH;
+
+  // Deflate straight from the page cache when the file can be mapped, otherwise read it block by block
+  const qint64 mappedSize = file.size();
+  uchar* mapped = mappedSize > 0 ? file.map(0, mappedSize) : nullptr;
+  QByteArray block;
+  if (!mapped) block.resize(ReadBlockSize);
+
+  while (status != Z_STREAM_END) {
+    if (stream.avail_in == 0 && flush == Z_NO_FLUSH) {
+      Bytef* input = nullptr;
+      qint64 read = 0;
+      if (mapped) {
+        input = mapped + result.size;
+        read = qMin(ReadBlockSize, mappedSize - result.size);
+      } else {
+        input = reinterpret_cast<Bytef*>(block.data());
+        read = file.read(block.data(), block.size());
+      }
+      if (read < 0) {
+        result.error = QString("Cannot read %1").arg(filePath);
+        break;
+      }
+      crc = crc32(crc, input, static_cast<uInt>(read));
+      result.size += read;
+      stream.next_in = input;
+      stream.avail_in = static_cast<uInt>(read);
+      if (read == 0 || (mapped ? result.size >= mappedSize : file.atEnd())) flush = Z_FINISH;
+    }
+
+    // The file may have grown since deflateBound() was computed
+    if (stream.avail_out == 0) {
+      const qsizetype used = result.data.size();
+      result.data.resize(used * 2);
+      stream.next_out = reinterpret_cast<Bytef*>(result.data.data() + used);
+      stream.avail_out = static_cast<uInt>(result.data.size() - used);
+    }
+
+    status = deflate(&stream, flush);
+    if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR) {
+      result.error = QString("Deflate failed for %1").arg(filePath);
+      break;
+    }
+  }
+
+  if (mapped) file.unmap(mapped);
+  result.data.resize(static_cast<qsizetype>(stream.total_out));
+  result.crc = static_cast<quint32>(crc);
+  deflateEnd(&stream);
+  return result;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+// Zip archiver that deflates entries concurrently.
+// The source tree is listed once (one stat per file) and the size budget is enforced during that walk,
+// so an oversized folder is rejected before anything is compressed. Every file is then compressed on
+// a thread pool into a memory buffer (raw deflate + CRC-32); a single writer stores the precompressed
+// entries in order through QuaZip's raw mode, which writes the local headers and the central directory.
+// The archive layout matches JlCompress::compressDir.
+class ParallelArchiver : public QObject
+{
+  Q_OBJECT
+public:
+  struct Options {
+    // zlib level, -1 is Z_DEFAULT_COMPRESSION
+    int compressionLevel = -1;
+    // 0 uses QThread::idealThreadCount()
+    int threadCount = 0;
+    // Upper bound for the uncompressed size of the folder, 0 means unlimited
+    qint64 maxTotalSize = 0;
+  };
+
+  explicit ParallelArchiver(QObject* parent = nullptr);
+  explicit ParallelArchiver(const Options& options, QObject* parent = nullptr);
+
+  bool compressDir(const QString& zipPath, const QString& dirPath);
+  QString errorString() const { return m_error; }
+  bool sizeLimitExceeded() const { return m_sizeLimitExceeded; }
+  // Uncompressed bytes seen so far; when the limit is exceeded the walk stops at the first byte over it
+  qint64 totalSize() const { return m_totalSize; }
+
+signals:
+  void progressChanged(qint64 processedBytes, qint64 totalBytes);
+
+private:
+  struct Entry {
+    QString name;
+    QString sourcePath;
+    bool isDir = false;
+  };
+
+  struct CompressedEntry {
+    QByteArray data;
+    quint32 crc = 0;
+    qint64 size = 0;
+    QString error;
+  };
+
+  bool collectEntries(const QString& dirPath, const QString& rootPath, const QString& zipPath,
+                      QList<Entry>& entries);
+  static CompressedEntry deflateFile(const QString& filePath, int level);
+
+private:
+  Options m_options;
+  QString m_error;
+  bool m_sizeLimitExceeded = false;
+  qint64 m_totalSize = 0;
+};
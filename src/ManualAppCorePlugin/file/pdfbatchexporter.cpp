@@ -0,0 +1,117 @@
+#include "pdfbatchexporter.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <vector>
+
+#include "loger.h"
+#include "pdfexporter.h"
+#include "reportcodec.h"
+#include "reporthtmlbuilder.h"
+
+
+PdfBatchExporter::PdfBatchExporter(const QString& reportsRoot, QObject* parent)
+    : QObject(parent)
+    , m_root(reportsRoot)
+{
+}
+
+QList<PdfBatchExporter::Result> PdfBatchExporter::run(const QList<Target>& targets, int threadCount)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  QDir().mkpath(m_root + "TOs/");
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(threadCount > 0 ? threadCount : QThread::idealThreadCount());
+
+  QFuture<Result> future = QtConcurrent::mapped(&pool, targets, [this](const Target& target) {
+    return exportReport(target);
+  });
+
+  QList<Result> results;
+  results.reserve(targets.size());
+  int failed = 0;
+  qint64 bytes = 0;
+  emit progressChanged(0, targets.size());
+
+  // Results are consumed in order while later reports are still rendering
+  for (int i = 0; i < targets.size(); ++i) {
+    const Result result = future.resultAt(i);
+    if (!result.error.isEmpty()) {
+      ++failed;
+      DEBUG_ERROR_COLORED("PdfBatchExporter", "run",
+                          QString("%1/%2: %3").arg(result.target.numberTO, result.target.date, result.error),
+                          COLOR_MAGENTA, COLOR_MAGENTA);
+    } else {
+      DEBUG_COLORED("PdfBatchExporter", "run",
+                    QString("%1/%2: %3 bytes in %4 ms")
+                        .arg(result.target.numberTO, result.target.date)
+                        .arg(result.bytes)
+                        .arg(result.elapsedMs),
+                    COLOR_MAGENTA, COLOR_MAGENTA);
+    }
+    bytes += result.bytes;
+    results.append(result);
+    emit progressChanged(i + 1, targets.size());
+  }
+
+  const qint64 elapsed = qMax<qint64>(1, timer.elapsed());
+  DEBUG_COLORED("PdfBatchExporter", "run",
+                QString("%1 reports (%2 failed), %3 bytes in %4 ms on %5 threads, %6 reports/s")
+                    .arg(targets.size())
+                    .arg(failed)
+                    .arg(bytes)
+                    .arg(elapsed)
+                    .arg(pool.maxThreadCount())
+                    .arg(targets.size() * 1000.0 / elapsed, 0, 'f', 1),
+                COLOR_MAGENTA, COLOR_MAGENTA);
+  return results;
+}
+
+PdfBatchExporter::Result PdfBatchExporter::exportReport(const Target& target) const
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  Result result;
+  result.target = target;
+
+  const QString reportPath = m_root + target.numberTO + "/" + target.date + "/";
+  const QString reportFile = ReportCodec::preferredFile(QDir(reportPath));
+  const QJsonObject json = ReportCodec::readFile(reportFile, &result.error);
+  if (!result.error.isEmpty()) return result;
+
+  if (!json.value("title").isString() || !json.value("steps").isArray()) {
+    result.error = QString("Invalid report %1").arg(reportFile);
+    return result;
+  }
+
+  ReportHtmlBuilder::Report report;
+  report.title = json.value("title").toString();
+  report.serialNumber = json.value("serials").toObject().value("serial_number").toString();
+  report.date = QFileInfo(reportFile).lastModified().toString("dd.MM.yyyy HH:mm");
+  std::vector<Step> steps;
+  for (const QJsonValue& step : json.value("steps").toArray())
+    if (step.isObject()) steps.push_back(Step::fromJson(step.toObject(), true));
+  report.steps = steps;
+
+  const QByteArray pdf = PdfExporter::renderPdf(ReportHtmlBuilder::build(report));
+  const QString stablePath = m_root + "TOs/" + target.date + "-" + target.numberTO + ".pdf";
+  if (pdf.isEmpty() || !PdfExporter::writePdf(pdf, {reportPath + "report.pdf", stablePath})) {
+    result.error = "PDF export failed";
+    return result;
+  }
+
+  result.bytes = pdf.size();
+  result.elapsedMs = timer.elapsed();
+  return result;
+}
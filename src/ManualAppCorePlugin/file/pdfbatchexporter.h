@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QList>
+#include <QObject>
+#include <QString>
+
+// Regenerates the PDFs of stored reports from their report.json.
+// Every report is rendered on a thread pool with its own QTextDocument and written to
+// <TO>/<date>/report.pdf and to the reports/TOs/ copy. The date printed in the PDF is the time
+// report.json was last saved, so a regenerated PDF matches the one originally produced.
+class PdfBatchExporter : public QObject
+{
+  Q_OBJECT
+public:
+  struct Target {
+    QString numberTO;
+    QString date;
+  };
+
+  struct Result {
+    Target target;
+    QString error;
+    qint64 elapsedMs = 0;
+    qint64 bytes = 0;
+  };
+
+  explicit PdfBatchExporter(const QString& reportsRoot, QObject* parent = nullptr);
+
+  // Blocks until every target is processed; 0 threads uses QThread::idealThreadCount()
+  QList<Result> run(const QList<Target>& targets, int threadCount = 0);
+  Result exportReport(const Target& target) const;
+
+signals:
+  void progressChanged(int finished, int total);
+
+private:
+  QString m_root;
+};
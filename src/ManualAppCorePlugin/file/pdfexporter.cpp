@@ -2,45 +2,147 @@
 
 #include <qcontainerfwd.h>
 
+#include <QBuffer>
 #include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
 #include <QFileInfo>
 #include <QMarginsF>
 #include <QPageLayout>
 #include <QPageSize>
-#include <QPrinter>
+#include <QPdfWriter>
+#include <QSaveFile>
 #include <QTextDocument>
 
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+#ifdef Q_OS_WIN
+#include <qt_windows.h>
+#endif
+
 #include "loger.h"
 
 
-bool PdfExporter::exportToPdf(const QString& html, const QString& filePath,
-                              const QString& secondFilePath = QString())
+namespace
+{
+
+// Same resolution QPrinter::HighResolution uses for PDF output
+constexpr int PdfResolution = 1200;
+
+} // namespace
+
+bool PdfExporter::exportToPdf(const QString& html, const QString& filePath, const QString& secondFilePath)
+{
+  QStringList filePaths{filePath};
+  if (!secondFilePath.isEmpty()) filePaths.append(secondFilePath);
+  return exportToPdf(html, filePaths);
+}
+
+bool PdfExporter::exportToPdf(const QString& html, const QStringList& filePaths)
 {
   if (html.trimmed().isEmpty()) {
     qWarning() << "PdfExporter: Пустой HTML. PDF не создан.";
     return false;
   }
 
-  QPrinter printer(QPrinter::HighResolution);
-  printer.setOutputFormat(QPrinter::PdfFormat);
-  printer.setOutputFileName(filePath);
-  printer.setPageSize(QPageSize(QPageSize::A4));
-  printer.setPageMargins(QMarginsF(10, 15, 10, 15), QPageLayout::Millimeter);
+  const QByteArray pdf = renderPdf(html);
+  return !pdf.isEmpty() && writePdf(pdf, filePaths);
+}
 
-  QTextDocument document;
-  document.setHtml(html);
-  document.setTextWidth(printer.pageRect(QPrinter::Point).width());
+bool PdfExporter::writePdf(const QByteArray& pdf, const QStringList& filePaths)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  QString writtenPath;
+  int linked = 0;
+  for (const QString& filePath : filePaths) {
+    if (filePath.isEmpty()) continue;
+
+    if (!writtenPath.isEmpty() && linkFile(writtenPath, filePath)) {
+      ++linked;
+    } else if (!writeFile(filePath, pdf)) {
+      return false;
+    } else if (writtenPath.isEmpty()) {
+      writtenPath = filePath;
+    }
 
-  document.print(&printer);
-  if (!secondFilePath.isEmpty()) {
-    printer.setOutputFileName(secondFilePath);
-    document.print(&printer);
     DEBUG_COLORED("PdfExporter", "exportToPdf",
-                  QString("PDF успешно сохранен в %1").arg(QFileInfo(secondFilePath).absoluteFilePath()),
+                  QString("PDF успешно сохранен в %1").arg(QFileInfo(filePath).absoluteFilePath()),
                   COLOR_CYAN, COLOR_CYAN);
   }
+
   DEBUG_COLORED("PdfExporter", "exportToPdf",
-                QString("PDF успешно сохранен в %1").arg(QFileInfo(filePath).absoluteFilePath()), COLOR_CYAN,
-                COLOR_CYAN);
+                QString("write: %1 ms, %2 bytes to %3 targets (%4 linked)")
+                    .arg(timer.elapsed())
+                    .arg(pdf.size())
+                    .arg(filePaths.size())
+                    .arg(linked),
+                COLOR_CYAN, COLOR_CYAN);
   return true;
 }
+
+QByteArray PdfExporter::renderPdf(const QString& html)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  QByteArray pdf;
+  QBuffer buffer(&pdf);
+  buffer.open(QIODevice::WriteOnly);
+
+  QPdfWriter writer(&buffer);
+  writer.setResolution(PdfResolution);
+  writer.setPageSize(QPageSize(QPageSize::A4));
+  writer.setPageMargins(QMarginsF(10, 15, 10, 15), QPageLayout::Millimeter);
+
+  QTextDocument document;
+  document.setHtml(html);
+  document.setTextWidth(writer.pageLayout().paintRect(QPageLayout::Point).width());
+  const qint64 layoutTime = timer.restart();
+
+  document.print(&writer);
+  const qint64 renderTime = timer.elapsed();
+
+  DEBUG_COLORED("PdfExporter", "renderPdf",
+                QString("layout: %1 ms, render: %2 ms, %3 bytes")
+                    .arg(layoutTime)
+                    .arg(renderTime)
+                    .arg(pdf.size()),
+                COLOR_CYAN, COLOR_CYAN);
+  return pdf;
+}
+
+bool PdfExporter::writeFile(const QString& filePath, const QByteArray& data)
+{
+  QSaveFile file(filePath);
+  if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+    DEBUG_ERROR_COLORED("PdfExporter", "writeFile",
+                        QString("Cannot write %1: %2").arg(filePath, file.errorString()), COLOR_CYAN,
+                        COLOR_CYAN);
+    return false;
+  }
+  return true;
+}
+
+bool PdfExporter::linkFile(const QString& sourcePath, const QString& linkPath)
+{
+  // Targets are always replaced through QSaveFile, so a rewrite of one path never changes the other
+#if defined(Q_OS_LINUX)
+  QFile::remove(linkPath);
+  return ::link(QFile::encodeName(sourcePath).constData(), QFile::encodeName(linkPath).constData()) == 0;
+#elif defined(Q_OS_WIN)
+  QFile::remove(linkPath);
+  const QString source = QDir::toNativeSeparators(QFileInfo(sourcePath).absoluteFilePath());
+  const QString link = QDir::toNativeSeparators(QFileInfo(linkPath).absoluteFilePath());
+  return CreateHardLinkW(reinterpret_cast<LPCWSTR>(link.utf16()), reinterpret_cast<LPCWSTR>(source.utf16()),
+                         nullptr) != 0;
+#else
+  Q_UNUSED(sourcePath)
+  Q_UNUSED(linkPath)
+  return false;
+#endif
+}
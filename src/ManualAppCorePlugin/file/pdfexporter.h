@@ -1,9 +1,23 @@
 #pragma once
 
+#include <QByteArray>
 #include <QString>
+#include <QStringList>
 
+// Exports HTML to PDF.
+// The document is laid out and rendered once into memory; the bytes are then written to every target.
+// Targets after the first are hard-linked to it when the filesystem allows, and written otherwise.
 class PdfExporter
 {
 public:
   static bool exportToPdf(const QString& html, const QString& filePath, const QString& secondFilePath);
+  static bool exportToPdf(const QString& html, const QStringList& filePaths);
+  // A4, 10/15 mm margins, 1200 dpi; empty on failure
+  static QByteArray renderPdf(const QString& html);
+  // Writes rendered bytes to every target, the directories must exist
+  static bool writePdf(const QByteArray& pdf, const QStringList& filePaths);
+
+private:
+  static bool writeFile(const QString& filePath, const QByteArray& data);
+  static bool linkFile(const QString& sourcePath, const QString& linkPath);
 };
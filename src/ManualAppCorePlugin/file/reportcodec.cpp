@@ -0,0 +1,125 @@
+#include "reportcodec.h"
+
+#include <QCborMap>
+#include <QCborStreamReader>
+#include <QCborValue>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+
+
+namespace
+{
+
+// 55799, written as the first three bytes of every CBOR report
+constexpr char SelfDescribeTag[] = "\xd9\xd9\xf7";
+
+QString readString(QCborStreamReader& reader)
+{
+  QString result;
+  auto chunk = reader.readString();
+  while (chunk.status == QCborStreamReader::Ok) {
+    result += chunk.data;
+    chunk = reader.readString();
+  }
+  return result;
+}
+
+} // namespace
+
+ReportCodec::Format ReportCodec::formatFor(const QString& filePath)
+{
+  return filePath.endsWith(".cbor", Qt::CaseInsensitive) ? Format::Cbor : Format::Json;
+}
+
+QByteArray ReportCodec::encode(const QJsonObject& report, Format format)
+{
+  if (format == Format::Json) return QJsonDocument(report).toJson();
+
+  const QCborValue tagged(QCborKnownTags::Signature, QCborMap::fromJsonObject(report));
+  return tagged.toCbor();
+}
+
+bool ReportCodec::isCbor(const QByteArray& data)
+{
+  // Without the tag a CBOR report starts with a map header (major type 5), never valid JSON
+  if (data.startsWith(SelfDescribeTag)) return true;
+  return !data.isEmpty() && (static_cast<quint8>(data.at(0)) & 0xe0) == 0xa0;
+}
+
+QJsonObject ReportCodec::decode(const QByteArray& data, QString* error)
+{
+  if (isCbor(data)) {
+    QCborParserError parseError;
+    QCborValue value = QCborValue::fromCbor(data, &parseError);
+    if (parseError.error != QCborError::NoError) {
+      if (error) {
+        *error =
+            QString("CBOR parse error at offset %1: %2").arg(parseError.offset).arg(parseError.errorString());
+      }
+      return QJsonObject();
+    }
+    if (value.isTag() && value.tag() == QCborTag(QCborKnownTags::Signature)) value = value.taggedValue();
+    if (!value.isMap()) {
+      if (error) *error = "Document is not a CBOR map";
+      return QJsonObject();
+    }
+    return value.toMap().toJsonObject();
+  }
+
+  QJsonParseError parseError;
+  const QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
+  if (parseError.error != QJsonParseError::NoError) {
+    if (error) {
+      *error =
+          QString("JSON parse error at offset %1: %2").arg(parseError.offset).arg(parseError.errorString());
+    }
+    return QJsonObject();
+  }
+  if (!doc.isObject()) {
+    if (error) *error = "Document is not a JSON object";
+    return QJsonObject();
+  }
+  return doc.object();
+}
+
+QJsonValue ReportCodec::field(const QByteArray& data, const QString& key)
+{
+  if (!isCbor(data)) return decode(data).value(key);
+
+  QCborStreamReader reader(data);
+  if (reader.isTag() && reader.toTag() == QCborTag(QCborKnownTags::Signature)) reader.next();
+  if (!reader.isMap() || !reader.enterContainer()) return QJsonValue(QJsonValue::Undefined);
+
+  while (reader.hasNext() && reader.lastError() == QCborError::NoError) {
+    QString name;
+    if (reader.isString())
+      name = readString(reader);
+    else
+      reader.next();
+
+    if (name == key) return QCborValue::fromCbor(reader).toJsonValue();
+    // Skips the value, nested containers included
+    reader.next();
+  }
+  return QJsonValue(QJsonValue::Undefined);
+}
+
+QString ReportCodec::preferredFile(const QDir& reportDir)
+{
+  const QFileInfo cbor(reportDir.filePath("report.cbor"));
+  const QFileInfo json(reportDir.filePath("report.json"));
+  if (cbor.exists() && (!json.exists() || cbor.lastModified() >= json.lastModified()))
+    return cbor.filePath();
+  return json.filePath();
+}
+
+QJsonObject ReportCodec::readFile(const QString& filePath, QString* error)
+{
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    if (error) *error = QString("Cannot open %1").arg(filePath);
+    return QJsonObject();
+  }
+  return decode(file.readAll(), error);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDir>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QString>
+
+// Converts reports between the report.json schema and its CBOR form (report.cbor).
+// The CBOR form is the same document encoded with QCborValue: maps, strings, integers and doubles
+// map one to one, so a round trip through CBOR gives back the original JSON. CBOR output starts
+// with the self-describe tag, readers tell the two formats apart by content, not by file name.
+class ReportCodec
+{
+public:
+  enum class Format { Json, Cbor };
+
+  // Cbor for *.cbor files, Json for everything else
+  static Format formatFor(const QString& filePath);
+  static QByteArray encode(const QJsonObject& report, Format format);
+  // Accepts both formats; returns an empty object and sets error when data is not a valid report
+  static QJsonObject decode(const QByteArray& data, QString* error = nullptr);
+  static bool isCbor(const QByteArray& data);
+
+  // A single top-level field; for CBOR the other fields are skipped without being decoded, so
+  // checking e.g. "title" does not build the steps. Undefined when the field is missing.
+  static QJsonValue field(const QByteArray& data, const QString& key);
+
+  // report.cbor when it exists and is at least as new as report.json, report.json otherwise
+  static QString preferredFile(const QDir& reportDir);
+  static QJsonObject readFile(const QString& filePath, QString* error = nullptr);
+};
@@ -0,0 +1,138 @@
+#include "reporthtmlbuilder.h"
+
+#include "htmltemplate.h"
+
+
+namespace
+{
+
+// Function-local statics are initialized once and thread-safely, builds may run on I/O workers
+const HtmlTemplate& headerTemplate()
+{
+  static const HtmlTemplate tpl(
+      QStringLiteral("<html><head><style>"
+                     "body { font-family: Arial; font-size: 12pt; }"
+                     "h1 { font-size: 18pt; }"
+                     "table { width: 100%; border-collapse: collapse; margin-top: 10pt; }"
+                     "th, td { border: 1px solid #444; padding: 6px; text-align: left; }"
+                     "th { background-color: #eee; }"
+                     ".defect-details { margin-left: 20px; font-size: 10pt; }"
+                     "</style></head><body>"
+                     "<h1>{{title}}</h1>"));
+  return tpl;
+}
+
+const HtmlTemplate& serialsTemplate()
+{
+  static const HtmlTemplate tpl(
+      QStringLiteral("<div class='serials'>"
+                     "<div class='serial-item'><b>S/n:</b> {{serial}}</div>"
+                     "</div>"));
+  return tpl;
+}
+
+const HtmlTemplate& tableTemplate()
+{
+  static const HtmlTemplate tpl(
+      QStringLiteral("<p>Date: {{date}}</p>"
+                     "<table>"
+                     "<tr>"
+                     "<th>#</th>"
+                     "<th>Step</th>"
+                     "<th>Status</th>"
+                     "<th>Damage Details</th>"
+                     "</tr>"));
+  return tpl;
+}
+
+const HtmlTemplate& rowTemplate()
+{
+  static const HtmlTemplate tpl(
+      QStringLiteral("<tr>"
+                     "<td>{{number}}</td>"
+                     "<td>{{title}}</td>"
+                     "<td>{{status}}</td>"
+                     "<td>{{&details}}</td>"
+                     "</tr>"));
+  return tpl;
+}
+
+const HtmlTemplate& defectTemplate()
+{
+  static const HtmlTemplate tpl(
+      QStringLiteral("<div class='defect-details'>"
+                     "<p><b>Description:</b> {{description}}</p>"
+                     "<p><b>Repair Method:</b> {{repairMethod}}</p>"
+                     "<p><b>Status:</b> {{fixStatus}}</p>"
+                     "</div>"));
+  return tpl;
+}
+
+constexpr QStringView FooterHtml = u"</table></body></html>";
+
+} // namespace
+
+QString ReportHtmlBuilder::build(const Report& report)
+{
+  const HtmlTemplate& header = headerTemplate();
+  const HtmlTemplate& serials = serialsTemplate();
+  const HtmlTemplate& table = tableTemplate();
+  const HtmlTemplate& row = rowTemplate();
+  const HtmlTemplate& defect = defectTemplate();
+
+  // Upper bound before escaping; escaped text may still grow the buffer, but only rarely
+  qsizetype size = header.literalSize() + report.title.size() + serials.literalSize() +
+                   report.serialNumber.size() + table.literalSize() + report.date.size() + FooterHtml.size();
+  for (const Step& step : report.steps) {
+    // 16 covers the row number and the status text
+    size += row.literalSize() + step.title.size() + 16;
+    if (step.completionStatus == Step::CompletionStatus::HasDefect)
+      size += defect.literalSize() + step.defectDetails.description.size() +
+              step.defectDetails.repairMethod.size() + 16;
+  }
+
+  QString html;
+  html.reserve(size);
+
+  header.renderTo(html, {report.title});
+  if (!report.serialNumber.isEmpty()) serials.renderTo(html, {report.serialNumber});
+  table.renderTo(html, {report.date});
+
+  QString details;
+  for (qsizetype i = 0; i < report.steps.size(); ++i) {
+    const Step& step = report.steps[i];
+
+    details.clear();
+    if (step.completionStatus == Step::CompletionStatus::HasDefect) {
+      defect.renderTo(details, {step.defectDetails.description, step.defectDetails.repairMethod,
+                                fixStatusText(step.defectDetails.fixStatus)});
+    }
+
+    row.renderTo(html, {QString::number(i + 1), step.title, statusText(step.completionStatus), details});
+  }
+
+  html.append(FooterHtml);
+  return html;
+}
+
+QStringView ReportHtmlBuilder::statusText(Step::CompletionStatus status)
+{
+  switch (status) {
+    case Step::CompletionStatus::NotStarted: return u"Not Started";
+    case Step::CompletionStatus::Completed: return u"Completed";
+    case Step::CompletionStatus::HasDefect: return u"Has Damage";
+    case Step::CompletionStatus::Skipped: return u"Skipped";
+  }
+  return QStringView();
+}
+
+QStringView ReportHtmlBuilder::fixStatusText(Step::DefectDetails::FixStatus status)
+{
+  switch (status) {
+    case Step::DefectDetails::FixStatus::Fixed: return u"Fixed";
+    case Step::DefectDetails::FixStatus::Postponed: return u"Postponed";
+    case Step::DefectDetails::FixStatus::NotRequired: return u"Not Required";
+    case Step::DefectDetails::FixStatus::NotFixed: return u"Not Fixed";
+  }
+  return u"Unknown";
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QSpan>
+#include <QString>
+#include <QStringView>
+
+#include "../models/step.h"
+
+// Builds the HTML of a TO report for PdfExporter.
+// The templates are compiled once per process and the output is written into one buffer reserved
+// up front, so building is linear in the size of the report and cheap to repeat for many reports.
+class ReportHtmlBuilder
+{
+public:
+  struct Report {
+    QString title;
+    // Omitted from the header when empty
+    QString serialNumber;
+    QString date;
+    // Borrowed for the duration of build()
+    QSpan<const Step> steps;
+  };
+
+  static QString build(const Report& report);
+
+  static QStringView statusText(Step::CompletionStatus status);
+  static QStringView fixStatusText(Step::DefectDetails::FixStatus status);
+};
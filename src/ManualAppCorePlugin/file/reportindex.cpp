@@ -0,0 +1,456 @@
+#include "reportindex.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QSet>
+
+#include "loger.h"
+
+
+namespace
+{
+
+const QString RootKey = QStringLiteral("");
+const QString StablePdfKey = QStringLiteral("TOs");
+
+} // namespace
+
+ReportIndex::ReportIndex(const QString& reportsRoot, const QString& indexFilePath)
+    : m_root(reportsRoot)
+    , m_indexFilePath(indexFilePath)
+{
+  if (!m_root.endsWith('/')) m_root += '/';
+
+  m_saveTimer.setSingleShot(true);
+  m_saveTimer.setInterval(SaveDelayMs);
+  m_saveTimer.callOnTimeout([this]() { save(); });
+}
+
+ReportIndex::~ReportIndex()
+{
+  flush();
+}
+
+void ReportIndex::load()
+{
+  if (!readFromDisk()) {
+    rebuild();
+    return;
+  }
+
+  // A new or removed TO-* directory changes the mtime of the root, anything else is local to one directory
+  if (dirMTime(m_root) != m_dirMTimes.value(RootKey, -2)) {
+    DEBUG_COLORED("ReportIndex", "load", "Reports root changed, rebuilding index", COLOR_MAGENTA,
+                  COLOR_MAGENTA);
+    rebuild();
+    return;
+  }
+
+  bool changed = false;
+  const QStringList keys = m_dirMTimes.keys();
+  for (const QString& key : keys) {
+    if (key == RootKey) continue;
+
+    const QString path = key == StablePdfKey ? stablePdfDir() : m_root + key;
+    if (dirMTime(path) == m_dirMTimes.value(key)) continue;
+
+    DEBUG_COLORED("ReportIndex", "load", QString("Directory changed, rescanning: %1").arg(key), COLOR_MAGENTA,
+                  COLOR_MAGENTA);
+    if (key == StablePdfKey)
+      scanStablePdfs();
+    else
+      scanNumberTO(key);
+    changed = true;
+  }
+
+  // Replacing a file inside a report directory leaves the TO-* mtime alone
+  if (refreshChangedReports()) changed = true;
+
+  if (changed) save();
+}
+
+void ReportIndex::rebuild()
+{
+  m_reports.clear();
+  m_dirMTimes.clear();
+
+  QDir rootDir(m_root);
+  if (rootDir.exists()) {
+    static const QRegularExpression toRe("^TO-.*", QRegularExpression::CaseInsensitiveOption);
+    const QStringList toDirs = rootDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    for (const QString& toName : toDirs) {
+      if (toRe.match(toName).hasMatch()) scanNumberTO(toName);
+    }
+  }
+  scanStablePdfs();
+  m_dirMTimes[RootKey] = dirMTime(m_root);
+
+  save();
+}
+
+void ReportIndex::refreshReport(const QString& numberTO, const QString& date)
+{
+  if (numberTO.isEmpty() || date.isEmpty()) return;
+
+  Entry& entry = m_reports[numberTO][date];
+  entry.numberTO = numberTO;
+  entry.date = date;
+  statReport(entry);
+
+  dropIfEmpty(numberTO, date);
+  rememberMTimes(numberTO);
+  scheduleSave();
+}
+
+void ReportIndex::refreshStablePdf(const QString& numberTO, const QString& date)
+{
+  if (numberTO.isEmpty() || date.isEmpty()) return;
+
+  Entry& entry = m_reports[numberTO][date];
+  entry.numberTO = numberTO;
+  entry.date = date;
+  entry.hasStablePdf = QFileInfo::exists(stablePdfDir() + stablePdfName(numberTO, date));
+
+  dropIfEmpty(numberTO, date);
+  rememberMTimes(numberTO);
+  scheduleSave();
+}
+
+void ReportIndex::removeReport(const QString& numberTO, const QString& date)
+{
+  auto toIt = m_reports.find(numberTO);
+  if (toIt == m_reports.end() || !toIt->contains(date)) return;
+
+  Entry& entry = (*toIt)[date];
+  entry.hasReportDir = false;
+  entry.hasJson = entry.hasPdf = false;
+  entry.jsonSize = entry.pdfSize = entry.beforeArchiveSize = entry.afterArchiveSize = 0;
+
+  dropIfEmpty(numberTO, date);
+  rememberMTimes(numberTO);
+  scheduleSave();
+}
+
+void ReportIndex::setUploaded(const QString& numberTO, const QString& date, bool uploaded)
+{
+  auto toIt = m_reports.find(numberTO);
+  if (toIt == m_reports.end()) return;
+
+  auto it = toIt->find(date);
+  if (it == toIt->end() || it->uploaded == uploaded) return;
+
+  it->uploaded = uploaded;
+  scheduleSave();
+}
+
+void ReportIndex::flush()
+{
+  if (!m_saveTimer.isActive()) return;
+  m_saveTimer.stop();
+  save();
+}
+
+QList<ReportIndex::Entry> ReportIndex::entries() const
+{
+  QList<Entry> result;
+  for (const auto& dates : m_reports) {
+    for (const Entry& entry : dates)
+      result.append(entry);
+  }
+  return result;
+}
+
+const ReportIndex::Entry* ReportIndex::find(const QString& numberTO, const QString& date) const
+{
+  auto toIt = m_reports.constFind(numberTO);
+  if (toIt == m_reports.constEnd()) return nullptr;
+
+  auto it = toIt->constFind(date);
+  return it == toIt->constEnd() ? nullptr : &it.value();
+}
+
+QVariantMap ReportIndex::performedTOs() const
+{
+  QVariantMap result;
+
+  for (auto toIt = m_reports.constBegin(); toIt != m_reports.constEnd(); ++toIt) {
+    QVariantList dateList;
+    // ISO dates sort lexicographically, so walking the map backwards gives newest first
+    for (auto it = toIt->constEnd(); it != toIt->constBegin();) {
+      --it;
+      if (!(it->hasJson && it->hasPdf)) continue;
+      if (!QDate::fromString(it->date, "yyyy-MM-dd").isValid()) continue;
+      dateList << it->date;
+    }
+    if (!dateList.isEmpty()) result.insert(toIt.key(), dateList);
+  }
+
+  return result;
+}
+
+QVariantMap ReportIndex::performedTOsNew() const
+{
+  QVariantMap result;
+
+  for (auto toIt = m_reports.constBegin(); toIt != m_reports.constEnd(); ++toIt) {
+    QVariantList dateList;
+    for (auto it = toIt->constEnd(); it != toIt->constBegin();) {
+      --it;
+      if (it->hasStablePdf) dateList << it->date;
+    }
+    if (!dateList.isEmpty()) result.insert(toIt.key(), dateList);
+  }
+
+  return result;
+}
+
+QString ReportIndex::stablePdfPath(const QString& numberTO, const QString& date) const
+{
+  const Entry* entry = find(numberTO, date);
+  if (!entry || !entry->hasStablePdf) return QString();
+
+  return QFileInfo(stablePdfDir() + stablePdfName(numberTO, date)).absoluteFilePath();
+}
+
+QString ReportIndex::stablePdfName(const QString& numberTO, const QString& date)
+{
+  return QString("%1-%2.pdf").arg(date, numberTO);
+}
+
+qint64 ReportIndex::dirMTime(const QString& path)
+{
+  QFileInfo info(path);
+  return info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1;
+}
+
+qint64 ReportIndex::reportMTime(const QString& reportDir)
+{
+  // Files are replaced through renames, which bump the mtime of the directory that holds them
+  return qMax(dirMTime(reportDir), qMax(dirMTime(reportDir + "before_to"), dirMTime(reportDir + "after_to")));
+}
+
+bool ReportIndex::readFromDisk()
+{
+  QFile file(m_indexFilePath);
+  if (!file.open(QIODevice::ReadOnly)) return false;
+
+  const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+  file.close();
+
+  const QJsonObject root = doc.object();
+  if (root.value("version").toInt() != Version) {
+    DEBUG_COLORED("ReportIndex", "readFromDisk", "Index version mismatch, rebuilding", COLOR_MAGENTA,
+                  COLOR_MAGENTA);
+    return false;
+  }
+
+  m_reports.clear();
+  m_dirMTimes.clear();
+
+  const QJsonObject dirs = root.value("dirs").toObject();
+  for (auto it = dirs.constBegin(); it != dirs.constEnd(); ++it)
+    m_dirMTimes.insert(it.key(), static_cast<qint64>(it.value().toDouble(-1)));
+
+  const QJsonArray reports = root.value("reports").toArray();
+  for (const QJsonValue& value : reports) {
+    const QJsonObject obj = value.toObject();
+
+    Entry entry;
+    entry.numberTO = obj.value("to").toString();
+    entry.date = obj.value("date").toString();
+    if (entry.numberTO.isEmpty() || entry.date.isEmpty()) continue;
+
+    entry.hasReportDir = obj.value("dir").toBool();
+    entry.hasJson = obj.value("json").toBool();
+    entry.hasPdf = obj.value("pdf").toBool();
+    entry.hasStablePdf = obj.value("stable_pdf").toBool();
+    entry.jsonSize = static_cast<qint64>(obj.value("json_size").toDouble());
+    entry.pdfSize = static_cast<qint64>(obj.value("pdf_size").toDouble());
+    entry.beforeArchiveSize = static_cast<qint64>(obj.value("before_size").toDouble());
+    entry.afterArchiveSize = static_cast<qint64>(obj.value("after_size").toDouble());
+    entry.uploaded = obj.value("uploaded").toBool();
+    entry.mtime = static_cast<qint64>(obj.value("mtime").toDouble(-1));
+
+    m_reports[entry.numberTO][entry.date] = entry;
+  }
+
+  return m_dirMTimes.contains(RootKey);
+}
+
+bool ReportIndex::save()
+{
+  QJsonObject dirs;
+  for (auto it = m_dirMTimes.constBegin(); it != m_dirMTimes.constEnd(); ++it)
+    dirs[it.key()] = static_cast<double>(it.value());
+
+  QJsonArray reports;
+  for (const auto& dates : std::as_const(m_reports)) {
+    for (const Entry& entry : dates) {
+      reports.append(QJsonObject{{"to", entry.numberTO},
+                                 {"date", entry.date},
+                                 {"dir", entry.hasReportDir},
+                                 {"json", entry.hasJson},
+                                 {"pdf", entry.hasPdf},
+                                 {"stable_pdf", entry.hasStablePdf},
+                                 {"json_size", static_cast<double>(entry.jsonSize)},
+                                 {"pdf_size", static_cast<double>(entry.pdfSize)},
+                                 {"before_size", static_cast<double>(entry.beforeArchiveSize)},
+                                 {"after_size", static_cast<double>(entry.afterArchiveSize)},
+                                 {"uploaded", entry.uploaded},
+                                 {"mtime", static_cast<double>(entry.mtime)}});
+    }
+  }
+
+  QJsonObject root{{"version", Version}, {"dirs", dirs}, {"reports", reports}};
+
+  m_saveTimer.stop();
+
+  QSaveFile file(m_indexFilePath);
+  if (!file.open(QIODevice::WriteOnly)) {
+    DEBUG_ERROR_COLORED("ReportIndex", "save", QString("Cannot open index file: %1").arg(m_indexFilePath),
+                        COLOR_MAGENTA, COLOR_MAGENTA);
+    return false;
+  }
+  file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+  return file.commit();
+}
+
+void ReportIndex::scheduleSave()
+{
+  m_saveTimer.start();
+}
+
+void ReportIndex::scanNumberTO(const QString& numberTO)
+{
+  QMap<QString, Entry>& reports = m_reports[numberTO];
+
+  QSet<QString> present;
+  QDir toDir(m_root + numberTO);
+  const QStringList dateDirs = toDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+  for (const QString& date : dateDirs) {
+    Entry& entry = reports[date];
+    entry.numberTO = numberTO;
+    entry.date = date;
+    statReport(entry);
+    present.insert(date);
+  }
+
+  for (auto it = reports.begin(); it != reports.end();) {
+    if (!present.contains(it.key())) {
+      it->hasReportDir = it->hasJson = it->hasPdf = false;
+      it->jsonSize = it->pdfSize = it->beforeArchiveSize = it->afterArchiveSize = 0;
+      if (!it->hasStablePdf) {
+        it = reports.erase(it);
+        continue;
+      }
+    }
+    ++it;
+  }
+
+  if (reports.isEmpty()) m_reports.remove(numberTO);
+  m_dirMTimes[numberTO] = dirMTime(m_root + numberTO);
+}
+
+void ReportIndex::scanStablePdfs()
+{
+  for (auto& dates : m_reports) {
+    for (Entry& entry : dates)
+      entry.hasStablePdf = false;
+  }
+
+  static const QRegularExpression fileRe(R"(^(\d{4}-\d{2}-\d{2})-(TO-\d+)\.pdf$)",
+                                         QRegularExpression::CaseInsensitiveOption);
+
+  QDir dir(stablePdfDir());
+  const QStringList pdfFiles =
+      dir.exists() ? dir.entryList({"*.pdf"}, QDir::Files, QDir::Name) : QStringList();
+  for (const QString& fileName : pdfFiles) {
+    auto match = fileRe.match(fileName);
+    if (!match.hasMatch()) continue;
+
+    const QString date = match.captured(1);
+    const QString numberTO = match.captured(2);
+    if (!QDate::fromString(date, "yyyy-MM-dd").isValid()) continue;
+
+    Entry& entry = m_reports[numberTO][date];
+    entry.numberTO = numberTO;
+    entry.date = date;
+    entry.hasStablePdf = true;
+  }
+
+  for (auto toIt = m_reports.begin(); toIt != m_reports.end();) {
+    for (auto it = toIt->begin(); it != toIt->end();) {
+      if (!it->hasReportDir && !it->hasStablePdf)
+        it = toIt->erase(it);
+      else
+        ++it;
+    }
+    if (toIt->isEmpty())
+      toIt = m_reports.erase(toIt);
+    else
+      ++toIt;
+  }
+
+  m_dirMTimes[StablePdfKey] = dirMTime(stablePdfDir());
+}
+
+void ReportIndex::statReport(Entry& entry) const
+{
+  const QString reportDir = m_root + entry.numberTO + "/" + entry.date + "/";
+
+  auto fileSize = [](const QString& path, bool* exists) -> qint64 {
+    QFileInfo info(path);
+    *exists = info.exists();
+    return *exists ? info.size() : 0;
+  };
+
+  bool exists = false;
+  entry.hasReportDir = QFileInfo::exists(reportDir);
+  entry.jsonSize = fileSize(reportDir + "report.json", &entry.hasJson);
+  entry.pdfSize = fileSize(reportDir + "report.pdf", &entry.hasPdf);
+  entry.beforeArchiveSize = fileSize(reportDir + "before_to/rail_record.zip", &exists);
+  entry.afterArchiveSize = fileSize(reportDir + "after_to/rail_record.zip", &exists);
+  entry.mtime = reportMTime(reportDir);
+}
+
+bool ReportIndex::refreshChangedReports()
+{
+  bool changed = false;
+  for (auto& dates : m_reports) {
+    for (Entry& entry : dates) {
+      if (!entry.hasReportDir) continue;
+      if (reportMTime(m_root + entry.numberTO + "/" + entry.date + "/") == entry.mtime) continue;
+
+      DEBUG_COLORED("ReportIndex", "load", QString("Report changed: %1/%2").arg(entry.numberTO, entry.date),
+                    COLOR_MAGENTA, COLOR_MAGENTA);
+      statReport(entry);
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+void ReportIndex::dropIfEmpty(const QString& numberTO, const QString& date)
+{
+  auto toIt = m_reports.find(numberTO);
+  if (toIt == m_reports.end()) return;
+
+  auto it = toIt->find(date);
+  if (it != toIt->end() && !it->hasReportDir && !it->hasStablePdf) toIt->erase(it);
+  if (toIt->isEmpty()) m_reports.erase(toIt);
+}
+
+void ReportIndex::rememberMTimes(const QString& numberTO)
+{
+  // Our own writes touch these directories; record them so the next load does not rescan
+  m_dirMTimes[RootKey] = dirMTime(m_root);
+  m_dirMTimes[StablePdfKey] = dirMTime(stablePdfDir());
+  if (!numberTO.isEmpty()) m_dirMTimes[numberTO] = dirMTime(m_root + numberTO);
+}
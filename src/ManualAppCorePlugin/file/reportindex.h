@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QDate>
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QTimer>
+#include <QVariantMap>
+
+// Persistent index of stored reports.
+// Listing queries are served from memory; the on-disk copy is validated on load by comparing
+// the modification time of the reports root, every TO-* directory and reports/TOs/, so only
+// directories that changed outside the application are rescanned. Each report also keeps the
+// newest mtime of its directory and archive subdirectories, which catches files replaced inside it.
+// Incremental updates are written back after a short delay, so a burst of them costs one write.
+class ReportIndex
+{
+public:
+  struct Entry {
+    QString numberTO;
+    QString date;
+    bool hasReportDir = false;
+    bool hasJson = false;
+    bool hasPdf = false;
+    bool hasStablePdf = false;
+    qint64 jsonSize = 0;
+    qint64 pdfSize = 0;
+    qint64 beforeArchiveSize = 0;
+    qint64 afterArchiveSize = 0;
+    bool uploaded = false;
+    // Newest mtime of the report directory and its before_to/after_to subdirectories
+    qint64 mtime = -1;
+  };
+
+  ReportIndex(const QString& reportsRoot, const QString& indexFilePath);
+  ~ReportIndex();
+
+  void load();
+  void rebuild();
+
+  // Incremental updates after the application changed a report on disk
+  void refreshReport(const QString& numberTO, const QString& date);
+  void refreshStablePdf(const QString& numberTO, const QString& date);
+  void removeReport(const QString& numberTO, const QString& date);
+  void setUploaded(const QString& numberTO, const QString& date, bool uploaded);
+  // Writes a pending delayed save now
+  void flush();
+
+  const QString& reportsRoot() const { return m_root; }
+  QList<Entry> entries() const;
+  const Entry* find(const QString& numberTO, const QString& date) const;
+  QVariantMap performedTOs() const;
+  QVariantMap performedTOsNew() const;
+  QString stablePdfPath(const QString& numberTO, const QString& date) const;
+
+private:
+  static constexpr int Version = 1;
+  static constexpr int SaveDelayMs = 500;
+
+  QString stablePdfDir() const { return m_root + "TOs/"; }
+  static QString stablePdfName(const QString& numberTO, const QString& date);
+  static qint64 dirMTime(const QString& path);
+  static qint64 reportMTime(const QString& reportDir);
+
+  bool readFromDisk();
+  bool save();
+  void scheduleSave();
+  void scanNumberTO(const QString& numberTO);
+  void scanStablePdfs();
+  void statReport(Entry& entry) const;
+  bool refreshChangedReports();
+  void dropIfEmpty(const QString& numberTO, const QString& date);
+  void rememberMTimes(const QString& numberTO);
+
+private:
+  QString m_root;
+  QString m_indexFilePath;
+
+  QMap<QString, QMap<QString, Entry>> m_reports;
+  QHash<QString, qint64> m_dirMTimes;
+  QTimer m_saveTimer;
+};
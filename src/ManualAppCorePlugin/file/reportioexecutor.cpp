@@ -0,0 +1,108 @@
+#include "reportioexecutor.h"
+
+#include <QCoreApplication>
+#include <QThread>
+#include <utility>
+
+#include "loger.h"
+
+
+void ReportIoExecutor::Context::setProgress(qint64 done, qint64 total) const
+{
+  emit m_executor->jobProgress(m_jobId, done, total);
+}
+
+ReportIoExecutor::ReportIoExecutor(QObject* parent)
+    : QObject(parent)
+{
+  // Archiving brings its own pool, this one only has to keep a PDF from waiting behind an archive
+  m_pool.setMaxThreadCount(qMax(2, QThread::idealThreadCount() / 2));
+}
+
+ReportIoExecutor::~ReportIoExecutor()
+{
+  m_pool.waitForDone();
+}
+
+int ReportIoExecutor::submit(const QString& key, Work work, Completion completion)
+{
+  const int jobId = m_nextJobId++;
+  m_queues[key].enqueue({jobId, std::move(work), std::move(completion)});
+  ++m_pendingJobs;
+  emit pendingJobsChanged();
+
+  // Started from the event loop, so the caller has the job id before jobStarted arrives
+  if (!m_running.contains(key)) {
+    m_running.insert(key);
+    QMetaObject::invokeMethod(this, [this, key]() { startNext(key); }, Qt::QueuedConnection);
+  }
+  return jobId;
+}
+
+void ReportIoExecutor::waitForDone()
+{
+  // Jobs that were running post their completion to the event loop; they are delivered here, and
+  // startNext() leaves the following jobs to the synchronous drain below
+  m_draining = true;
+  m_pool.waitForDone();
+  QCoreApplication::sendPostedEvents(this, QEvent::MetaCall);
+
+  // Whatever is still queued runs here, in order per key, instead of being lost at exit; completions
+  // may submit follow-up jobs, those run as well
+  int drained = 0;
+  while (!m_queues.isEmpty()) {
+    const QHash<QString, QQueue<Job>> queues = std::exchange(m_queues, {});
+    for (QQueue<Job> queue : queues) {
+      while (!queue.isEmpty()) {
+        const Job job = queue.dequeue();
+        finishJob(job, job.work(Context(this, job.id)));
+        ++drained;
+      }
+    }
+  }
+  m_running.clear();
+
+  if (drained > 0) {
+    DEBUG_COLORED("ReportIoExecutor", "waitForDone", QString("Ran %1 queued jobs synchronously").arg(drained),
+                  COLOR_MAGENTA, COLOR_MAGENTA);
+  }
+}
+
+void ReportIoExecutor::startNext(const QString& key)
+{
+  if (m_draining) return;
+
+  auto queue = m_queues.find(key);
+  if (queue == m_queues.end() || queue->isEmpty()) {
+    m_queues.remove(key);
+    m_running.remove(key);
+    return;
+  }
+
+  const Job job = queue->dequeue();
+  emit jobStarted(job.id);
+
+  m_pool.start([this, key, job]() {
+    const QString error = job.work(Context(this, job.id));
+    QMetaObject::invokeMethod(
+        this,
+        [this, key, job, error]() {
+          finishJob(job, error);
+          startNext(key);
+        },
+        Qt::QueuedConnection);
+  });
+}
+
+void ReportIoExecutor::finishJob(const Job& job, const QString& error)
+{
+  if (!error.isEmpty()) {
+    DEBUG_ERROR_COLORED("ReportIoExecutor", "finishJob", QString("Job %1 failed: %2").arg(job.id).arg(error),
+                        COLOR_MAGENTA, COLOR_MAGENTA);
+  }
+
+  if (job.completion) job.completion(error);
+  --m_pendingJobs;
+  emit jobFinished(job.id, error.isEmpty(), error);
+  emit pendingJobsChanged();
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QQueue>
+#include <QSet>
+#include <QThreadPool>
+#include <functional>
+
+// Runs blocking report I/O (JSON, PDF, file copies, archives) off the GUI thread.
+// Jobs submitted under the same key run one after another in submission order, so two operations never
+// touch one report directory at the same time; jobs for different keys run in parallel. The work function
+// runs on a pool thread and must not touch GUI-thread objects. The completion callback runs on the
+// executor's thread right before jobFinished is emitted, that is where results are applied.
+class ReportIoExecutor : public QObject
+{
+  Q_OBJECT
+  Q_PROPERTY(int pendingJobs READ pendingJobs NOTIFY pendingJobsChanged)
+public:
+  // Handed to the work function of a running job
+  class Context
+  {
+  public:
+    int jobId() const { return m_jobId; }
+    // Safe to call from the pool thread, delivered to GUI receivers through a queued connection
+    void setProgress(qint64 done, qint64 total) const;
+
+  private:
+    friend class ReportIoExecutor;
+    Context(ReportIoExecutor* executor, int jobId)
+        : m_executor(executor)
+        , m_jobId(jobId)
+    {
+    }
+
+    ReportIoExecutor* m_executor;
+    int m_jobId;
+  };
+
+  // Returns an error message, empty on success
+  using Work = std::function<QString(const Context&)>;
+  using Completion = std::function<void(const QString& error)>;
+
+  explicit ReportIoExecutor(QObject* parent = nullptr);
+  ~ReportIoExecutor() override;
+
+  // Returns the job id reported by jobStarted/jobProgress/jobFinished
+  int submit(const QString& key, Work work, Completion completion = Completion());
+  int pendingJobs() const { return m_pendingJobs; }
+  // Waits for running jobs and runs the queued ones on the calling thread, used at shutdown
+  void waitForDone();
+
+signals:
+  void jobStarted(int jobId);
+  void jobProgress(int jobId, qint64 done, qint64 total);
+  void jobFinished(int jobId, bool success, const QString& error);
+  void pendingJobsChanged();
+
+private:
+  struct Job {
+    int id = 0;
+    Work work;
+    Completion completion;
+  };
+
+  void startNext(const QString& key);
+  void finishJob(const Job& job, const QString& error);
+
+private:
+  QThreadPool m_pool;
+  QHash<QString, QQueue<Job>> m_queues;
+  // Keys that currently have a job on the pool
+  QSet<QString> m_running;
+  int m_nextJobId = 1;
+  int m_pendingJobs = 0;
+  // Set by waitForDone(), no further job goes to the pool
+  bool m_draining = false;
+};
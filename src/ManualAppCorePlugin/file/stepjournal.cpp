@@ -0,0 +1,160 @@
+#include "stepjournal.h"
+
+#include <QJsonDocument>
+#include <QSaveFile>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#include <qt_windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "loger.h"
+
+
+namespace
+{
+
+bool syncToDisk(QFile& file)
+{
+  if (!file.flush()) return false;
+#ifdef Q_OS_WIN
+  return FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(file.handle())));
+#else
+  return ::fsync(file.handle()) == 0;
+#endif
+}
+
+} // namespace
+
+StepJournal::StepJournal(const QString& filePath, QObject* parent)
+    : QObject(parent)
+    , m_filePath(filePath)
+    , m_file(filePath)
+{
+  m_syncTimer.setSingleShot(true);
+  m_syncTimer.setInterval(SyncDelayMs);
+  connect(&m_syncTimer, &QTimer::timeout, this, &StepJournal::sync);
+}
+
+StepJournal::~StepJournal()
+{
+  if (m_file.isOpen()) sync();
+}
+
+bool StepJournal::open(qint64 minSeq)
+{
+  m_entries.clear();
+  m_lastSeq = minSeq;
+
+  bool tornTail = false;
+  if (m_file.open(QIODevice::ReadOnly)) {
+    while (!m_file.atEnd()) {
+      const QByteArray line = m_file.readLine();
+      tornTail = !line.endsWith('\n');
+      const QJsonObject obj = QJsonDocument::fromJson(line).object();
+      if (obj.isEmpty()) continue;
+
+      Entry entry;
+      entry.seq = obj.value("n").toInteger();
+      entry.index = obj.value("i").toInt(-1);
+      entry.step = obj;
+      entry.step.remove("n");
+      entry.step.remove("i");
+      if (entry.seq <= minSeq || entry.index < 0) continue;
+
+      m_entries.append(entry);
+      m_lastSeq = qMax(m_lastSeq, entry.seq);
+    }
+    m_file.close();
+  }
+
+  if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+    DEBUG_ERROR_COLORED("StepJournal", "open",
+                        QString("Cannot open %1: %2").arg(m_filePath, m_file.errorString()), COLOR_MAGENTA,
+                        COLOR_MAGENTA);
+    return false;
+  }
+  // Without a line break the next record would be glued to the torn one and lost along with it
+  if (tornTail) m_file.write("\n");
+  return true;
+}
+
+qint64 StepJournal::append(int index, const Step& step)
+{
+  if (!m_file.isOpen()) return 0;
+
+  Entry entry;
+  entry.seq = m_lastSeq + 1;
+  entry.index = index;
+  entry.step = step.toJson();
+
+  if (m_file.write(serialize(entry)) < 0 || !m_file.flush()) {
+    DEBUG_ERROR_COLORED("StepJournal", "append", m_file.errorString(), COLOR_MAGENTA, COLOR_MAGENTA);
+    return 0;
+  }
+
+  m_lastSeq = entry.seq;
+  m_entries.append(entry);
+
+  if (++m_unsynced >= SyncEveryRecords)
+    sync();
+  else if (!m_syncTimer.isActive())
+    m_syncTimer.start();
+  return entry.seq;
+}
+
+bool StepJournal::truncateThrough(qint64 seq)
+{
+  qsizetype covered = 0;
+  while (covered < m_entries.size() && m_entries.at(covered).seq <= seq) ++covered;
+  if (covered == 0) return true;
+
+  // The remaining records are rewritten atomically, a crash leaves either the old or the new journal
+  QSaveFile file(m_filePath);
+  if (!file.open(QIODevice::WriteOnly)) return false;
+  for (qsizetype i = covered; i < m_entries.size(); ++i) file.write(serialize(m_entries.at(i)));
+
+  m_syncTimer.stop();
+  m_file.close();
+  const bool committed = file.commit();
+  if (committed) {
+    m_entries.remove(0, covered);
+    m_unsynced = 0;
+  }
+
+  if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) return false;
+  return committed;
+}
+
+bool StepJournal::sync()
+{
+  m_syncTimer.stop();
+  if (m_unsynced == 0 || !m_file.isOpen()) return true;
+
+  m_unsynced = 0;
+  if (syncToDisk(m_file)) return true;
+
+  DEBUG_ERROR_COLORED("StepJournal", "sync", QString("fsync failed for %1").arg(m_filePath), COLOR_MAGENTA,
+                      COLOR_MAGENTA);
+  return false;
+}
+
+bool StepJournal::apply(const Entry& entry, Step& step)
+{
+  const Step recorded = Step::fromJson(entry.step, true);
+  if (recorded.title != step.title) return false;
+
+  step.completionStatus = recorded.completionStatus;
+  step.defectDetails = recorded.defectDetails;
+  return true;
+}
+
+QByteArray StepJournal::serialize(const Entry& entry)
+{
+  QJsonObject obj = entry.step;
+  obj["n"] = entry.seq;
+  obj["i"] = entry.index;
+  return QJsonDocument(obj).toJson(QJsonDocument::Compact) + '\n';
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QFile>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+#include "../models/step.h"
+
+// Append-only log of step edits kept next to a report as report.journal.
+// Every edit appends one JSON line with a sequence number and the step's new state, so the cost of
+// an edit does not depend on the size of the checklist. Lines reach the OS immediately and are
+// fsynced in batches. Once a snapshot in report.json covers the records up to some sequence number,
+// truncateThrough() drops them; a torn last line left by a crash is skipped when reading.
+class StepJournal : public QObject
+{
+  Q_OBJECT
+public:
+  struct Entry {
+    qint64 seq = 0;
+    int index = -1;
+    // Step::toJson() of the edited step
+    QJsonObject step;
+  };
+
+  explicit StepJournal(const QString& filePath, QObject* parent = nullptr);
+  ~StepJournal() override;
+
+  // Reads the existing records and opens the file for appending. Sequence numbers continue after
+  // both the last record and minSeq, the sequence number of the snapshot the journal belongs to.
+  bool open(qint64 minSeq = 0);
+
+  const QString& filePath() const { return m_filePath; }
+  const QList<Entry>& entries() const { return m_entries; }
+  qint64 lastSeq() const { return m_lastSeq; }
+
+  // Returns the record's sequence number, 0 when it could not be written
+  qint64 append(int index, const Step& step);
+  bool truncateThrough(qint64 seq);
+  // Forces the appended records to disk
+  bool sync();
+
+  // Applies an entry to the step it was recorded for; false when the step's title does not match,
+  // i.e. the journal was written for a different checklist
+  static bool apply(const Entry& entry, Step& step);
+
+  static constexpr int SyncEveryRecords = 32;
+  static constexpr int SyncDelayMs = 500;
+
+private:
+  static QByteArray serialize(const Entry& entry);
+
+private:
+  QString m_filePath;
+  QFile m_file;
+  QList<Entry> m_entries;
+  qint64 m_lastSeq = 0;
+  int m_unsynced = 0;
+  QTimer m_syncTimer;
+};
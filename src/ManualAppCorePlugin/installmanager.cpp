@@ -7,6 +7,7 @@
 #include "datamanager.h"
 #include "file/fileservice.h"
 #include "file/loger.h"
+#include "network/progressaggregator.h"
 #include "reportmanager.h"
 #include "settings/settingsmanager.h"
 #include "software/licensehandler.h"
@@ -62,7 +63,8 @@ QString InstallManager::buildInstallerPath(const QString& model) const
   if (model.toLower() == "manual_app") {
     installerName = "/ManualApp.exe";
   } else {
-    installerName = "/" + SettingsManager().getCurrentSettings()->modelInstallerPath();
+    const ModelSettings* settings = SettingsManager::instance()->getCurrentSettings();
+    installerName = "/" + (settings ? settings->modelInstallerPath() : QString());
   }
 
   return appDataDir + installerName;
@@ -94,6 +96,7 @@ bool InstallManager::installerExists(const QString& model) const
     return false;
   }
 
+  // Downloads land in "<path>.part" and are renamed only after verification
   bool exists = QFile::exists(path);
   DEBUG_COLORED("InstallManager", "installerExists",
                 QString("Installer %1 exists: %2").arg(path).arg(exists ? "true" : "false"), COLOR_CYAN,
@@ -128,7 +131,7 @@ void InstallManager::downloadInstaller(const QString& model, const QString& base
 
   setIsDownloading(true);
   setDownloadProgress(0.0);
-  setStatusMessage("Starting download...");
+  setStatusMessage(QFile::exists(path + ".part") ? "Resuming download..." : "Starting download...");
 
 
   m_reportManager->networkService()->downloadFile(QUrl(url), path);
@@ -198,10 +201,18 @@ void InstallManager::onDownloadProgress(qint64 bytesSent, qint64 bytesTotal)
   if (bytesTotal > 0) {
     double progress = (static_cast<double>(bytesSent) / bytesTotal) * 100.0;
     setDownloadProgress(progress);
-    setStatusMessage(QString("Downloading: %1% (%2/%3 KB)")
-                         .arg(static_cast<int>(progress))
-                         .arg(bytesSent / 1024)
-                         .arg(bytesTotal / 1024));
+
+    // Throttled by NetworkService, so the message is rebuilt a few times per second at most
+    const ProgressAggregator* stats = m_reportManager->networkService()->progress();
+    QString message = QString("Downloading: %1% (%2/%3 KB)")
+                          .arg(static_cast<int>(progress))
+                          .arg(bytesSent / 1024)
+                          .arg(bytesTotal / 1024);
+    if (stats->bytesPerSecond() > 0) {
+      message += QString(", %1 KB/s").arg(qRound64(stats->bytesPerSecond() / 1024));
+      if (stats->etaSeconds() >= 0) message += QString(", %1 s left").arg(stats->etaSeconds());
+    }
+    setStatusMessage(message);
   }
 }
 
@@ -35,10 +35,24 @@ struct Step {
       dd.fixStatus = static_cast<FixStatus>(obj["fixStatus"].toInt(0));
       return dd;
     }
+
+    bool operator==(const DefectDetails& other) const
+    {
+      return fixStatus == other.fixStatus && description == other.description &&
+             repairMethod == other.repairMethod;
+    }
+    bool operator!=(const DefectDetails& other) const { return !(*this == other); }
   };
 
   DefectDetails defectDetails;
 
+  bool operator==(const Step& other) const
+  {
+    return completionStatus == other.completionStatus && title == other.title &&
+           defectDetails == other.defectDetails;
+  }
+  bool operator!=(const Step& other) const { return !(*this == other); }
+
   QJsonObject toJson() const
   {
     QJsonObject obj;
@@ -51,12 +65,13 @@ struct Step {
     return obj;
   }
 
-  static Step fromJson(const QJsonObject& obj)
+  // Templates start every step from scratch; stored reports keep their status when restoreStatus is set
+  static Step fromJson(const QJsonObject& obj, bool restoreStatus = false)
   {
     Step s;
     s.title = obj["title"].toString();
-    s.completionStatus = CompletionStatus ::NotStarted;
-    // static_cast<CompletionStatus>(obj["completionStatus"].toInt(0));
+    s.completionStatus = restoreStatus ? static_cast<CompletionStatus>(obj["completionStatus"].toInt(0))
+                                       : CompletionStatus::NotStarted;
 
     if (s.completionStatus == CompletionStatus::HasDefect) {
       s.defectDetails = DefectDetails::fromJson(obj["defectDetails"].toObject());
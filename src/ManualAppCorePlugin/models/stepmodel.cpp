@@ -1,6 +1,8 @@
 #include "stepmodel.h"
 
 #include <QDebug>
+#include <algorithm>
+#include <iterator>
 
 
 StepModel::StepModel(QObject* parent)
@@ -48,42 +50,66 @@ QHash<int, QByteArray> StepModel::roleNames() const
           {DefectFixStatus, "defectFixStatus"}};
 }
 
-void StepModel::setSteps(const QList<Step>& steps)
+void StepModel::setSteps(std::vector<Step> steps)
 {
-  beginResetModel();
-  m_steps = std::vector<Step>(steps.begin(), steps.end());
-  endResetModel();
+  const int oldCount = rowCount();
+  const int newCount = static_cast<int>(steps.size());
+  const int common = std::min(oldCount, newCount);
+
+  int firstChanged = -1;
+  int lastChanged = -1;
+  for (int i = 0; i < common; ++i) {
+    if (m_steps[i] == steps[i]) continue;
+    m_steps[i] = std::move(steps[i]);
+    if (firstChanged < 0) firstChanged = i;
+    lastChanged = i;
+  }
+  if (firstChanged >= 0) emit dataChanged(index(firstChanged), index(lastChanged));
+
+  if (newCount > oldCount) {
+    beginInsertRows(QModelIndex(), oldCount, newCount - 1);
+    m_steps.insert(m_steps.end(), std::make_move_iterator(steps.begin() + common),
+                   std::make_move_iterator(steps.end()));
+    endInsertRows();
+  } else if (newCount < oldCount) {
+    removeSteps(newCount, oldCount - newCount);
+  }
 }
 
 void StepModel::clear()
 {
-  beginResetModel();
-  m_steps.clear();
-  endResetModel();
+  removeSteps(0, rowCount());
 }
 
-Step StepModel::get(int index) const
+void StepModel::insertStep(int index, Step step)
 {
-  if (index >= 0 && index < static_cast<int>(m_steps.size())) {
-    return m_steps[index];
-  }
-  return {};
+  if (index < 0 || index > static_cast<int>(m_steps.size())) return;
+
+  beginInsertRows(QModelIndex(), index, index);
+  m_steps.insert(m_steps.begin() + index, std::move(step));
+  endInsertRows();
 }
 
-QVariant StepModel::getData(int index, int role) const
+void StepModel::removeSteps(int index, int count)
 {
-  if (index >= 0 && index < static_cast<int>(m_steps.size())) {
-    return data(this->index(index), role);
-  }
-  return QVariant();
+  if (count <= 0 || !isValidIndex(index) || !isValidIndex(index + count - 1)) return;
+
+  beginRemoveRows(QModelIndex(), index, index + count - 1);
+  m_steps.erase(m_steps.begin() + index, m_steps.begin() + index + count);
+  endRemoveRows();
+}
+
+const Step* StepModel::stepAt(int index) const
+{
+  return isValidIndex(index) ? &m_steps[index] : nullptr;
 }
 
-void StepModel::updateStep(int index, const Step& step)
+QVariant StepModel::getData(int index, int role) const
 {
   if (index >= 0 && index < static_cast<int>(m_steps.size())) {
-    m_steps[index] = step;
-    emit dataChanged(this->index(index), this->index(index));
+    return data(this->index(index), role);
   }
+  return QVariant();
 }
 
 void StepModel::setStepStatus(int index, Step::CompletionStatus status)
@@ -142,3 +168,30 @@ void StepModel::setDefectFixStatus(int index, Step::DefectDetails::FixStatus sta
     }
   }
 }
+
+void StepModel::setDefectDetails(int index, Step::DefectDetails details)
+{
+  if (!isValidIndex(index)) return;
+
+  Step& step = m_steps[index];
+  QVector<int> roles;
+  if (step.defectDetails.description != details.description) {
+    step.defectDetails.description = std::move(details.description);
+    roles.append(DefectDescriptionRole);
+  }
+  if (step.defectDetails.repairMethod != details.repairMethod) {
+    step.defectDetails.repairMethod = std::move(details.repairMethod);
+    roles.append(DefectRepairMethodRole);
+  }
+  if (step.defectDetails.fixStatus != details.fixStatus) {
+    step.defectDetails.fixStatus = details.fixStatus;
+    roles.append(DefectFixStatus);
+  }
+  if (step.completionStatus != Step::CompletionStatus::HasDefect) {
+    step.completionStatus = Step::CompletionStatus::HasDefect;
+    // The defect roles read as empty until the step has a defect
+    roles = {StatusRole, HasDefectRole, DefectDescriptionRole, DefectRepairMethodRole, DefectFixStatus};
+  }
+
+  if (!roles.isEmpty()) emit dataChanged(this->index(index), this->index(index), roles);
+}
@@ -2,6 +2,8 @@
 
 #include <QAbstractListModel>
 #include <QQmlEngine>
+#include <QSpan>
+#include <vector>
 
 #include "step.h"
 
@@ -27,18 +29,28 @@ public:
   QVariant data(const QModelIndex& index, int role) const override;
   QHash<int, QByteArray> roleNames() const override;
 
-  Q_INVOKABLE void setSteps(const QList<Step>& steps);
+  // Rows present before and after are updated in place and only the difference in length is
+  // inserted or removed, so reloading a checklist keeps its QML delegates
+  void setSteps(std::vector<Step> steps);
   Q_INVOKABLE void clear();
-  Q_INVOKABLE Step get(int index) const;
   Q_INVOKABLE QVariant getData(int index, int role) const;
-  Q_INVOKABLE void updateStep(int index, const Step& step);
+  void insertStep(int index, Step step);
+  void removeSteps(int index, int count = 1);
 
   Q_INVOKABLE void setStepStatus(int index, Step::CompletionStatus status);
   Q_INVOKABLE void setTitle(int index, const QString& title);
   Q_INVOKABLE void setDefectDescription(int index, const QString& description);
   Q_INVOKABLE void setDefectRepairMethod(int index, const QString& method);
   Q_INVOKABLE void setDefectFixStatus(int index, Step::DefectDetails::FixStatus status);
-  std::vector<Step> getSteps() const { return m_steps; }
+  // Marks the step as defective and replaces its details, notifying only the roles that changed
+  void setDefectDetails(int index, Step::DefectDetails details);
+
+  // Read-only view of the steps, valid until the model is modified
+  QSpan<const Step> steps() const { return m_steps; }
+  const Step* stepAt(int index) const;
+
+private:
+  bool isValidIndex(int index) const { return index >= 0 && index < static_cast<int>(m_steps.size()); }
 
 private:
   std::vector<Step> m_steps;
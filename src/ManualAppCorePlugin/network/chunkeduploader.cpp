@@ -0,0 +1,305 @@
+#include "chunkeduploader.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QTimer>
+
+#include "../file/configmanager.h"
+#include "../file/loger.h"
+
+
+ChunkedUploader::ChunkedUploader(QObject* parent)
+    : QObject(parent)
+{
+}
+
+bool ChunkedUploader::isEnabledFor(const QString& filePath)
+{
+  const int chunkSize = ConfigManager::instance().uploadChunkSize();
+  if (chunkSize <= 0 || !filePath.endsWith(".zip", Qt::CaseInsensitive)) return false;
+
+  return QFileInfo(filePath).size() > chunkSize;
+}
+
+void ChunkedUploader::start(const QUrl& fileUrl, const QString& filePath)
+{
+  QFileInfo info(filePath);
+
+  m_fileUrl = fileUrl;
+  m_filePath = filePath;
+  m_fileSize = info.size();
+  m_fileMTime = info.lastModified().toMSecsSinceEpoch();
+  m_chunkSize = qMax(1, ConfigManager::instance().uploadChunkSize());
+  m_uploadId.clear();
+  m_offset = 0;
+  m_sentOffset = 0;
+  m_attempts = 0;
+  m_aborted = false;
+  m_bytesSent = 0;
+  m_bytesResent = 0;
+
+  if (!info.exists() || m_fileSize == 0) {
+    HttpClient::HttpResponse response;
+    response.errorMessage = QString("File does not exist or is empty: %1").arg(filePath);
+    // Callers connect before start(), report asynchronously like a failed request would
+    QMetaObject::invokeMethod(this, [this, response]() { finish(response); }, Qt::QueuedConnection);
+    return;
+  }
+
+  loadState();
+  sendInit();
+}
+
+void ChunkedUploader::abort()
+{
+  m_aborted = true;
+  if (!m_client) return;
+
+  m_client->disconnect(this);
+  m_client->abort();
+  m_client->deleteLater();
+  m_client = nullptr;
+}
+
+QUrl ChunkedUploader::actionUrl(const QString& uploadId, const QString& action) const
+{
+  QString path = m_fileUrl.path();
+  if (!path.endsWith('/')) path += '/';
+  path += "chunked/";
+  if (!uploadId.isEmpty()) path += uploadId + '/';
+  if (!action.isEmpty()) path += action + '/';
+
+  QUrl url = m_fileUrl;
+  url.setPath(path);
+  return url;
+}
+
+HttpClient* ChunkedUploader::newClient()
+{
+  m_client = new HttpClient(this);
+
+  // HttpClient may report an error twice (errorOccurred and finished), only the first one counts
+  HttpClient* client = m_client;
+  connect(client, &HttpClient::finished, this, [this, client](const HttpClient::HttpResponse& response) {
+    client->disconnect(this);
+    client->deleteLater();
+    if (m_client == client) m_client = nullptr;
+    onResponse(response);
+  });
+  return client;
+}
+
+void ChunkedUploader::sendInit()
+{
+  if (m_aborted) return;
+  m_stage = Stage::Init;
+
+  QJsonObject request{{"file_name", QFileInfo(m_filePath).fileName()},
+                      {"file_size", static_cast<double>(m_fileSize)},
+                      {"chunk_size", static_cast<double>(m_chunkSize)}};
+  if (!m_uploadId.isEmpty()) request["upload_id"] = m_uploadId;
+
+  newClient()->postJson(actionUrl(QString(), QString()), request);
+}
+
+void ChunkedUploader::sendNextChunk()
+{
+  m_stage = Stage::Chunk;
+
+  QFile file(m_filePath);
+  if (!file.open(QIODevice::ReadOnly) || !file.seek(m_offset)) {
+    HttpClient::HttpResponse response;
+    response.errorMessage = QString("Cannot read %1").arg(m_filePath);
+    finish(response);
+    return;
+  }
+  const QByteArray chunk = file.read(m_chunkSize);
+  file.close();
+
+  m_chunkLength = chunk.size();
+  if (m_offset < m_sentOffset) m_bytesResent += qMin(m_chunkLength, m_sentOffset - m_offset);
+  m_sentOffset = qMax(m_sentOffset, m_offset + m_chunkLength);
+  saveState();
+
+  const QByteArray range =
+      QString("bytes %1-%2/%3").arg(m_offset).arg(m_offset + m_chunkLength - 1).arg(m_fileSize).toLatin1();
+  const QByteArray checksum = QCryptographicHash::hash(chunk, QCryptographicHash::Sha256).toHex();
+
+  HttpClient* client = newClient();
+  connect(client, &HttpClient::progress, this, [this](qint64 sent, qint64 total) {
+    Q_UNUSED(total)
+    emit progress(m_bytesSent + sent, m_fileSize);
+  });
+  client->put(actionUrl(m_uploadId, QString()), chunk,
+              {{"Content-Range", range}, {"X-Chunk-SHA256", checksum}});
+}
+
+void ChunkedUploader::sendComplete()
+{
+  m_stage = Stage::Complete;
+  newClient()->postJson(actionUrl(m_uploadId, "complete"),
+                        QJsonObject{{"file_size", static_cast<double>(m_fileSize)}});
+}
+
+void ChunkedUploader::onResponse(const HttpClient::HttpResponse& response)
+{
+  if (m_stage == Stage::Fallback) {
+    if (response.success) m_bytesSent = m_fileSize;
+    finish(response);
+    return;
+  }
+  if (m_stage == Stage::Init && (response.statusCode == 404 || response.statusCode == 405)) {
+    fallBack();
+    return;
+  }
+
+  if (!response.success) {
+    retryOrFail(response);
+    return;
+  }
+
+  const QJsonObject body = QJsonDocument::fromJson(response.body).object();
+
+  switch (m_stage) {
+    case Stage::Init: {
+      m_uploadId = body.value("upload_id").toVariant().toString();
+      const qint64 offset = static_cast<qint64>(body.value("offset").toDouble());
+      // Anything that is not a chunk boundary inside the file cannot be resumed from
+      const bool onBoundary = offset % m_chunkSize == 0 || offset == m_fileSize;
+      m_offset = offset >= 0 && offset <= m_fileSize && onBoundary ? offset : 0;
+
+      if (m_uploadId.isEmpty()) {
+        HttpClient::HttpResponse error = response;
+        error.success = false;
+        error.errorMessage = "Server did not return an upload id";
+        finish(error);
+        return;
+      }
+
+      saveState();
+      if (m_offset > 0) {
+        DEBUG_COLORED("ChunkedUploader", "onResponse",
+                      QString("Resuming %1 at %2 of %3 bytes").arg(m_filePath).arg(m_offset).arg(m_fileSize),
+                      COLOR_BLUE, COLOR_BLUE);
+      }
+      break;
+    }
+    case Stage::Chunk: {
+      const qint64 confirmed = static_cast<qint64>(body.value("offset").toDouble(m_offset + m_chunkLength));
+      // Same rule as for Init, and the offset has to move forward; otherwise the same chunk would be
+      // sent again and again with the attempt counter reset by every 200
+      const bool onBoundary = confirmed % m_chunkSize == 0 || confirmed == m_fileSize;
+      if (confirmed <= m_offset || confirmed > m_fileSize || !onBoundary) {
+        HttpClient::HttpResponse error = response;
+        error.success = false;
+        error.errorMessage =
+            QString("Server confirmed offset %1 for the chunk at %2").arg(confirmed).arg(m_offset);
+        retryOrFail(error);
+        return;
+      }
+
+      m_bytesSent += m_chunkLength;
+      m_offset = confirmed;
+      m_attempts = 0;
+      saveState();
+      emit progress(m_bytesSent, m_fileSize);
+      break;
+    }
+    case Stage::Complete:
+      QFile::remove(statePath());
+      finish(response);
+      return;
+    case Stage::Fallback: return;
+  }
+
+  if (m_offset >= m_fileSize)
+    sendComplete();
+  else
+    sendNextChunk();
+}
+
+void ChunkedUploader::retryOrFail(const HttpClient::HttpResponse& response)
+{
+  if (++m_attempts >= MaxAttempts) {
+    // The sidecar stays on disk, the next attempt resumes from the last confirmed chunk
+    finish(response);
+    return;
+  }
+
+  DEBUG_ERROR_COLORED("ChunkedUploader", "retryOrFail",
+                      QString("Chunked upload of %1 failed (%2), attempt %3 of %4")
+                          .arg(m_filePath, response.errorMessage)
+                          .arg(m_attempts)
+                          .arg(MaxAttempts),
+                      COLOR_BLUE, COLOR_BLUE);
+
+  // Ask the server for its confirmed offset again, it may have stored the chunk before the failure
+  QTimer::singleShot(1000 * m_attempts, this, &ChunkedUploader::sendInit);
+}
+
+void ChunkedUploader::fallBack()
+{
+  DEBUG_COLORED("ChunkedUploader", "fallBack",
+                QString("Server has no chunked uploads, sending %1 whole").arg(m_filePath), COLOR_BLUE,
+                COLOR_BLUE);
+  m_stage = Stage::Fallback;
+  QFile::remove(statePath());
+
+  HttpClient* client = newClient();
+  connect(client, &HttpClient::progress, this, &ChunkedUploader::progress);
+  client->postFile(m_fileUrl, m_filePath);
+}
+
+void ChunkedUploader::finish(const HttpClient::HttpResponse& response)
+{
+  if (m_bytesResent > 0) {
+    DEBUG_COLORED(
+        "ChunkedUploader", "finish",
+        QString("%1: %2 bytes sent, %3 bytes re-sent").arg(m_filePath).arg(m_bytesSent).arg(m_bytesResent),
+        COLOR_BLUE, COLOR_BLUE);
+  }
+  emit finished(response);
+}
+
+void ChunkedUploader::loadState()
+{
+  QFile file(statePath());
+  if (!file.open(QIODevice::ReadOnly)) return;
+
+  const QJsonObject state = QJsonDocument::fromJson(file.readAll()).object();
+  file.close();
+
+  // A rebuilt archive or a different chunk size invalidates the stored upload
+  const bool sameUpload = state.value("path").toString() == m_fileUrl.path() &&
+                          static_cast<qint64>(state.value("size").toDouble()) == m_fileSize &&
+                          static_cast<qint64>(state.value("mtime").toDouble()) == m_fileMTime &&
+                          static_cast<qint64>(state.value("chunk_size").toDouble()) == m_chunkSize;
+  if (!sameUpload) {
+    QFile::remove(statePath());
+    return;
+  }
+
+  m_uploadId = state.value("upload_id").toString();
+  m_sentOffset = static_cast<qint64>(state.value("sent").toDouble());
+}
+
+void ChunkedUploader::saveState() const
+{
+  QJsonObject state{{"path", m_fileUrl.path()},
+                    {"upload_id", m_uploadId},
+                    {"size", static_cast<double>(m_fileSize)},
+                    {"mtime", static_cast<double>(m_fileMTime)},
+                    {"chunk_size", static_cast<double>(m_chunkSize)},
+                    {"offset", static_cast<double>(m_offset)},
+                    {"sent", static_cast<double>(m_sentOffset)}};
+
+  QSaveFile file(statePath());
+  if (!file.open(QIODevice::WriteOnly)) return;
+  file.write(QJsonDocument(state).toJson(QJsonDocument::Compact));
+  file.commit();
+}
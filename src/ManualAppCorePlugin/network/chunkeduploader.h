@@ -0,0 +1,78 @@
+#pragma once
+
+#include <QObject>
+#include <QUrl>
+
+#include "httpclient.h"
+
+// Resumable upload of one large file in fixed-size chunks.
+// Every chunk carries its SHA-256 and the server answers with the offset it has confirmed. The upload
+// id and offsets are kept in a "<file>.upload" sidecar, so after a network failure or an application
+// restart the upload continues from the last confirmed chunk instead of byte zero.
+//
+//   POST <url>chunked/                 {file_name, file_size, chunk_size, upload_id?} -> {upload_id, offset}
+//   PUT  <url>chunked/<id>/            chunk bytes, Content-Range, X-Chunk-SHA256      -> {offset}
+//   POST <url>chunked/<id>/complete/   {file_size}
+//
+// A server without these endpoints answers 404 or 405 to the init POST and gets the whole file
+// through HttpClient::postFile instead.
+class ChunkedUploader : public QObject
+{
+  Q_OBJECT
+public:
+  explicit ChunkedUploader(QObject* parent = nullptr);
+
+  // Chunked mode is used for archives larger than one chunk when upload_chunk_size_kb is not 0
+  static bool isEnabledFor(const QString& filePath);
+
+  void start(const QUrl& fileUrl, const QString& filePath);
+  void abort();
+
+  qint64 bytesSent() const { return m_bytesSent; }
+  qint64 bytesResent() const { return m_bytesResent; }
+
+signals:
+  // Bytes transferred by this uploader so far, not counting chunks the server already had
+  void progress(qint64 sent, qint64 total);
+  void finished(const HttpClient::HttpResponse& response);
+
+private:
+  enum class Stage { Init, Chunk, Complete, Fallback };
+
+  static constexpr int MaxAttempts = 4;
+
+  QUrl actionUrl(const QString& uploadId, const QString& action) const;
+  HttpClient* newClient();
+  void sendInit();
+  void sendNextChunk();
+  void sendComplete();
+  void onResponse(const HttpClient::HttpResponse& response);
+  void retryOrFail(const HttpClient::HttpResponse& response);
+  void fallBack();
+  void finish(const HttpClient::HttpResponse& response);
+
+  QString statePath() const { return m_filePath + ".upload"; }
+  void loadState();
+  void saveState() const;
+
+private:
+  HttpClient* m_client = nullptr;
+  Stage m_stage = Stage::Init;
+  int m_attempts = 0;
+  bool m_aborted = false;
+
+  QUrl m_fileUrl;
+  QString m_filePath;
+  QString m_uploadId;
+  qint64 m_fileSize = 0;
+  qint64 m_fileMTime = 0;
+  qint64 m_chunkSize = 0;
+  qint64 m_chunkLength = 0;
+
+  // Offset confirmed by the server and the furthest byte ever sent for this file
+  qint64 m_offset = 0;
+  qint64 m_sentOffset = 0;
+
+  qint64 m_bytesSent = 0;
+  qint64 m_bytesResent = 0;
+};
@@ -0,0 +1,96 @@
+#include "chunkindex.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QSaveFile>
+
+#include "../file/fileservice.h"
+#include "../file/loger.h"
+
+
+ChunkIndex& ChunkIndex::instance()
+{
+  static ChunkIndex instance(FileService().getFullFilePath("chunk_index.json"));
+  return instance;
+}
+
+ChunkIndex::ChunkIndex(const QString& filePath)
+    : m_filePath(filePath)
+{
+  load();
+}
+
+ChunkIndex::~ChunkIndex()
+{
+  save();
+}
+
+void ChunkIndex::load()
+{
+  QFile file(m_filePath);
+  if (!file.open(QIODevice::ReadOnly)) return;
+
+  const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+  file.close();
+
+  if (root.value("version").toInt() != Version) {
+    DEBUG_COLORED("ChunkIndex", "load", "Index version mismatch, starting from scratch", COLOR_BLUE,
+                  COLOR_BLUE);
+    return;
+  }
+
+  const QJsonObject servers = root.value("servers").toObject();
+  for (auto it = servers.constBegin(); it != servers.constEnd(); ++it) {
+    QSet<QByteArray>& chunks = m_chunks[it.key()];
+    for (const QJsonValue& hash : it.value().toArray())
+      chunks.insert(QByteArray::fromHex(hash.toString().toLatin1()));
+  }
+}
+
+bool ChunkIndex::contains(const QString& server, const QByteArray& hash) const
+{
+  QMutexLocker locker(&m_mutex);
+  const auto it = m_chunks.constFind(server);
+  return it != m_chunks.constEnd() && it->contains(hash);
+}
+
+void ChunkIndex::insert(const QString& server, const QByteArray& hash)
+{
+  QMutexLocker locker(&m_mutex);
+  QSet<QByteArray>& chunks = m_chunks[server];
+  if (chunks.contains(hash)) return;
+  chunks.insert(hash);
+  m_dirty = true;
+}
+
+void ChunkIndex::remove(const QString& server, const QByteArray& hash)
+{
+  QMutexLocker locker(&m_mutex);
+  auto it = m_chunks.find(server);
+  if (it != m_chunks.end() && it->remove(hash)) m_dirty = true;
+}
+
+bool ChunkIndex::save()
+{
+  QMutexLocker locker(&m_mutex);
+  if (!m_dirty) return true;
+
+  QJsonObject servers;
+  for (auto it = m_chunks.constBegin(); it != m_chunks.constEnd(); ++it) {
+    QJsonArray hashes;
+    for (const QByteArray& hash : it.value()) hashes.append(QString::fromLatin1(hash.toHex()));
+    servers[it.key()] = hashes;
+  }
+
+  QSaveFile file(m_filePath);
+  if (!file.open(QIODevice::WriteOnly)) return false;
+  file.write(QJsonDocument(QJsonObject{{"version", Version}, {"servers", servers}})
+                 .toJson(QJsonDocument::Compact));
+  if (!file.commit()) return false;
+
+  m_dirty = false;
+  return true;
+}
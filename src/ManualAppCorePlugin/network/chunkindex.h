@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+
+// Chunks each server is known to hold, kept in chunk_index.json in the application data directory.
+// DedupUploader only asks the server about chunks missing here. A stale entry costs one extra round
+// trip when the server rejects the manifest, never a broken file.
+class ChunkIndex
+{
+public:
+  static ChunkIndex& instance();
+
+  bool contains(const QString& server, const QByteArray& hash) const;
+  void insert(const QString& server, const QByteArray& hash);
+  void remove(const QString& server, const QByteArray& hash);
+  bool save();
+
+  static constexpr int Version = 1;
+
+private:
+  explicit ChunkIndex(const QString& filePath);
+  ~ChunkIndex();
+  void load();
+
+private:
+  mutable QMutex m_mutex;
+  QString m_filePath;
+  // Server authority -> SHA-256 of the chunks it holds
+  QHash<QString, QSet<QByteArray>> m_chunks;
+  bool m_dirty = false;
+};
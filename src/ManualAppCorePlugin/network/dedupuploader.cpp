@@ -0,0 +1,302 @@
+#include "dedupuploader.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+#include <QtConcurrent>
+
+#include "../file/configmanager.h"
+#include "../file/loger.h"
+#include "chunkeduploader.h"
+#include "chunkindex.h"
+
+
+DedupUploader::DedupUploader(QObject* parent)
+    : QObject(parent)
+{
+}
+
+bool DedupUploader::isEnabledFor(const QString& filePath)
+{
+  if (!ConfigManager::instance().dedupUpload() || !filePath.endsWith(".zip", Qt::CaseInsensitive))
+    return false;
+
+  return QFileInfo(filePath).size() > ContentChunker::MaxChunkSize;
+}
+
+void DedupUploader::start(const QUrl& fileUrl, const QString& filePath)
+{
+  m_fileUrl = fileUrl;
+  m_filePath = filePath;
+  m_server = fileUrl.authority();
+  m_attempts = 0;
+  m_manifestRounds = 0;
+  m_aborted = false;
+  m_bytesToSend = 0;
+  m_bytesSent = 0;
+  m_bytesSkipped = 0;
+
+  // Hashing a large archive takes a while, it runs off the GUI thread
+  auto* watcher = new QFutureWatcher<ContentChunker::Result>(this);
+  connect(watcher, &QFutureWatcher<ContentChunker::Result>::finished, this, [this, watcher]() {
+    watcher->deleteLater();
+    if (!m_aborted) onSplit(watcher->result());
+  });
+  watcher->setFuture(QtConcurrent::run([filePath]() { return ContentChunker::split(filePath); }));
+}
+
+void DedupUploader::abort()
+{
+  m_aborted = true;
+  if (m_fallback) m_fallback->abort();
+  if (!m_client) return;
+
+  m_client->disconnect(this);
+  m_client->abort();
+  m_client->deleteLater();
+  m_client = nullptr;
+}
+
+QUrl DedupUploader::actionUrl(const QString& action) const
+{
+  QString path = m_fileUrl.path();
+  if (!path.endsWith('/')) path += '/';
+  path += "dedup/" + action + '/';
+
+  QUrl url = m_fileUrl;
+  url.setPath(path);
+  return url;
+}
+
+HttpClient* DedupUploader::newClient()
+{
+  m_client = new HttpClient(this);
+
+  // HttpClient may report an error twice (errorOccurred and finished), only the first one counts
+  HttpClient* client = m_client;
+  connect(client, &HttpClient::finished, this, [this, client](const HttpClient::HttpResponse& response) {
+    client->disconnect(this);
+    client->deleteLater();
+    if (m_client == client) m_client = nullptr;
+    onResponse(response);
+  });
+  return client;
+}
+
+void DedupUploader::onSplit(const ContentChunker::Result& result)
+{
+  if (!result.error.isEmpty() || result.chunks.isEmpty()) {
+    HttpClient::HttpResponse response;
+    response.errorMessage =
+        result.error.isEmpty() ? QString("File is empty: %1").arg(m_filePath) : result.error;
+    finish(response);
+    return;
+  }
+
+  m_split = result;
+  m_chunkByHash.clear();
+  for (int i = 0; i < m_split.chunks.size(); ++i) m_chunkByHash.insert(m_split.chunks.at(i).sha256, i);
+
+  sendMissing();
+}
+
+void DedupUploader::sendMissing()
+{
+  if (m_aborted) return;
+  m_stage = Stage::Missing;
+
+  // Chunks the index already knows for this server are not asked about
+  QJsonArray unknown;
+  for (auto it = m_chunkByHash.constBegin(); it != m_chunkByHash.constEnd(); ++it) {
+    if (!ChunkIndex::instance().contains(m_server, it.key()))
+      unknown.append(QString::fromLatin1(it.key().toHex()));
+  }
+
+  if (unknown.isEmpty()) {
+    m_bytesSkipped = m_split.fileSize;
+    sendManifest();
+    return;
+  }
+  newClient()->postJson(actionUrl("missing"), QJsonObject{{"chunks", unknown}});
+}
+
+void DedupUploader::sendNextChunk()
+{
+  if (m_aborted) return;
+  m_stage = Stage::Chunk;
+
+  const ContentChunker::Chunk& chunk = m_split.chunks.at(m_queue.first());
+  QFile file(m_filePath);
+  QByteArray data;
+  if (file.open(QIODevice::ReadOnly) && file.seek(chunk.offset)) data = file.read(chunk.size);
+  file.close();
+
+  if (QCryptographicHash::hash(data, QCryptographicHash::Sha256) != chunk.sha256) {
+    HttpClient::HttpResponse response;
+    response.errorMessage = QString("%1 changed during the upload").arg(m_filePath);
+    finish(response);
+    return;
+  }
+
+  const QByteArray checksum = chunk.sha256.toHex();
+  HttpClient* client = newClient();
+  connect(client, &HttpClient::progress, this, [this](qint64 sent, qint64 total) {
+    Q_UNUSED(total)
+    emit progress(m_bytesSent + sent, m_bytesToSend);
+  });
+  client->put(actionUrl("chunks/" + QString::fromLatin1(checksum)), data, {{"X-Chunk-SHA256", checksum}});
+}
+
+void DedupUploader::sendManifest()
+{
+  if (m_aborted) return;
+  m_stage = Stage::Manifest;
+
+  QJsonArray chunks;
+  for (const ContentChunker::Chunk& chunk : m_split.chunks) {
+    chunks.append(QJsonObject{{"sha256", QString::fromLatin1(chunk.sha256.toHex())},
+                              {"size", static_cast<double>(chunk.size)}});
+  }
+  newClient()->postJson(actionUrl("manifest"),
+                        QJsonObject{{"file_name", QFileInfo(m_filePath).fileName()},
+                                    {"file_size", static_cast<double>(m_split.fileSize)},
+                                    {"sha256", QString::fromLatin1(m_split.sha256.toHex())},
+                                    {"chunks", chunks}});
+}
+
+void DedupUploader::resend()
+{
+  switch (m_stage) {
+    case Stage::Missing: sendMissing(); break;
+    case Stage::Chunk: sendNextChunk(); break;
+    case Stage::Manifest: sendManifest(); break;
+    case Stage::Fallback: break;
+  }
+}
+
+void DedupUploader::onResponse(const HttpClient::HttpResponse& response)
+{
+  if (m_stage == Stage::Fallback) {
+    finish(response);
+    return;
+  }
+  if (m_stage == Stage::Missing && response.statusCode == 404) {
+    fallBack();
+    return;
+  }
+
+  const QJsonObject body = QJsonDocument::fromJson(response.body).object();
+  if (m_stage == Stage::Manifest && response.statusCode == 409 && ++m_manifestRounds < MaxAttempts) {
+    // The server dropped chunks the index still lists; they are sent again
+    for (const QJsonValue& hash : body.value("missing").toArray())
+      ChunkIndex::instance().remove(m_server, QByteArray::fromHex(hash.toString().toLatin1()));
+    queueMissing(body.value("missing").toArray());
+    return;
+  }
+
+  if (!response.success) {
+    retryOrFail(response);
+    return;
+  }
+  m_attempts = 0;
+
+  switch (m_stage) {
+    case Stage::Missing: {
+      // Everything the server did not list is already there
+      for (auto it = m_chunkByHash.constBegin(); it != m_chunkByHash.constEnd(); ++it)
+        ChunkIndex::instance().insert(m_server, it.key());
+      const QJsonArray missing = body.value("missing").toArray();
+      for (const QJsonValue& hash : missing)
+        ChunkIndex::instance().remove(m_server, QByteArray::fromHex(hash.toString().toLatin1()));
+      queueMissing(missing);
+      return;
+    }
+    case Stage::Chunk: {
+      const ContentChunker::Chunk& chunk = m_split.chunks.at(m_queue.takeFirst());
+      ChunkIndex::instance().insert(m_server, chunk.sha256);
+      m_bytesSent += chunk.size;
+      emit progress(m_bytesSent, m_bytesToSend);
+      if (m_queue.isEmpty())
+        sendManifest();
+      else
+        sendNextChunk();
+      return;
+    }
+    case Stage::Manifest:
+      ChunkIndex::instance().save();
+      DEBUG_COLORED("DedupUploader", "onResponse",
+                    QString("%1: %2 of %3 bytes sent, %4 chunks")
+                        .arg(m_filePath)
+                        .arg(m_bytesSent)
+                        .arg(m_split.fileSize)
+                        .arg(m_split.chunks.size()),
+                    COLOR_BLUE, COLOR_BLUE);
+      finish(response);
+      return;
+    case Stage::Fallback: return;
+  }
+}
+
+void DedupUploader::queueMissing(const QJsonArray& hashes)
+{
+  for (const QJsonValue& value : hashes) {
+    const auto it = m_chunkByHash.constFind(QByteArray::fromHex(value.toString().toLatin1()));
+    if (it == m_chunkByHash.constEnd() || m_queue.contains(it.value())) continue;
+    m_queue.append(it.value());
+    m_bytesToSend += m_split.chunks.at(it.value()).size;
+  }
+  m_bytesSkipped = qMax<qint64>(0, m_split.fileSize - m_bytesToSend);
+
+  if (m_queue.isEmpty())
+    sendManifest();
+  else
+    sendNextChunk();
+}
+
+void DedupUploader::retryOrFail(const HttpClient::HttpResponse& response)
+{
+  if (++m_attempts >= MaxAttempts) {
+    // Confirmed chunks are in the index, the next attempt skips them
+    ChunkIndex::instance().save();
+    finish(response);
+    return;
+  }
+
+  DEBUG_ERROR_COLORED("DedupUploader", "retryOrFail",
+                      QString("Deduplicated upload of %1 failed (%2), attempt %3 of %4")
+                          .arg(m_filePath, response.errorMessage)
+                          .arg(m_attempts)
+                          .arg(MaxAttempts),
+                      COLOR_BLUE, COLOR_BLUE);
+
+  QTimer::singleShot(1000 * m_attempts, this, &DedupUploader::resend);
+}
+
+void DedupUploader::fallBack()
+{
+  DEBUG_COLORED("DedupUploader", "fallBack",
+                QString("Server has no deduplicated uploads, sending %1 whole").arg(m_filePath), COLOR_BLUE,
+                COLOR_BLUE);
+  m_stage = Stage::Fallback;
+
+  if (!ChunkedUploader::isEnabledFor(m_filePath)) {
+    HttpClient* client = newClient();
+    connect(client, &HttpClient::progress, this, &DedupUploader::progress);
+    client->postFile(m_fileUrl, m_filePath);
+    return;
+  }
+
+  m_fallback = new ChunkedUploader(this);
+  connect(m_fallback, &ChunkedUploader::progress, this, &DedupUploader::progress);
+  connect(m_fallback, &ChunkedUploader::finished, this, &DedupUploader::finish);
+  m_fallback->start(m_fileUrl, m_filePath);
+}
+
+void DedupUploader::finish(const HttpClient::HttpResponse& response)
+{
+  emit finished(response);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <QHash>
+#include <QJsonArray>
+#include <QList>
+#include <QObject>
+#include <QUrl>
+
+#include "../file/contentchunker.h"
+#include "httpclient.h"
+
+class ChunkedUploader;
+
+// Upload of one archive as content-defined chunks, sending only the chunks the server lacks.
+// ContentChunker splits the file by content, so the before_to and after_to archives of a TO, whose
+// recordings are deflated entry by entry, share most of their chunks; ChunkIndex remembers what each
+// server already holds. A manifest lists the chunks in order so the server can rebuild the file.
+//
+//   POST <url>dedup/missing/          {chunks: [sha256, ...]}                    -> {missing: [sha256, ...]}
+//   PUT  <url>dedup/chunks/<sha256>/  chunk bytes, X-Chunk-SHA256
+//   POST <url>dedup/manifest/         {file_name, file_size, sha256, chunks: [{sha256, size}, ...]}
+//                                     -> 409 {missing: [sha256, ...]} when the server dropped chunks
+//
+// A server without these endpoints answers 404 to dedup/missing/ and gets the whole file through
+// ChunkedUploader or a plain multipart post instead.
+class DedupUploader : public QObject
+{
+  Q_OBJECT
+public:
+  explicit DedupUploader(QObject* parent = nullptr);
+
+  // Used for archives larger than one chunk when dedup_upload is set
+  static bool isEnabledFor(const QString& filePath);
+
+  void start(const QUrl& fileUrl, const QString& filePath);
+  void abort();
+
+  qint64 bytesSent() const { return m_bytesSent; }
+  // Bytes of the file the server already had
+  qint64 bytesSkipped() const { return m_bytesSkipped; }
+
+signals:
+  // Chunk bytes transferred so far out of the bytes the server is missing
+  void progress(qint64 sent, qint64 total);
+  void finished(const HttpClient::HttpResponse& response);
+
+private:
+  enum class Stage { Missing, Chunk, Manifest, Fallback };
+
+  static constexpr int MaxAttempts = 4;
+
+  QUrl actionUrl(const QString& action) const;
+  HttpClient* newClient();
+  void onSplit(const ContentChunker::Result& result);
+  void sendMissing();
+  void sendNextChunk();
+  void sendManifest();
+  void resend();
+  void onResponse(const HttpClient::HttpResponse& response);
+  // Queues the chunks with the given hashes for upload
+  void queueMissing(const QJsonArray& hashes);
+  void retryOrFail(const HttpClient::HttpResponse& response);
+  void fallBack();
+  void finish(const HttpClient::HttpResponse& response);
+
+private:
+  HttpClient* m_client = nullptr;
+  ChunkedUploader* m_fallback = nullptr;
+  Stage m_stage = Stage::Missing;
+  int m_attempts = 0;
+  int m_manifestRounds = 0;
+  bool m_aborted = false;
+
+  QUrl m_fileUrl;
+  QString m_filePath;
+  QString m_server;
+  ContentChunker::Result m_split;
+  // SHA-256 -> index of the first chunk with that content
+  QHash<QByteArray, int> m_chunkByHash;
+  // Chunks still to upload, front first
+  QList<int> m_queue;
+
+  qint64 m_bytesToSend = 0;
+  qint64 m_bytesSent = 0;
+  qint64 m_bytesSkipped = 0;
+};
@@ -1,40 +1,141 @@
 #include "httpclient.h"
 
+#include <QCryptographicHash>
+#include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QFutureWatcher>
 #include <QHttpMultiPart>
 #include <QJsonDocument>
-#include <QNetworkProxy>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QSet>
 #include <QUrlQuery>
+#include <QtConcurrent>
+#include <memory>
 
+#ifdef Q_OS_WIN
+#include <qt_windows.h>
+#else
+#include <cstdio>
+#endif
+
+#include "../file/reportcodec.h"
 #include "djangoerrorparser.h"
+#include "networkaccesspool.h"
+#include "requestencoder.h"
+
+
+namespace
+{
+
+QJsonObject readJsonFile(const QString& path)
+{
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) return QJsonObject();
+  return QJsonDocument::fromJson(file.readAll()).object();
+}
+
+void writeJsonFile(const QString& path, const QJsonObject& object)
+{
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly)) return;
+  file.write(QJsonDocument(object).toJson(QJsonDocument::Compact));
+  file.commit();
+}
+
+// SHA-256 of the complete file announced by the server, from X-Checksum-SHA256 (hex) or Digest (base64)
+QByteArray expectedSha256(const QNetworkReply* reply)
+{
+  const QByteArray checksum = reply->rawHeader("X-Checksum-SHA256").trimmed();
+  if (!checksum.isEmpty()) return QByteArray::fromHex(checksum);
+
+  const QList<QByteArray> digests = reply->rawHeader("Digest").split(',');
+  for (const QByteArray& digest : digests) {
+    const QByteArray value = digest.trimmed();
+    if (value.startsWith("sha-256=") || value.startsWith("SHA-256="))
+      return QByteArray::fromBase64(value.mid(8));
+  }
+  return QByteArray();
+}
+
+// Moves from onto to in one step, an existing file at to is replaced and never missing in between
+bool replaceFile(const QString& from, const QString& to)
+{
+#ifdef Q_OS_WIN
+  return MoveFileExW(reinterpret_cast<const wchar_t*>(QDir::toNativeSeparators(from).utf16()),
+                     reinterpret_cast<const wchar_t*>(QDir::toNativeSeparators(to).utf16()),
+                     MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+  return ::rename(QFile::encodeName(from).constData(), QFile::encodeName(to).constData()) == 0;
+#endif
+}
+
+// Hosts that answered a CBOR request with 415 Unsupported Media Type
+struct CborRejections {
+  QMutex mutex;
+  QSet<QString> hosts;
+};
+
+CborRejections& cborRejections()
+{
+  static CborRejections rejections;
+  return rejections;
+}
+
+bool acceptsCbor(const QUrl& url)
+{
+  CborRejections& rejections = cborRejections();
+  QMutexLocker locker(&rejections.mutex);
+  return !rejections.hosts.contains(url.authority());
+}
+
+void rejectCbor(const QUrl& url)
+{
+  CborRejections& rejections = cborRejections();
+  QMutexLocker locker(&rejections.mutex);
+  rejections.hosts.insert(url.authority());
+}
+
+} // namespace
 
 HttpClient::HttpClient(QObject* parent)
     : QObject(parent)
+    , m_manager(NetworkAccessPool::instance().manager())
 {
-  m_manager.setProxy(QNetworkProxy::NoProxy);
 }
 
 void HttpClient::get(const QUrl& url)
 {
   QNetworkRequest request(url);
-  QNetworkReply* reply = m_manager.get(request);
+  NetworkAccessPool::instance().prepareRequest(request);
+  QNetworkReply* reply = m_manager->get(request);
+  NetworkAccessPool::instance().trackReply(reply);
   handleReply(reply);
 }
 
 void HttpClient::postJson(const QUrl& url, const QJsonObject& jsonObject)
 {
-  QJsonDocument jsonDoc(jsonObject);
-  QByteArray jsonData = jsonDoc.toJson();
-
   QNetworkRequest request(url);
   request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
   request.setRawHeader("Accept", "application/json");
-  request.setHeader(QNetworkRequest::ContentLengthHeader, QVariant(jsonData.size()));
   request.setRawHeader("User-Agent", "Qt/5.15");
   request.setRawHeader("Connection", "keep-alive");
+  NetworkAccessPool::instance().prepareRequest(request);
+
+  // Serialized once, compact, and gzipped when enabled
+  const RequestEncoder::Body body =
+      RequestEncoder::encode(request, QJsonDocument(jsonObject).toJson(QJsonDocument::Compact));
+  QNetworkReply* reply = m_manager->post(request, body.data);
+  NetworkAccessPool::instance().trackReply(reply);
 
-  QNetworkReply* reply = m_manager.post(request, jsonDoc.toJson());
+  if (body.gzipped) {
+    handleGzipReply(reply, [this, url, jsonObject]() { postJson(url, jsonObject); });
+    return;
+  }
 
   connect(reply, &QNetworkReply::errorOccurred, this, [this, reply](QNetworkReply::NetworkError code) {
     int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
@@ -59,60 +160,221 @@ void HttpClient::postJson(const QUrl& url, const QJsonObject& jsonObject)
 
   handleReply(reply);
 }
-void HttpClient::download(const QUrl& url, const QString& filePath)
+
+void HttpClient::postCbor(const QUrl& url, const QJsonObject& json)
 {
+  if (!acceptsCbor(url)) {
+    postJson(url, json);
+    return;
+  }
+
   QNetworkRequest request(url);
-  request.setTransferTimeout(0);
+  request.setHeader(QNetworkRequest::ContentTypeHeader, "application/cbor");
+  request.setRawHeader("Accept", "application/json");
+  NetworkAccessPool::instance().prepareRequest(request);
+
+  const RequestEncoder::Body body =
+      RequestEncoder::encode(request, ReportCodec::encode(json, ReportCodec::Format::Cbor));
+  QNetworkReply* reply = m_manager->post(request, body.data);
+  NetworkAccessPool::instance().trackReply(reply);
+  reply->setParent(this);
+
+  connect(reply, &QNetworkReply::finished, this, [this, reply, url, json]() {
+    // The 415 may be about the compression rather than CBOR; that is retried first
+    if (RequestEncoder::rejectedGzip(reply)) {
+      RequestEncoder::noteResponse(reply);
+      reply->deleteLater();
+      postCbor(url, json);
+      return;
+    }
+    if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 415) {
+      finishReply(reply);
+      return;
+    }
+
+    qDebug() << "Server does not accept CBOR, falling back to JSON:" << url.authority();
+    rejectCbor(url);
+    reply->deleteLater();
+    postJson(url, json);
+  });
+}
 
-  QNetworkReply* reply = m_manager.get(request);
+struct HttpClient::Download {
+  QFile file;
+  QCryptographicHash hash{QCryptographicHash::Sha256};
+  qint64 resumeFrom = 0;
+  bool bodyStarted = false;
+  // The response is neither 200 nor 206, its body is not part of the file
+  bool rejected = false;
+  QByteArray expectedHash;
+  QByteArray validator;
+  QString error;
+};
 
-  QFile* file = new QFile(filePath);
-  if (!file->open(QIODevice::WriteOnly)) {
+void HttpClient::download(const QUrl& url, const QString& filePath)
+{
+  auto state = std::make_shared<Download>();
+
+  const QString partPath = filePath + ".part";
+  state->file.setFileName(partPath);
+
+  const QJsonObject meta = readJsonFile(partPath + ".meta");
+  if (meta.value("url").toString() != url.toString() || !QFile::exists(partPath)) {
+    requestDownload(url, filePath, state);
+    return;
+  }
+
+  // A part left by an earlier attempt is hashed once, off the GUI thread, then the download continues
+  // from its end. Until the watcher finishes only the worker touches state.
+  auto* watcher = new QFutureWatcher<void>(this);
+  connect(watcher, &QFutureWatcher<void>::finished, this, [this, watcher, url, filePath, state]() {
+    watcher->deleteLater();
+    requestDownload(url, filePath, state);
+  });
+  watcher->setFuture(QtConcurrent::run([state, partPath, meta]() {
+    QFile part(partPath);
+    if (!part.open(QIODevice::ReadOnly)) return;
+    state->hash.addData(&part);
+    state->resumeFrom = part.size();
+    state->expectedHash = QByteArray::fromHex(meta.value("sha256").toString().toLatin1());
+    state->validator = meta.value("validator").toString().toUtf8();
+  }));
+}
+
+void HttpClient::requestDownload(const QUrl& url, const QString& filePath,
+                                 const std::shared_ptr<Download>& state)
+{
+  const QString partPath = filePath + ".part";
+  const QString metaPath = partPath + ".meta";
+
+  const QIODevice::OpenMode mode =
+      state->resumeFrom > 0 ? QIODevice::WriteOnly | QIODevice::Append : QIODevice::WriteOnly;
+  if (!state->file.open(mode)) {
     HttpResponse response;
     response.success = false;
-    response.errorMessage = QString("Cannot open file for writing: %1").arg(filePath);
+    response.errorMessage = QString("Cannot open file for writing: %1").arg(partPath);
     emit finished(response);
-    delete file;
-    reply->deleteLater();
     return;
   }
 
-  file->setParent(reply);
+  QNetworkRequest request(url);
+  request.setTransferTimeout(0);
+  if (state->resumeFrom > 0) {
+    request.setRawHeader("Range", QByteArray("bytes=") + QByteArray::number(state->resumeFrom) + "-");
+    if (!state->validator.isEmpty()) request.setRawHeader("If-Range", state->validator);
+  }
+  NetworkAccessPool::instance().prepareRequest(request);
+
+  QNetworkReply* reply = m_manager->get(request);
+  NetworkAccessPool::instance().trackReply(reply);
+  reply->setParent(this);
+
+  // Decides between appending (206) and starting over (200) once the response headers are known.
+  // Any other status is an error page: the part and its meta stay as they are.
+  auto beginBody = [reply, state, url, metaPath]() {
+    state->bodyStarted = true;
+    const int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (statusCode != 200 && statusCode != 206) {
+      state->rejected = true;
+      return;
+    }
 
-  connect(reply, &QNetworkReply::downloadProgress, this, &HttpClient::progress);
+    if (statusCode == 206) {
+      static const QRegularExpression rangeRe(R"(^bytes (\d+)-)");
+      const auto match = rangeRe.match(QString::fromLatin1(reply->rawHeader("Content-Range")));
+      if (!match.hasMatch() || match.captured(1).toLongLong() != state->resumeFrom) {
+        state->error = "Server returned an unexpected byte range";
+        reply->abort();
+        return;
+      }
+    } else if (state->resumeFrom > 0) {
+      state->file.resize(0);
+      state->hash.reset();
+      state->resumeFrom = 0;
+      state->expectedHash.clear();
+    }
+
+    const QByteArray expected = expectedSha256(reply);
+    if (!expected.isEmpty()) state->expectedHash = expected;
+
+    QByteArray validator = reply->rawHeader("ETag");
+    if (validator.isEmpty()) validator = reply->rawHeader("Last-Modified");
+    writeJsonFile(metaPath, QJsonObject{{"url", url.toString()},
+                                        {"validator", QString::fromUtf8(validator)},
+                                        {"sha256", QString::fromLatin1(state->expectedHash.toHex())}});
+  };
+
+  connect(reply, &QNetworkReply::downloadProgress, this, [this, state](qint64 received, qint64 total) {
+    emit progress(state->resumeFrom + received, total < 0 ? total : state->resumeFrom + total);
+  });
+
+  connect(reply, &QNetworkReply::readyRead, this, [reply, state, beginBody]() {
+    if (!state->bodyStarted) beginBody();
+    if (!state->error.isEmpty() || state->rejected) return;
+
+    const QByteArray data = reply->readAll();
+    state->file.write(data);
+    state->hash.addData(data);
+  });
 
-  connect(reply, &QNetworkReply::readyRead, this, [reply, file]() { file->write(reply->readAll()); });
+  connect(reply, &QNetworkReply::finished, this, [this, reply, url, filePath, state, beginBody]() {
+    const QString partPath = filePath + ".part";
+    const QString metaPath = partPath + ".meta";
 
-  connect(reply, &QNetworkReply::finished, this, [this, reply, filePath, file]() {
     HttpResponse response;
     response.statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
-    file->write(reply->readAll());
-    file->close();
-
-    if (reply->error() == QNetworkReply::NoError && response.statusCode >= 200 && response.statusCode < 300) {
-      response.success = true;
-      response.errorMessage = QString();
-    } else {
-      response.success = false;
-      response.errorMessage = DjangoErrorParser::parse(reply->readAll());
-      if (response.errorMessage.isEmpty()) {
-        response.errorMessage = reply->errorString();
+    if (state->error.isEmpty() && reply->error() == QNetworkReply::NoError) {
+      if (!state->bodyStarted) beginBody();
+      if (!state->rejected) {
+        const QByteArray data = reply->readAll();
+        state->file.write(data);
+        state->hash.addData(data);
       }
+    }
+    state->file.close();
+
+    // 416 on a resumed request: the part may already hold the whole file
+    const bool rangeSatisfied = state->resumeFrom > 0 && response.statusCode == 416;
+    const bool complete = rangeSatisfied || (!state->rejected && reply->error() == QNetworkReply::NoError &&
+                                             response.statusCode >= 200 && response.statusCode < 300);
+
+    if (rangeSatisfied && state->expectedHash.isEmpty()) {
+      // Nothing to verify the part against, it is dropped and the file fetched from the start
+      QFile::remove(partPath);
+      QFile::remove(metaPath);
+      reply->deleteLater();
+      download(url, filePath);
+      return;
+    }
 
-      QFile::remove(filePath);
+    if (!state->error.isEmpty()) {
+      response.errorMessage = state->error;
+      QFile::remove(partPath);
+      QFile::remove(metaPath);
+    } else if (!complete) {
+      // The part stays on disk, the next attempt only fetches what is missing
+      response.errorMessage = DjangoErrorParser::parse(reply->readAll());
+      if (response.errorMessage.isEmpty()) response.errorMessage = reply->errorString();
+    } else if (state->expectedHash.isEmpty()) {
+      // Nothing to verify the file against; filePath existing has to mean complete and verified
+      response.errorMessage = QString("Server sent no SHA-256 for %1").arg(filePath);
+      QFile::remove(partPath);
+      QFile::remove(metaPath);
+    } else if (state->hash.result() != state->expectedHash) {
+      response.errorMessage = QString("Checksum mismatch for %1").arg(filePath);
+      QFile::remove(partPath);
+      QFile::remove(metaPath);
+    } else if (!replaceFile(partPath, filePath)) {
+      response.errorMessage = QString("Cannot move %1 into place").arg(partPath);
+    } else {
+      QFile::remove(metaPath);
+      response.success = true;
     }
 
     emit finished(response);
     reply->deleteLater();
   });
-
-  connect(reply, &QNetworkReply::errorOccurred, this,
-          [this, reply, filePath](QNetworkReply::NetworkError code) {
-            Q_UNUSED(code)
-            QFile::remove(filePath);
-            handleNetworkError(reply, reply->error());
-          });
 }
 
 void HttpClient::postFile(const QUrl& url, const QString& filePath)
@@ -134,6 +396,24 @@ void HttpClient::postFile(const QUrl& url, const QString& filePath)
     return;
   }
 
+  // Hosts that accept gzip get the whole multipart body compressed, block by block
+  const QByteArray boundary =
+      "boundary_" + QByteArray::number(QRandomGenerator::global()->generate64(), 16);
+  if (QTemporaryFile* encoded = RequestEncoder::encodeMultipart(url, filePath, boundary, this)) {
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "multipart/form-data; boundary=" + boundary);
+    request.setHeader(QNetworkRequest::ContentLengthHeader, encoded->size());
+    request.setRawHeader("Content-Encoding", "gzip");
+    NetworkAccessPool::instance().prepareRequest(request);
+    QNetworkReply* reply = m_manager->post(request, encoded);
+    NetworkAccessPool::instance().trackReply(reply);
+    encoded->setParent(reply);
+
+    connect(reply, &QNetworkReply::uploadProgress, this, &HttpClient::progress);
+    handleGzipReply(reply, [this, url, filePath]() { postFile(url, filePath); });
+    return;
+  }
+
   QFile* file = new QFile(filePath);
   if (!file->open(QIODevice::ReadOnly)) {
     HttpResponse response;
@@ -150,13 +430,15 @@ void HttpClient::postFile(const QUrl& url, const QString& filePath)
   QString fileName = QFileInfo(filePath).fileName();
   filePart.setHeader(QNetworkRequest::ContentDispositionHeader,
                      QString("form-data; name=\"file\"; filename=\"%1\"").arg(fileName));
-  filePart.setBodyDevice(file);
 
+  filePart.setBodyDevice(file);
   file->setParent(multiPart);
   multiPart->append(filePart);
 
   QNetworkRequest request(url);
-  QNetworkReply* reply = m_manager.post(request, multiPart);
+  NetworkAccessPool::instance().prepareRequest(request);
+  QNetworkReply* reply = m_manager->post(request, multiPart);
+  NetworkAccessPool::instance().trackReply(reply);
 
   multiPart->setParent(reply);
 
@@ -167,56 +449,111 @@ void HttpClient::postFile(const QUrl& url, const QString& filePath)
   handleReply(reply);
 }
 
-void HttpClient::handleReply(QNetworkReply* reply)
+void HttpClient::put(const QUrl& url, const QByteArray& data,
+                     const QList<QPair<QByteArray, QByteArray>>& headers)
 {
-  connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-    HttpResponse response;
-    response.statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-    response.body = reply->readAll();
+  QNetworkRequest request(url);
+  request.setHeader(QNetworkRequest::ContentTypeHeader, "application/octet-stream");
+  for (const auto& header : headers)
+    request.setRawHeader(header.first, header.second);
+  NetworkAccessPool::instance().prepareRequest(request);
 
-    if (reply->error() == QNetworkReply::NoError && response.statusCode >= 200 && response.statusCode < 300) {
-      response.success = true;
-      response.errorMessage = QString();
-    } else {
-      response.success = false;
+  QNetworkReply* reply = m_manager->put(request, data);
+  NetworkAccessPool::instance().trackReply(reply);
 
-      response.errorMessage = DjangoErrorParser::parse(response.body);
+  connect(reply, &QNetworkReply::uploadProgress, this, &HttpClient::progress);
 
-      if (response.errorMessage.isEmpty()) {
-        response.errorMessage = reply->errorString();
-      }
+  handleReply(reply);
+}
 
-      qDebug() << "=== HTTP Error ===";
-      qDebug() << "Status code:" << response.statusCode;
-      qDebug() << "Network error:" << reply->errorString();
-      qDebug() << "Django error:" << response.errorMessage;
-
-      if (response.statusCode >= 400 && response.statusCode <= 599) {
-        qDebug() << "HTTP error range:" << response.statusCode / 100 << "xx";
-
-        if (response.statusCode == 400)
-          qDebug() << "Bad Request";
-        else if (response.statusCode == 401)
-          qDebug() << "Unauthorized";
-        else if (response.statusCode == 403)
-          qDebug() << "Forbidden";
-        else if (response.statusCode == 404)
-          qDebug() << "Not Found";
-        else if (response.statusCode == 422)
-          qDebug() << "Unprocessable Entity";
-        else if (response.statusCode == 429)
-          qDebug() << "Too Many Requests";
-        else if (response.statusCode >= 500)
-          qDebug() << "Server Error";
-      }
-      qDebug() << "===================";
+void HttpClient::abort()
+{
+  const QList<QNetworkReply*> replies = findChildren<QNetworkReply*>(Qt::FindDirectChildrenOnly);
+  for (QNetworkReply* reply : replies)
+    reply->abort();
+
+  // A download still hashing its part has no reply yet, it is dropped before sending the request
+  const QList<QFutureWatcherBase*> watchers = findChildren<QFutureWatcherBase*>(Qt::FindDirectChildrenOnly);
+  for (QFutureWatcherBase* watcher : watchers) {
+    delete watcher;
+    HttpResponse response;
+    response.errorMessage = "Operation canceled";
+    emit finished(response);
+  }
+}
+
+void HttpClient::handleReply(QNetworkReply* reply)
+{
+  reply->setParent(this);
+  connect(reply, &QNetworkReply::finished, this, [this, reply]() { finishReply(reply); });
+}
+
+void HttpClient::handleGzipReply(QNetworkReply* reply, const std::function<void()>& resend)
+{
+  reply->setParent(this);
+  connect(reply, &QNetworkReply::finished, this, [this, reply, resend]() {
+    if (!RequestEncoder::rejectedGzip(reply)) {
+      finishReply(reply);
+      return;
     }
 
-    emit finished(response);
+    qDebug() << "Server does not accept gzipped bodies, sending raw:" << reply->request().url().authority();
+    RequestEncoder::noteResponse(reply);
     reply->deleteLater();
+    resend();
   });
 }
 
+void HttpClient::finishReply(QNetworkReply* reply)
+{
+  RequestEncoder::noteResponse(reply);
+
+  HttpResponse response;
+  response.statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+  response.body = reply->readAll();
+
+  if (reply->error() == QNetworkReply::NoError && response.statusCode >= 200 && response.statusCode < 300) {
+    response.success = true;
+    response.errorMessage = QString();
+  } else {
+    response.success = false;
+
+    response.errorMessage = DjangoErrorParser::parse(response.body);
+
+    if (response.errorMessage.isEmpty()) {
+      response.errorMessage = reply->errorString();
+    }
+
+    qDebug() << "=== HTTP Error ===";
+    qDebug() << "Status code:" << response.statusCode;
+    qDebug() << "Network error:" << reply->errorString();
+    qDebug() << "Django error:" << response.errorMessage;
+
+    if (response.statusCode >= 400 && response.statusCode <= 599) {
+      qDebug() << "HTTP error range:" << response.statusCode / 100 << "xx";
+
+      if (response.statusCode == 400)
+        qDebug() << "Bad Request";
+      else if (response.statusCode == 401)
+        qDebug() << "Unauthorized";
+      else if (response.statusCode == 403)
+        qDebug() << "Forbidden";
+      else if (response.statusCode == 404)
+        qDebug() << "Not Found";
+      else if (response.statusCode == 422)
+        qDebug() << "Unprocessable Entity";
+      else if (response.statusCode == 429)
+        qDebug() << "Too Many Requests";
+      else if (response.statusCode >= 500)
+        qDebug() << "Server Error";
+    }
+    qDebug() << "===================";
+  }
+
+  emit finished(response);
+  reply->deleteLater();
+}
+
 void HttpClient::handleNetworkError(QNetworkReply* reply, QNetworkReply::NetworkError code)
 {
   int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
@@ -4,6 +4,8 @@
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QObject>
+#include <functional>
+#include <memory>
 
 class HttpClient : public QObject
 {
@@ -20,16 +22,30 @@ public:
 
   void get(const QUrl& url);
   void postJson(const QUrl& url, const QJsonObject& json);
+  // Sends json as application/cbor; when the server answers 415 the request is repeated as JSON and
+  // the host is remembered, later calls for it go straight to postJson()
+  void postCbor(const QUrl& url, const QJsonObject& json);
   void postFile(const QUrl& url, const QString& filePath);
+  void put(const QUrl& url, const QByteArray& data, const QList<QPair<QByteArray, QByteArray>>& headers = {});
+  // Downloads into "<filePath>.part", resuming it with a Range request; filePath only appears once the
+  // transfer is complete and its SHA-256 matches the one announced by the server in X-Checksum-SHA256
+  // or Digest. A response without either fails, an unverified file is never moved into place.
   void download(const QUrl& url, const QString& filePath);
+  void abort();
 signals:
   void finished(const HttpClient::HttpResponse& response);
   void progress(qint64 sent, qint64 total);
 
 private:
+  struct Download;
+
+  void requestDownload(const QUrl& url, const QString& filePath, const std::shared_ptr<Download>& state);
   void handleReply(QNetworkReply* reply);
+  // For a gzipped request: after a 415 the host gets raw bodies and resend() repeats the request
+  void handleGzipReply(QNetworkReply* reply, const std::function<void()>& resend);
+  void finishReply(QNetworkReply* reply);
   void handleNetworkError(QNetworkReply* reply, QNetworkReply::NetworkError code);
 
 private:
-  QNetworkAccessManager m_manager;
+  QNetworkAccessManager* m_manager;
 };
@@ -0,0 +1,93 @@
+#include "networkaccesspool.h"
+
+#include <QCoreApplication>
+#include <QNetworkProxy>
+#include <QThread>
+#include <memory>
+
+#include "../file/loger.h"
+
+
+NetworkAccessPool& NetworkAccessPool::instance()
+{
+  static NetworkAccessPool instance;
+  return instance;
+}
+
+NetworkAccessPool::NetworkAccessPool(QObject* parent)
+    : QObject(parent)
+{
+}
+
+QNetworkAccessManager* NetworkAccessPool::manager()
+{
+  // QNetworkAccessManager is bound to the thread it was created in
+  thread_local QNetworkAccessManager* threadManager = nullptr;
+  if (!threadManager) {
+    threadManager = createManager();
+    QObject::connect(threadManager, &QObject::destroyed, [] { threadManager = nullptr; });
+  }
+  return threadManager;
+}
+
+QNetworkAccessManager* NetworkAccessPool::createManager()
+{
+  auto* manager = new QNetworkAccessManager();
+  manager->setProxy(QNetworkProxy::NoProxy);
+  // Abort only transfers that stall; large archives may legitimately take longer than any fixed deadline
+  manager->setTransferTimeout(30000);
+
+  QThread* thread = QThread::currentThread();
+  QCoreApplication* app = QCoreApplication::instance();
+  if (app && app->thread() == thread) {
+    manager->setParent(app);
+  } else {
+    QObject::connect(thread, &QThread::finished, manager, &QObject::deleteLater, Qt::DirectConnection);
+  }
+
+  DEBUG_COLORED("NetworkAccessPool", "createManager", "Created shared network manager for thread",
+                COLOR_BLUE, COLOR_BLUE);
+  return manager;
+}
+
+void NetworkAccessPool::prepareRequest(QNetworkRequest& request) const
+{
+  // HTTP/2 is negotiated through ALPN for https; plain http stays on pooled HTTP/1.1 keep-alive
+  request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+}
+
+void NetworkAccessPool::trackReply(QNetworkReply* reply)
+{
+  m_requests.fetchAndAddRelaxed(1);
+
+  auto openedSocket = std::make_shared<bool>(false);
+  connect(reply, &QNetworkReply::socketStartedConnecting, reply, [this, openedSocket]() {
+    *openedSocket = true;
+    m_connectionsOpened.fetchAndAddRelaxed(1);
+  });
+  connect(reply, &QNetworkReply::finished, reply, [this, reply, openedSocket]() {
+    if (!*openedSocket && reply->error() == QNetworkReply::NoError) {
+      m_connectionsReused.fetchAndAddRelaxed(1);
+    }
+    if (reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool()) {
+      m_http2Replies.fetchAndAddRelaxed(1);
+    }
+  });
+}
+
+QString NetworkAccessPool::statistics() const
+{
+  return QString("requests: %1, connections opened: %2, reused: %3, http2: %4")
+      .arg(requestCount())
+      .arg(connectionsOpened())
+      .arg(connectionsReused())
+      .arg(http2Replies());
+}
+
+void NetworkAccessPool::resetStatistics()
+{
+  m_requests.storeRelaxed(0);
+  m_connectionsOpened.storeRelaxed(0);
+  m_connectionsReused.storeRelaxed(0);
+  m_http2Replies.storeRelaxed(0);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <QAtomicInteger>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QObject>
+
+// Process-wide owner of QNetworkAccessManager instances.
+// QNetworkAccessManager keeps its connection cache per instance, so every HttpClient
+// shares one manager per thread instead of opening a fresh TCP/TLS connection per request.
+class NetworkAccessPool : public QObject
+{
+  Q_OBJECT
+public:
+  static NetworkAccessPool& instance();
+
+  QNetworkAccessManager* manager();
+  void prepareRequest(QNetworkRequest& request) const;
+  void trackReply(QNetworkReply* reply);
+
+  quint64 requestCount() const { return m_requests.loadRelaxed(); }
+  quint64 connectionsOpened() const { return m_connectionsOpened.loadRelaxed(); }
+  quint64 connectionsReused() const { return m_connectionsReused.loadRelaxed(); }
+  quint64 http2Replies() const { return m_http2Replies.loadRelaxed(); }
+  QString statistics() const;
+  void resetStatistics();
+
+private:
+  NetworkAccessPool(QObject* parent = nullptr);
+  QNetworkAccessManager* createManager();
+
+  QAtomicInteger<quint64> m_requests = 0;
+  QAtomicInteger<quint64> m_connectionsOpened = 0;
+  QAtomicInteger<quint64> m_connectionsReused = 0;
+  QAtomicInteger<quint64> m_http2Replies = 0;
+};
@@ -0,0 +1,119 @@
+#include "progressaggregator.h"
+
+#include <QtMath>
+
+
+namespace
+{
+
+// Throughput is sampled at most this often; shorter windows mostly measure buffering
+constexpr qint64 SampleWindowMs = 250;
+// Weight of the newest sample in the moving average
+constexpr double SmoothingFactor = 0.3;
+
+} // namespace
+
+ProgressAggregator::ProgressAggregator(QObject* parent)
+    : QObject(parent)
+{
+}
+
+void ProgressAggregator::update(const QObject* transfer, qint64 done, qint64 total)
+{
+  if (m_transfers.isEmpty()) {
+    m_sinceSample.start();
+    m_sampledDone = 0;
+    m_bytesPerSecond = 0.0;
+  }
+
+  // A resumed transfer starts above zero; its first offset is a baseline, not throughput
+  if (!m_transfers.contains(transfer)) m_sampledDone += done;
+
+  Transfer& state = m_transfers[transfer];
+  state.done = done;
+  state.total = total;
+
+  recompute();
+  sampleThroughput();
+  publish(false);
+}
+
+void ProgressAggregator::finish(const QObject* transfer)
+{
+  auto it = m_transfers.find(transfer);
+  if (it == m_transfers.end()) return;
+
+  it->finished = true;
+  if (it->total < 0) it->total = it->done;
+
+  for (const Transfer& state : std::as_const(m_transfers))
+    if (!state.finished) {
+      recompute();
+      publish(false);
+      return;
+    }
+
+  // Last one out: report the final numbers and start the next batch from zero
+  recompute();
+  publish(true);
+  reset();
+}
+
+qint64 ProgressAggregator::etaSeconds() const
+{
+  if (m_total < 0 || m_bytesPerSecond <= 0.0) return -1;
+  return qCeil(static_cast<double>(m_total - m_done) / m_bytesPerSecond);
+}
+
+void ProgressAggregator::recompute()
+{
+  m_done = 0;
+  m_total = 0;
+  for (const Transfer& state : std::as_const(m_transfers)) {
+    m_done += state.done;
+    if (state.total < 0 || m_total < 0)
+      m_total = -1;
+    else
+      m_total += state.total;
+  }
+}
+
+void ProgressAggregator::sampleThroughput()
+{
+  const qint64 elapsed = m_sinceSample.elapsed();
+  if (elapsed < SampleWindowMs) return;
+
+  // Resumed downloads start above zero, and restarted ones go back; neither is throughput
+  const double rate = qMax<qint64>(0, m_done - m_sampledDone) * 1000.0 / elapsed;
+  m_bytesPerSecond =
+      m_bytesPerSecond <= 0.0 ? rate : SmoothingFactor * rate + (1.0 - SmoothingFactor) * m_bytesPerSecond;
+
+  m_sampledDone = m_done;
+  m_sinceSample.restart();
+}
+
+void ProgressAggregator::publish(bool force)
+{
+  if (!force && m_emittedDone >= 0) {
+    if (m_done == m_emittedDone) return;
+
+    const qint64 elapsed = m_sinceEmit.elapsed();
+    if (elapsed < m_minIntervalMs) return;
+
+    const bool stepReached =
+        m_total <= 0 || (m_done - m_emittedDone) * 100.0 / m_total >= m_minStepPercent || m_done == m_total;
+    if (!stepReached && elapsed < HeartbeatMs) return;
+  }
+
+  m_emittedDone = m_done;
+  m_sinceEmit.start();
+  emit progressChanged(m_done, m_total);
+}
+
+void ProgressAggregator::reset()
+{
+  m_transfers.clear();
+  m_done = 0;
+  m_total = -1;
+  m_emittedDone = -1;
+}
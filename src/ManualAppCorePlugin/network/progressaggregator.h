@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+
+// Merges the progress of concurrent transfers into one throttled stream.
+// Updates are coalesced to at most one progressChanged() per minimum interval, and only once the combined
+// progress moved by the minimum step (or after a heartbeat, so the speed and ETA keep updating).
+// Throughput is an exponentially weighted moving average, which keeps the ETA from jumping with every packet.
+class ProgressAggregator : public QObject
+{
+  Q_OBJECT
+public:
+  explicit ProgressAggregator(QObject* parent = nullptr);
+
+  // Reports the progress of one transfer; total < 0 when unknown
+  void update(const QObject* transfer, qint64 done, qint64 total);
+  // Marks a transfer as done; its bytes keep counting until every transfer has finished
+  void finish(const QObject* transfer);
+
+  void setMinInterval(int ms) { m_minIntervalMs = qMax(0, ms); }
+  // Percent of the combined total
+  void setMinStep(double percent) { m_minStepPercent = qMax(0.0, percent); }
+
+  qint64 bytesDone() const { return m_done; }
+  // -1 while any running transfer has an unknown size
+  qint64 bytesTotal() const { return m_total; }
+  double bytesPerSecond() const { return m_bytesPerSecond; }
+  // Seconds left at the current throughput, -1 when unknown
+  qint64 etaSeconds() const;
+
+  static constexpr int HeartbeatMs = 1000;
+
+signals:
+  void progressChanged(qint64 done, qint64 total);
+
+private:
+  struct Transfer {
+    qint64 done = 0;
+    qint64 total = -1;
+    bool finished = false;
+  };
+
+  void recompute();
+  void sampleThroughput();
+  void publish(bool force);
+  void reset();
+
+private:
+  QHash<const QObject*, Transfer> m_transfers;
+  qint64 m_done = 0;
+  qint64 m_total = -1;
+
+  int m_minIntervalMs = 50;
+  double m_minStepPercent = 1.0;
+  QElapsedTimer m_sinceEmit;
+  qint64 m_emittedDone = -1;
+
+  QElapsedTimer m_sinceSample;
+  qint64 m_sampledDone = 0;
+  double m_bytesPerSecond = 0.0;
+};
@@ -0,0 +1,329 @@
+#include "reportsync.h"
+
+#include <QCoreApplication>
+#include <QDate>
+#include <QDateTime>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QUrlQuery>
+#include <algorithm>
+#include <memory>
+
+#include "../file/configmanager.h"
+#include "../file/loger.h"
+#include "../file/reportindex.h"
+#include "../file/reportioexecutor.h"
+
+
+namespace
+{
+
+// A local report and the manifest state the server acknowledged for it, copied for the planning job
+struct UploadCandidate {
+  QString key;
+  ReportUploader::Job job;
+  QHash<QString, SyncManifest::FileState> acknowledged;
+};
+
+struct UploadPlan {
+  QList<ReportUploader::Job> jobs;
+  QHash<QString, QHash<QString, SyncManifest::FileState>> states;
+};
+
+// Runs on a pool thread: hashing a changed PDF or archive takes far too long for the GUI thread
+bool planReportUpload(const UploadCandidate& candidate, ReportUploader::Job* job,
+                      QHash<QString, SyncManifest::FileState>* states)
+{
+  QDir reportDir(job->reportPath);
+
+  for (const auto& artifact : ReportUploader::artifactEndpoints()) {
+    SyncManifest::FileState state;
+    if (!SyncManifest::needsUpload(candidate.acknowledged.value(artifact.first),
+                                   reportDir.filePath(artifact.first), &state))
+      continue;
+    if (state.size <= 0) continue;
+
+    states->insert(artifact.first, state);
+    job->artifacts << artifact.first;
+  }
+
+  // The metadata POST carries the content of report.json
+  SyncManifest::FileState metadataState;
+  job->sendMetadata =
+      SyncManifest::needsUpload(candidate.acknowledged.value(ReportUploader::MetadataArtifact),
+                                reportDir.filePath("report.json"), &metadataState);
+  if (job->sendMetadata) states->insert(ReportUploader::MetadataArtifact, metadataState);
+
+  return !job->artifacts.isEmpty() || job->sendMetadata;
+}
+
+} // namespace
+
+ReportSync::ReportSync(const QString& manifestPath, ReportIndex* reportIndex, ReportIoExecutor* ioExecutor,
+                       ReportUploader* uploader, QObject* parent)
+    : QObject(parent)
+    , m_manifest(manifestPath)
+    , m_reportIndex(reportIndex)
+    , m_ioExecutor(ioExecutor)
+    , m_uploader(uploader)
+{
+  m_manifest.load();
+
+  connect(m_uploader, &ReportUploader::reportFinished, this,
+          [this](const ReportUploader::Job& job, bool success, const QString& error) {
+            if (!m_running) return;
+            if (!success) {
+              DEBUG_ERROR_COLORED("ReportSync", "reportFinished",
+                                  QString("Failed to upload report: %1 (%2)").arg(job.reportPath, error),
+                                  COLOR_CYAN, COLOR_CYAN);
+              return;
+            }
+            m_reportIndex->setUploaded(job.numberTO, job.uploadTime, true);
+            if (m_manifest.isDirty()) m_manifest.save();
+          });
+  connect(m_uploader, &ReportUploader::artifactAccepted, this,
+          [this](const ReportUploader::Job& job, const QString& artifact) {
+            const QString key = SyncManifest::reportKey(job.numberTO, job.uploadTime);
+            const auto states = m_plannedStates.constFind(key);
+            if (states == m_plannedStates.constEnd()) return;
+
+            const auto state = states->constFind(artifact);
+            if (state != states->constEnd()) m_manifest.acknowledge(key, artifact, state.value());
+          });
+  connect(m_uploader, &ReportUploader::finished, this, [this](int succeeded, int failed) {
+    if (m_running) finish(succeeded, failed);
+  });
+}
+
+ReportSync::~ReportSync()
+{
+  flush();
+}
+
+void ReportSync::start(const QString& baseUrl, const QString& serialNumber, const QString& model)
+{
+  cancel();
+  m_baseUrl = baseUrl;
+  m_serialNumber = serialNumber;
+  m_model = model;
+  m_running = true;
+  const int generation = m_generation;
+
+  QUrl apiUrl(QString(baseUrl + "/api/" + model + "/%1/get_reports").arg(serialNumber));
+
+  // Servers that support it only list reports changed since the previous sync
+  const QString since = ConfigManager::instance().deltaSync() ? m_manifest.lastServerSync() : QString();
+  if (!since.isEmpty()) {
+    QUrlQuery query;
+    query.addQueryItem("since", since);
+    apiUrl.setQuery(query);
+  }
+  const QString requestTime = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+
+  DEBUG_COLORED("ReportSync", "start", QString("Requesting report listing: %1").arg(apiUrl.toString()),
+                COLOR_CYAN, COLOR_CYAN);
+
+  auto* client = new HttpClient(this);
+  m_listingClient = client;
+  connect(client, &HttpClient::finished, this,
+          [this, client, generation, requestTime](const HttpClient::HttpResponse& response) {
+            // HttpClient may report an error twice, only the first one counts
+            client->disconnect(this);
+            client->deleteLater();
+            if (generation != m_generation) return;
+
+            if (!response.success) {
+              DEBUG_ERROR_COLORED("ReportSync", "start",
+                                  "Error when receiving data: " + response.errorMessage, COLOR_CYAN,
+                                  COLOR_CYAN);
+              m_running = false;
+              emit listingFinished(false, response.errorMessage);
+              return;
+            }
+            processListing(QJsonDocument::fromJson(response.body).object(), requestTime);
+            emit listingFinished(true, QString());
+          });
+  client->get(apiUrl);
+}
+
+void ReportSync::processListing(const QJsonObject& serverReports, const QString& requestTime)
+{
+  const int generation = m_generation;
+  const QString basePath = m_reportIndex->reportsRoot();
+
+  const bool deltaSync = ConfigManager::instance().deltaSync();
+  // A listing filtered by ?since= only contains reports that changed on the server
+  const bool incremental = deltaSync && serverReports.value("incremental").toBool();
+  if (!deltaSync) m_manifest.clear();
+
+  QList<UploadCandidate> candidates;
+  m_plannedStates.clear();
+
+  QDate oneMonthAgo = QDate::currentDate().addMonths(-1).addDays(-1);
+
+  QHash<QString, QJsonObject> onlineReportMap;
+  for (auto const& number_to : NumbersTO) {
+    const QJsonArray onlineReports = serverReports[number_to].toArray();
+    for (const auto& val : onlineReports) {
+      if (val.isObject()) {
+        QJsonObject reportObj = val.toObject();
+        onlineReportMap[SyncManifest::reportKey(number_to, reportObj["date"].toString())] = reportObj;
+      }
+    }
+  }
+
+  const QList<ReportIndex::Entry> localReports = m_reportIndex->entries();
+  for (const ReportIndex::Entry& entry : localReports) {
+    if (!entry.hasReportDir) continue;
+    if (std::none_of(NumbersTO.begin(), NumbersTO.end(),
+                     [&entry](const char* number_to) { return entry.numberTO == number_to; }))
+      continue;
+
+    const QString& number_to = entry.numberTO;
+    const QString& localReport = entry.date;
+    const QString key = SyncManifest::reportKey(number_to, localReport);
+    QDate reportDate = QDate::fromString(localReport, "yyyy-MM-dd");
+    QString fullReportPath = basePath + number_to + "/" + localReport;
+    QDir reportDir(fullReportPath);
+    if (!entry.hasJson && !entry.hasPdf && reportDir.isEmpty()) {
+      if (reportDir.removeRecursively()) {
+        DEBUG_COLORED("ReportSync", "processListing",
+                      QString("Deleted empty report: %1/%2").arg(number_to).arg(localReport), COLOR_CYAN,
+                      COLOR_CYAN);
+        m_reportIndex->removeReport(number_to, localReport);
+        m_manifest.forget(key);
+        continue;
+      } else {
+        DEBUG_ERROR_COLORED("ReportSync", "processListing",
+                            QString("Failed to delete empty report: %1/%2").arg(number_to).arg(localReport),
+                            COLOR_CYAN, COLOR_CYAN);
+      }
+    }
+    if (reportDate.isValid() && reportDate < oneMonthAgo) {
+      if (QDir(fullReportPath).removeRecursively()) {
+        DEBUG_COLORED("ReportSync", "processListing",
+                      QString("Deleted old report: %1/%2").arg(number_to).arg(localReport), COLOR_CYAN,
+                      COLOR_CYAN);
+        m_reportIndex->removeReport(number_to, localReport);
+        m_manifest.forget(key);
+      } else {
+        DEBUG_ERROR_COLORED("ReportSync", "processListing",
+                            QString("Failed to delete old report: %1/%2").arg(number_to).arg(localReport),
+                            COLOR_CYAN, COLOR_CYAN);
+      }
+      continue;
+    }
+
+    if (onlineReportMap.contains(key)) {
+      QJsonObject serverReport = onlineReportMap[key];
+      bool jsonExists = serverReport["json"].toBool();
+      bool pdfExists = serverReport["pdf"].toBool();
+
+      m_reportIndex->setUploaded(number_to, localReport, jsonExists && pdfExists);
+      if (jsonExists && pdfExists) {
+        // Reports uploaded before the manifest existed: accept the current files as acknowledged
+        if (!m_manifest.isKnown(key)) {
+          m_manifest.acknowledge(key, ReportUploader::MetadataArtifact,
+                                 SyncManifest::stat(reportDir.filePath("report.json")));
+          for (const auto& artifact : ReportUploader::artifactEndpoints())
+            m_manifest.acknowledge(key, artifact.first,
+                                   SyncManifest::stat(reportDir.filePath(artifact.first)));
+        }
+      } else {
+        QStringList lost;
+        if (!jsonExists) lost << "report.json";
+        if (!pdfExists) lost << "report.pdf";
+        m_manifest.forgetArtifacts(key, lost);
+      }
+    } else if (!incremental) {
+      // A full listing is authoritative: the server does not have this report at all
+      m_manifest.forget(key);
+    }
+
+    UploadCandidate candidate{key, {fullReportPath + '/', localReport, number_to}, {}};
+    candidate.acknowledged.insert(ReportUploader::MetadataArtifact,
+                                  m_manifest.acknowledged(key, ReportUploader::MetadataArtifact));
+    for (const auto& artifact : ReportUploader::artifactEndpoints())
+      candidate.acknowledged.insert(artifact.first, m_manifest.acknowledged(key, artifact.first));
+    candidates.append(candidate);
+  }
+
+  const QString serverTime = serverReports.value("server_time").toString();
+  m_manifest.setLastServerSync(serverTime.isEmpty() ? requestTime : serverTime);
+  if (m_manifest.isDirty()) m_manifest.save();
+
+  // Changed artifacts are hashed on the I/O pool; the uploads start from the completion
+  auto plan = std::make_shared<UploadPlan>();
+  m_ioExecutor->submit(
+      "sync-plan",
+      [candidates, plan](const ReportIoExecutor::Context& context) {
+        for (int i = 0; i < candidates.size(); ++i) {
+          ReportUploader::Job job = candidates[i].job;
+          QHash<QString, SyncManifest::FileState> states;
+          if (planReportUpload(candidates[i], &job, &states)) {
+            plan->jobs.append(job);
+            plan->states.insert(candidates[i].key, states);
+          }
+          context.setProgress(i + 1, candidates.size());
+        }
+        return QString();
+      },
+      [this, plan, generation](const QString&) {
+        if (generation != m_generation) return;
+        m_plannedStates = plan->states;
+        startUploads(plan->jobs);
+      });
+}
+
+void ReportSync::cancel()
+{
+  ++m_generation;
+  if (m_listingClient) {
+    m_listingClient->disconnect(this);
+    m_listingClient->abort();
+    m_listingClient->deleteLater();
+  }
+  if (m_running) m_uploader->cancel();
+  m_running = false;
+  m_plannedStates.clear();
+}
+
+void ReportSync::shutdown()
+{
+  m_shuttingDown = true;
+  cancel();
+}
+
+void ReportSync::flush()
+{
+  if (m_manifest.isDirty()) m_manifest.save();
+}
+
+void ReportSync::startUploads(const QList<ReportUploader::Job>& jobs)
+{
+  DEBUG_COLORED("ReportSync", "startUploads", QString("Found %1 reports to upload").arg(jobs.size()),
+                COLOR_CYAN, COLOR_CYAN);
+
+  if (jobs.isEmpty()) {
+    DEBUG_COLORED("ReportSync", "startUploads", "No reports to upload", COLOR_CYAN, COLOR_CYAN);
+    finish(0, 0);
+    return;
+  }
+
+  if (m_shuttingDown || QCoreApplication::closingDown()) {
+    DEBUG_COLORED("ReportSync", "startUploads", "App is closing, skipping upload", COLOR_CYAN, COLOR_CYAN);
+    m_running = false;
+    return;
+  }
+
+  m_uploader->start(QUrl(m_baseUrl + "/api/report/"), m_serialNumber, m_model, jobs);
+}
+
+void ReportSync::finish(int succeeded, int failed)
+{
+  m_running = false;
+  m_plannedStates.clear();
+  flush();
+  emit finished(succeeded, failed);
+}
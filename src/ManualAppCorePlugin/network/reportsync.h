@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <array>
+
+#include "httpclient.h"
+#include "reportuploader.h"
+#include "syncmanifest.h"
+
+class ReportIndex;
+class ReportIoExecutor;
+
+// Reconciles the stored reports with the server's get_reports listing and uploads what it lacks.
+// With delta sync the listing is requested with ?since= the previous sync. The SyncManifest records the
+// state of every artifact the server accepted, so only new or changed artifacts are sent; changed ones are
+// hashed on the report I/O executor, the uploads run through the ReportUploader.
+class ReportSync : public QObject
+{
+  Q_OBJECT
+public:
+  ReportSync(const QString& manifestPath, ReportIndex* reportIndex, ReportIoExecutor* ioExecutor,
+             ReportUploader* uploader, QObject* parent = nullptr);
+  ~ReportSync() override;
+
+  // Requests the listing of |serialNumber| from the server at |baseUrl| and uploads what it lacks
+  void start(const QString& baseUrl, const QString& serialNumber, const QString& model);
+  void cancel();
+  // Cancels for good: a planning job that completes later starts no uploads
+  void shutdown();
+  // Writes pending manifest changes
+  void flush();
+
+  bool isRunning() const { return m_running; }
+  const SyncManifest& manifest() const { return m_manifest; }
+
+  static constexpr std::array<const char*, 3> NumbersTO = {"TO-1", "TO-2", "TO-3"};
+
+signals:
+  // The listing was processed, or could not be fetched; uploads may still follow
+  void listingFinished(bool success, const QString& error);
+  // The uploads the listing called for are done, 0 and 0 when there were none
+  void finished(int succeeded, int failed);
+
+private:
+  // Reconciles a listing that was requested at |requestTime| and plans the uploads it calls for
+  void processListing(const QJsonObject& serverReports, const QString& requestTime);
+  void startUploads(const QList<ReportUploader::Job>& jobs);
+  void finish(int succeeded, int failed);
+
+private:
+  SyncManifest m_manifest;
+  ReportIndex* m_reportIndex;
+  ReportIoExecutor* m_ioExecutor;
+  ReportUploader* m_uploader;
+  QPointer<HttpClient> m_listingClient;
+
+  QString m_baseUrl;
+  QString m_serialNumber;
+  QString m_model;
+
+  // State of the artifacts each upload job sends, acknowledged once the server accepts them
+  QHash<QString, QHash<QString, SyncManifest::FileState>> m_plannedStates;
+  // Bumped by every start and cancel, so a planning job of an abandoned sync starts nothing
+  int m_generation = 0;
+  bool m_running = false;
+  bool m_shuttingDown = false;
+};
@@ -0,0 +1,323 @@
+#include "reportuploader.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QUrlQuery>
+
+#include "../file/configmanager.h"
+#include "../file/loger.h"
+#include "../file/reportcodec.h"
+#include "chunkeduploader.h"
+#include "dedupuploader.h"
+
+
+ReportUploader::ReportUploader(QObject* parent)
+    : QObject(parent)
+{
+}
+
+ReportUploader::~ReportUploader()
+{
+  cancel();
+}
+
+const QList<QPair<QString, QString>>& ReportUploader::artifactEndpoints()
+{
+  static const QList<QPair<QString, QString>> endpoints = {{"report.json", "/json/"},
+                                                           {"report.pdf", "/pdf/"},
+                                                           {"before_to/rail_record.zip", "/before/"},
+                                                           {"after_to/rail_record.zip", "/after/"}};
+  return endpoints;
+}
+
+QUrl ReportUploader::buildUploadUrl(const QUrl& apiBaseUrl, const QString& endpoint,
+                                    const QString& serialNumber, const QString& uploadTime,
+                                    const QString& numberTO, const QString& model)
+{
+  QUrlQuery query;
+  query.addQueryItem("serial_number", serialNumber);
+  query.addQueryItem("upload_time", uploadTime);
+  query.addQueryItem("number_to", numberTO);
+  query.addQueryItem("equipment_type", model);
+
+  QString path = apiBaseUrl.path();
+  if (!path.endsWith('/')) {
+    path += '/';
+  }
+
+  QUrl url = apiBaseUrl;
+  url.setPath(path + serialNumber + endpoint);
+  url.setQuery(query);
+
+  return url;
+}
+
+QJsonObject ReportUploader::buildReportMetadata(const QString& serialNumber, const QString& uploadTime,
+                                                const QString& numberTO, const QString& model)
+{
+  return QJsonObject{{"serial_number", serialNumber},
+                     {"upload_time", uploadTime},
+                     {"number_to", numberTO},
+                     {"equipment_type", model}};
+}
+
+void ReportUploader::setMaxConcurrentReports(int count)
+{
+  m_maxConcurrentReports = qMax(1, count);
+}
+
+void ReportUploader::start(const QUrl& apiBaseUrl, const QString& serialNumber, const QString& model,
+                           const QList<Job>& jobs)
+{
+  if (m_running) {
+    DEBUG_ERROR_COLORED("ReportUploader", "start", "Upload already in progress, restarting", COLOR_BLUE,
+                        COLOR_BLUE);
+    cancel();
+  }
+
+  m_apiBaseUrl = apiBaseUrl;
+  m_serialNumber = serialNumber;
+  m_model = model;
+
+  m_queue.clear();
+  for (const Job& job : jobs)
+    m_queue.enqueue(job);
+
+  m_totalReports = m_queue.size();
+  m_succeeded = 0;
+  m_failed = 0;
+  m_bytesSent = 0;
+  m_bytesResent = 0;
+  m_bytesDeduplicated = 0;
+  m_requestBytes.clear();
+  m_elapsed.start();
+  m_running = true;
+
+  DEBUG_COLORED("ReportUploader", "start",
+                QString("Uploading %1 reports, %2 in flight").arg(m_totalReports).arg(m_maxConcurrentReports),
+                COLOR_BLUE, COLOR_BLUE);
+
+  scheduleNext();
+}
+
+void ReportUploader::cancel()
+{
+  m_queue.clear();
+
+  const QList<QObject*> requests = m_requestBytes.keys();
+  for (QObject* request : requests) {
+    request->disconnect(this);
+    if (auto* client = qobject_cast<HttpClient*>(request))
+      client->abort();
+    else if (auto* chunked = qobject_cast<ChunkedUploader*>(request))
+      chunked->abort();
+    else if (auto* dedup = qobject_cast<DedupUploader*>(request))
+      dedup->abort();
+    request->deleteLater();
+  }
+  m_requestBytes.clear();
+
+  qDeleteAll(m_active);
+  m_active.clear();
+  m_running = false;
+}
+
+void ReportUploader::scheduleNext()
+{
+  while (m_active.size() < m_maxConcurrentReports && !m_queue.isEmpty()) {
+    startReport(m_queue.dequeue());
+  }
+
+  if (m_active.isEmpty() && m_queue.isEmpty() && m_running) {
+    m_running = false;
+    DEBUG_COLORED("ReportUploader", "scheduleNext",
+                  QString("Finished: %1 uploaded, %2 failed in %3 ms, %4 bytes re-sent, %5 bytes skipped")
+                      .arg(m_succeeded)
+                      .arg(m_failed)
+                      .arg(m_elapsed.elapsed())
+                      .arg(m_bytesResent)
+                      .arg(m_bytesDeduplicated),
+                  COLOR_BLUE, COLOR_BLUE);
+    emit finished(m_succeeded, m_failed);
+  }
+}
+
+void ReportUploader::startReport(const Job& job)
+{
+  auto* report = new ActiveReport;
+  report->job = job;
+  m_active.append(report);
+
+  DEBUG_COLORED("ReportUploader", "startReport", QString("Starting upload of report: %1").arg(job.reportPath),
+                COLOR_BLUE, COLOR_BLUE);
+
+  if (!job.sendMetadata) {
+    report->metadataAccepted = true;
+    uploadArtifacts(report);
+    return;
+  }
+
+  QDir reportDir(job.reportPath);
+  // report.cbor, when stored, holds the same document and skips the text parse
+  const QString reportFile = ReportCodec::preferredFile(reportDir);
+
+  QString error;
+  QJsonObject reportData = ReportCodec::readFile(reportFile, &error);
+  if (reportData.isEmpty()) {
+    report->failed = true;
+    report->error = error.isEmpty() ? QString("Empty report %1").arg(reportFile) : error;
+    finishReportLater(report);
+    return;
+  }
+
+  reportData["metadata"] = buildReportMetadata(m_serialNumber, job.uploadTime, job.numberTO, m_model);
+  reportData["report_id"] = reportDir.dirName();
+
+  // Artifacts are only sent once the server has accepted the report metadata
+  const bool cbor = ConfigManager::instance().cborUpload();
+  sendRequest(report, MetadataArtifact, [this, reportData, cbor](HttpClient* client) {
+    if (cbor)
+      client->postCbor(m_apiBaseUrl, reportData);
+    else
+      client->postJson(m_apiBaseUrl, reportData);
+  });
+}
+
+void ReportUploader::uploadArtifacts(ActiveReport* report)
+{
+  QDir reportDir(report->job.reportPath);
+  for (const auto& artifact : artifactEndpoints()) {
+    if (!report->job.artifacts.contains(artifact.first)) continue;
+
+    const QString localPath = reportDir.filePath(artifact.first);
+    QFileInfo info(localPath);
+    if (!info.exists() || info.size() == 0) continue;
+
+    const QUrl fileUrl = buildUploadUrl(m_apiBaseUrl, artifact.second, m_serialNumber, report->job.uploadTime,
+                                        report->job.numberTO, m_model);
+    if (DedupUploader::isEnabledFor(localPath))
+      sendDeduplicated(report, artifact.first, fileUrl, localPath);
+    else if (ChunkedUploader::isEnabledFor(localPath))
+      sendChunked(report, artifact.first, fileUrl, localPath);
+    else
+      sendRequest(report, artifact.first,
+                  [fileUrl, localPath](HttpClient* client) { client->postFile(fileUrl, localPath); });
+  }
+
+  if (report->pendingRequests == 0) finishReportLater(report);
+}
+
+void ReportUploader::sendRequest(ActiveReport* report, const QString& artifact,
+                                 const std::function<void(HttpClient*)>& request)
+{
+  auto* client = new HttpClient(this);
+  trackRequest(report, artifact, client);
+  request(client);
+}
+
+void ReportUploader::sendChunked(ActiveReport* report, const QString& artifact, const QUrl& fileUrl,
+                                 const QString& filePath)
+{
+  auto* uploader = new ChunkedUploader(this);
+  trackRequest(report, artifact, uploader);
+  uploader->start(fileUrl, filePath);
+}
+
+void ReportUploader::sendDeduplicated(ActiveReport* report, const QString& artifact, const QUrl& fileUrl,
+                                      const QString& filePath)
+{
+  auto* uploader = new DedupUploader(this);
+  trackRequest(report, artifact, uploader);
+  uploader->start(fileUrl, filePath);
+}
+
+template <typename Request>
+void ReportUploader::trackRequest(ActiveReport* report, const QString& artifact, Request* request)
+{
+  m_requestBytes.insert(request, 0);
+  ++report->pendingRequests;
+
+  connect(request, &Request::progress, this, [this, request](qint64 sent, qint64 total) {
+    Q_UNUSED(total)
+    auto it = m_requestBytes.find(request);
+    if (it == m_requestBytes.end() || sent <= it.value()) return;
+    m_bytesSent += sent - it.value();
+    it.value() = sent;
+    emitProgress();
+  });
+
+  connect(request, &Request::finished, this,
+          [this, report, request, artifact](const HttpClient::HttpResponse& response) {
+            onRequestFinished(report, request, artifact, response);
+          });
+}
+
+void ReportUploader::onRequestFinished(ActiveReport* report, QObject* request, const QString& artifact,
+                                       const HttpClient::HttpResponse& response)
+{
+  // HttpClient may report an error twice (errorOccurred and finished), only the first one counts
+  request->disconnect(this);
+  request->deleteLater();
+  m_requestBytes.remove(request);
+  if (auto* chunked = qobject_cast<ChunkedUploader*>(request)) m_bytesResent += chunked->bytesResent();
+  if (auto* dedup = qobject_cast<DedupUploader*>(request)) m_bytesDeduplicated += dedup->bytesSkipped();
+
+  if (!m_active.contains(report)) return;
+
+  --report->pendingRequests;
+  if (!response.success) {
+    DEBUG_ERROR_COLORED(
+        "ReportUploader", "onRequestFinished",
+        QString("Request for %1 failed: %2").arg(report->job.reportPath, response.errorMessage), COLOR_BLUE,
+        COLOR_BLUE);
+    report->failed = true;
+    if (report->error.isEmpty()) report->error = response.errorMessage;
+  } else {
+    emit artifactAccepted(report->job, artifact);
+  }
+
+  if (report->pendingRequests > 0) return;
+
+  if (!report->metadataAccepted && !report->failed) {
+    report->metadataAccepted = true;
+    uploadArtifacts(report);
+    return;
+  }
+
+  finishReport(report);
+}
+
+void ReportUploader::finishReport(ActiveReport* report)
+{
+  m_active.removeOne(report);
+
+  if (report->failed)
+    ++m_failed;
+  else
+    ++m_succeeded;
+
+  emit reportFinished(report->job, !report->failed, report->error);
+  delete report;
+
+  emitProgress();
+  scheduleNext();
+}
+
+void ReportUploader::finishReportLater(ActiveReport* report)
+{
+  // Finishing schedules the next report; from the event loop, so a queue of reports that fail
+  // right away does not nest startReport() calls
+  QMetaObject::invokeMethod(
+      this,
+      [this, report]() {
+        if (m_active.contains(report)) finishReport(report);
+      },
+      Qt::QueuedConnection);
+}
+
+void ReportUploader::emitProgress()
+{
+  const qint64 elapsedMs = qMax<qint64>(1, m_elapsed.elapsed());
+  const double bytesPerSecond = m_bytesSent * 1000.0 / elapsedMs;
+  emit progressChanged(m_succeeded + m_failed, m_totalReports, m_bytesSent, bytesPerSecond);
+}
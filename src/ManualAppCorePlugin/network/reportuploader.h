@@ -0,0 +1,107 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QQueue>
+#include <QStringList>
+#include <QUrl>
+
+#include "httpclient.h"
+
+// Asynchronous uploader for the report backlog.
+// Keeps up to maxConcurrentReports() reports in flight; once the metadata POST of a report
+// succeeds (or is not needed), the requested artifacts are sent concurrently over the shared connection pool.
+class ReportUploader : public QObject
+{
+  Q_OBJECT
+public:
+  struct Job {
+    QString reportPath;
+    QString uploadTime;
+    QString numberTO;
+    // Artifacts to send, relative to reportPath (see artifactEndpoints())
+    QStringList artifacts;
+    bool sendMetadata = true;
+  };
+
+  // Pseudo artifact name used in artifactAccepted() for the metadata POST
+  static inline const QString MetadataArtifact = QStringLiteral("metadata");
+  // Artifact path relative to the report directory and its upload endpoint
+  static const QList<QPair<QString, QString>>& artifactEndpoints();
+
+  // Request helpers, shared with NetworkService::uploadReportSynchronous
+  static QUrl buildUploadUrl(const QUrl& apiBaseUrl, const QString& endpoint, const QString& serialNumber,
+                             const QString& uploadTime, const QString& numberTO, const QString& model);
+  static QJsonObject buildReportMetadata(const QString& serialNumber, const QString& uploadTime,
+                                         const QString& numberTO, const QString& model);
+
+  explicit ReportUploader(QObject* parent = nullptr);
+  ~ReportUploader();
+
+  void start(const QUrl& apiBaseUrl, const QString& serialNumber, const QString& model,
+             const QList<Job>& jobs);
+  void cancel();
+
+  bool isRunning() const { return m_running; }
+  qint64 bytesResent() const { return m_bytesResent; }
+  // Archive bytes not sent because the server already held those chunks
+  qint64 bytesDeduplicated() const { return m_bytesDeduplicated; }
+  int maxConcurrentReports() const { return m_maxConcurrentReports; }
+  void setMaxConcurrentReports(int count);
+
+signals:
+  void artifactAccepted(const ReportUploader::Job& job, const QString& artifact);
+  void reportFinished(const ReportUploader::Job& job, bool success, const QString& error);
+  void progressChanged(int finishedReports, int totalReports, qint64 bytesSent, double bytesPerSecond);
+  void finished(int succeeded, int failed);
+
+private:
+  struct ActiveReport {
+    Job job;
+    int pendingRequests = 0;
+    bool metadataAccepted = false;
+    bool failed = false;
+    QString error;
+  };
+
+  void scheduleNext();
+  void startReport(const Job& job);
+  void uploadArtifacts(ActiveReport* report);
+  void sendRequest(ActiveReport* report, const QString& artifact,
+                   const std::function<void(HttpClient*)>& request);
+  void sendChunked(ActiveReport* report, const QString& artifact, const QUrl& fileUrl,
+                   const QString& filePath);
+  void sendDeduplicated(ActiveReport* report, const QString& artifact, const QUrl& fileUrl,
+                        const QString& filePath);
+  template <typename Request>
+  void trackRequest(ActiveReport* report, const QString& artifact, Request* request);
+  void onRequestFinished(ActiveReport* report, QObject* request, const QString& artifact,
+                         const HttpClient::HttpResponse& response);
+  void finishReport(ActiveReport* report);
+  void finishReportLater(ActiveReport* report);
+  void emitProgress();
+
+private:
+  bool m_running = false;
+  int m_maxConcurrentReports = 2;
+
+  QUrl m_apiBaseUrl;
+  QString m_serialNumber;
+  QString m_model;
+
+  QQueue<Job> m_queue;
+  QList<ActiveReport*> m_active;
+  // HttpClient, ChunkedUploader or DedupUploader in flight -> bytes it has sent
+  QHash<QObject*, qint64> m_requestBytes;
+
+  int m_totalReports = 0;
+  int m_succeeded = 0;
+  int m_failed = 0;
+  qint64 m_bytesSent = 0;
+  qint64 m_bytesResent = 0;
+  qint64 m_bytesDeduplicated = 0;
+  QElapsedTimer m_elapsed;
+};
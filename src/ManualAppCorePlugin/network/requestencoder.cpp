@@ -0,0 +1,169 @@
+#include "requestencoder.h"
+
+#include <quagzipfile.h>
+#include <zlib.h>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+
+#include "../file/configmanager.h"
+#include "../file/logger.h"
+
+
+namespace
+{
+
+constexpr qint64 ReadBlockSize = 64 * 1024;
+
+// Files that deflate cannot shrink any further
+bool isCompressedSuffix(const QString& suffix)
+{
+  static const QStringList suffixes = {"zip", "gz", "7z", "png", "jpg", "jpeg", "mp4"};
+  return suffixes.contains(suffix.toLower());
+}
+
+// Hosts that listed gzip in Accept-Encoding, and hosts that answered a gzipped body with 415
+struct GzipSupport {
+  QMutex mutex;
+  QSet<QString> confirmed;
+  QSet<QString> rejected;
+};
+
+GzipSupport& gzipSupport()
+{
+  static GzipSupport support;
+  return support;
+}
+
+} // namespace
+
+bool RequestEncoder::isEnabled()
+{
+  return ConfigManager::instance().gzipRequests();
+}
+
+qint64 RequestEncoder::minSize()
+{
+  return ConfigManager::instance().gzipMinSize();
+}
+
+bool RequestEncoder::acceptsGzip(const QUrl& url)
+{
+  if (!isEnabled()) return false;
+
+  GzipSupport& support = gzipSupport();
+  QMutexLocker locker(&support.mutex);
+  return support.confirmed.contains(url.authority()) && !support.rejected.contains(url.authority());
+}
+
+void RequestEncoder::noteResponse(const QNetworkReply* reply)
+{
+  const QString host = reply->request().url().authority();
+  GzipSupport& support = gzipSupport();
+  QMutexLocker locker(&support.mutex);
+
+  if (rejectedGzip(reply))
+    support.rejected.insert(host);
+  else if (reply->rawHeader("Accept-Encoding").toLower().contains("gzip"))
+    support.confirmed.insert(host);
+}
+
+bool RequestEncoder::rejectedGzip(const QNetworkReply* reply)
+{
+  return reply->request().rawHeader("Content-Encoding") == "gzip" &&
+         reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 415;
+}
+
+RequestEncoder::Body RequestEncoder::encode(QNetworkRequest& request, const QByteArray& data)
+{
+  Body body;
+  body.rawSize = data.size();
+  if (data.size() >= minSize() && acceptsGzip(request.url())) {
+    const QByteArray compressed = gzip(data);
+    // Kept raw when gzip does not pay for its header
+    if (!compressed.isEmpty() && compressed.size() < data.size()) {
+      body.data = compressed;
+      body.gzipped = true;
+      request.setRawHeader("Content-Encoding", "gzip");
+    }
+  }
+  if (!body.gzipped) body.data = data;
+
+  request.setHeader(QNetworkRequest::ContentLengthHeader, QVariant(body.data.size()));
+  if (body.gzipped) report(request.url(), body.rawSize, body.data.size());
+  return body;
+}
+
+QTemporaryFile* RequestEncoder::encodeMultipart(const QUrl& url, const QString& filePath,
+                                                const QByteArray& boundary, QObject* parent)
+{
+  const QFileInfo info(filePath);
+  if (info.size() < minSize() || !isCompressible(filePath) || !acceptsGzip(url)) return nullptr;
+
+  QFile source(filePath);
+  auto* target = new QTemporaryFile(parent);
+  // Created, then closed, so QuaGzipFile can write it by name
+  if (!source.open(QIODevice::ReadOnly) || !target->open()) {
+    delete target;
+    return nullptr;
+  }
+  target->close();
+
+  // The same framing QHttpMultiPart writes for one part
+  const QByteArray head = "--" + boundary + "\r\nContent-Disposition: form-data; name=\"file\"; filename=\"" +
+                          info.fileName().toUtf8() + "\"\r\n\r\n";
+  const QByteArray tail = "\r\n--" + boundary + "--\r\n";
+
+  QuaGzipFile gzipFile(target->fileName());
+  bool ok = gzipFile.open(QIODevice::WriteOnly) && gzipFile.write(head) == head.size();
+  QByteArray block(ReadBlockSize, Qt::Uninitialized);
+  while (ok && !source.atEnd()) {
+    const qint64 read = source.read(block.data(), block.size());
+    ok = read >= 0 && gzipFile.write(block.constData(), read) == read;
+  }
+  ok = ok && gzipFile.write(tail) == tail.size();
+  gzipFile.close();
+
+  if (!ok || !target->open() || target->size() >= info.size()) {
+    delete target;
+    return nullptr;
+  }
+
+  report(QUrl::fromLocalFile(filePath), info.size(), target->size());
+  return target;
+}
+
+bool RequestEncoder::isCompressible(const QString& filePath)
+{
+  return !isCompressedSuffix(QFileInfo(filePath).suffix());
+}
+
+QByteArray RequestEncoder::gzip(const QByteArray& data)
+{
+  z_stream stream{};
+  // 16 added to the window bits selects the gzip wrapper
+  if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    return QByteArray();
+
+  QByteArray result;
+  result.resize(static_cast<qsizetype>(deflateBound(&stream, static_cast<uLong>(data.size()))));
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+  stream.avail_in = static_cast<uInt>(data.size());
+  stream.next_out = reinterpret_cast<Bytef*>(result.data());
+  stream.avail_out = static_cast<uInt>(result.size());
+
+  const int status = deflate(&stream, Z_FINISH);
+  result.resize(status == Z_STREAM_END ? static_cast<qsizetype>(stream.total_out) : 0);
+  deflateEnd(&stream);
+  return result;
+}
+
+void RequestEncoder::report(const QUrl& url, qint64 rawSize, qint64 sentSize)
+{
+  LOG_DEBUG("RequestEncoder", "report", "Request body gzipped", {"url", url.toDisplayString()},
+            {"raw", rawSize}, {"sent", sentSize},
+            {"ratio", rawSize > 0 ? QString::number(double(sentSize) / rawSize, 'f', 3) : QString()});
+}
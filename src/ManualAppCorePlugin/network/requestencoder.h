@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QByteArray>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QString>
+#include <QTemporaryFile>
+#include <QUrl>
+
+// Encodes request bodies for HttpClient. Bodies of at least minSize() bytes are gzipped and sent with
+// Content-Encoding: gzip when gzip_requests is set in .config.ini, but only to hosts that confirmed they
+// inflate request bodies: a response listing gzip in Accept-Encoding (RFC 7694) turns compression on for
+// its host, a 415 to a gzipped body turns it off for the rest of the session. Smaller bodies and already
+// compressed files go out as they are. Responses need nothing here: QNetworkAccessManager asks for gzip
+// and inflates replies itself as long as no request sets Accept-Encoding.
+class RequestEncoder
+{
+public:
+  struct Body {
+    QByteArray data;
+    qint64 rawSize = 0;
+    bool gzipped = false;
+  };
+
+  static bool isEnabled();
+  static qint64 minSize();
+  // Enabled, and the host of url confirmed gzip support
+  static bool acceptsGzip(const QUrl& url);
+  // Records what a response says about gzip support of its host
+  static void noteResponse(const QNetworkReply* reply);
+  // The request was gzipped and the server answered 415; it has to be sent again uncompressed
+  static bool rejectedGzip(const QNetworkReply* reply);
+
+  // Gzips data when the host accepts it and it is worth it, and sets Content-Encoding and Content-Length
+  static Body encode(QNetworkRequest& request, const QByteArray& data);
+  // Stream-compresses a whole multipart/form-data body carrying filePath as its "file" field into a
+  // temporary file owned by parent; nullptr when the file is sent raw. The body is compressed as a
+  // whole because multipart parsers ignore Content-Encoding on a single part.
+  static QTemporaryFile* encodeMultipart(const QUrl& url, const QString& filePath, const QByteArray& boundary,
+                                         QObject* parent);
+  static bool isCompressible(const QString& filePath);
+
+  static QByteArray gzip(const QByteArray& data);
+  // Logs the compression ratio of one request
+  static void report(const QUrl& url, qint64 rawSize, qint64 sentSize);
+};
@@ -1,5 +1,8 @@
 #include "synchttpclient.h"
 
+#include "chunkeduploader.h"
+#include "dedupuploader.h"
+
 SyncHttpClient::SyncHttpClient(int timeoutMs)
     : m_timeoutMs(timeoutMs)
 {
@@ -15,11 +18,50 @@ HttpClient::HttpResponse SyncHttpClient::postJson(const QUrl& url, const QJsonOb
   return waitForResult([&](HttpClient& client) { client.postJson(url, json); });
 }
 
+HttpClient::HttpResponse SyncHttpClient::postCbor(const QUrl& url, const QJsonObject& json)
+{
+  return waitForResult([&](HttpClient& client) { client.postCbor(url, json); });
+}
+
 HttpClient::HttpResponse SyncHttpClient::postFile(const QUrl& url, const QString& filePath)
 {
   return waitForResult([&](HttpClient& client) { client.postFile(url, filePath); });
 }
 
+HttpClient::HttpResponse SyncHttpClient::postFileChunked(const QUrl& url, const QString& filePath)
+{
+  QEventLoop loop;
+  ChunkedUploader uploader;
+  HttpClient::HttpResponse result;
+
+  QObject::connect(&uploader, &ChunkedUploader::finished, [&](const HttpClient::HttpResponse& response) {
+    result = response;
+    loop.quit();
+  });
+
+  uploader.start(url, filePath);
+  loop.exec();
+
+  return result;
+}
+
+HttpClient::HttpResponse SyncHttpClient::postFileDeduplicated(const QUrl& url, const QString& filePath)
+{
+  QEventLoop loop;
+  DedupUploader uploader;
+  HttpClient::HttpResponse result;
+
+  QObject::connect(&uploader, &DedupUploader::finished, [&](const HttpClient::HttpResponse& response) {
+    result = response;
+    loop.quit();
+  });
+
+  uploader.start(url, filePath);
+  loop.exec();
+
+  return result;
+}
+
 HttpClient::HttpResponse SyncHttpClient::waitForResult(std::function<void(HttpClient&)> requestFunc)
 {
   QEventLoop loop;
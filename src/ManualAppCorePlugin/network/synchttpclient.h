@@ -12,7 +12,12 @@ public:
 
   HttpClient::HttpResponse get(const QUrl& url);
   HttpClient::HttpResponse postJson(const QUrl& url, const QJsonObject& json);
+  HttpClient::HttpResponse postCbor(const QUrl& url, const QJsonObject& json);
   HttpClient::HttpResponse postFile(const QUrl& url, const QString& filePath);
+  // Resumable upload through ChunkedUploader; no overall timeout, every chunk has its own
+  HttpClient::HttpResponse postFileChunked(const QUrl& url, const QString& filePath);
+  // Sends only the chunks the server lacks through DedupUploader; no overall timeout either
+  HttpClient::HttpResponse postFileDeduplicated(const QUrl& url, const QString& filePath);
 
 private:
   HttpClient::HttpResponse waitForResult(std::function<void(HttpClient&)> requestFunc);
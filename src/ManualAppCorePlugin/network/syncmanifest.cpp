@@ -0,0 +1,166 @@
+#include "syncmanifest.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#include "../file/loger.h"
+
+
+SyncManifest::SyncManifest(const QString& filePath)
+    : m_filePath(filePath)
+{
+}
+
+void SyncManifest::load()
+{
+  m_reports.clear();
+  m_lastServerSync.clear();
+  m_dirty = false;
+
+  QFile file(m_filePath);
+  if (!file.open(QIODevice::ReadOnly)) return;
+
+  const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+  file.close();
+
+  if (root.value("version").toInt() != Version) {
+    DEBUG_COLORED("SyncManifest", "load", "Manifest version mismatch, starting from scratch", COLOR_BLUE,
+                  COLOR_BLUE);
+    return;
+  }
+
+  m_lastServerSync = root.value("since").toString();
+
+  const QJsonObject reports = root.value("reports").toObject();
+  for (auto reportIt = reports.constBegin(); reportIt != reports.constEnd(); ++reportIt) {
+    QHash<QString, FileState>& artifacts = m_reports[reportIt.key()];
+
+    const QJsonObject artifactsObj = reportIt.value().toObject();
+    for (auto it = artifactsObj.constBegin(); it != artifactsObj.constEnd(); ++it) {
+      const QJsonObject obj = it.value().toObject();
+
+      FileState state;
+      state.size = static_cast<qint64>(obj.value("size").toDouble(-1));
+      state.mtime = static_cast<qint64>(obj.value("mtime").toDouble(-1));
+      state.hash = QByteArray::fromHex(obj.value("sha256").toString().toLatin1());
+      artifacts.insert(it.key(), state);
+    }
+  }
+
+  DEBUG_COLORED("SyncManifest", "load", QString("Loaded %1 acknowledged reports").arg(m_reports.size()),
+                COLOR_BLUE, COLOR_BLUE);
+}
+
+bool SyncManifest::save()
+{
+  QJsonObject reports;
+  for (auto reportIt = m_reports.constBegin(); reportIt != m_reports.constEnd(); ++reportIt) {
+    QJsonObject artifacts;
+    for (auto it = reportIt->constBegin(); it != reportIt->constEnd(); ++it) {
+      artifacts[it.key()] = QJsonObject{{"size", static_cast<double>(it->size)},
+                                        {"mtime", static_cast<double>(it->mtime)},
+                                        {"sha256", QString::fromLatin1(it->hash.toHex())}};
+    }
+    reports[reportIt.key()] = artifacts;
+  }
+
+  QJsonObject root{{"version", Version}, {"since", m_lastServerSync}, {"reports", reports}};
+
+  QSaveFile file(m_filePath);
+  if (!file.open(QIODevice::WriteOnly)) {
+    DEBUG_ERROR_COLORED("SyncManifest", "save", QString("Cannot open manifest file: %1").arg(m_filePath),
+                        COLOR_BLUE, COLOR_BLUE);
+    return false;
+  }
+  file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+  if (!file.commit()) return false;
+
+  m_dirty = false;
+  return true;
+}
+
+void SyncManifest::clear()
+{
+  m_reports.clear();
+  m_lastServerSync.clear();
+  m_dirty = true;
+}
+
+bool SyncManifest::needsUpload(const FileState& acknowledged, const QString& filePath, FileState* state)
+{
+  *state = stat(filePath);
+
+  if (acknowledged.size < 0) {
+    state->hash = hashFile(filePath);
+    return true;
+  }
+
+  // Unchanged size and mtime: trust the acknowledged hash without reading the file
+  if (state->size == acknowledged.size && state->mtime == acknowledged.mtime) {
+    state->hash = acknowledged.hash;
+    return false;
+  }
+
+  state->hash = hashFile(filePath);
+  return acknowledged.hash.isEmpty() || state->hash != acknowledged.hash;
+}
+
+void SyncManifest::acknowledge(const QString& reportKey, const QString& artifact, const FileState& state)
+{
+  m_reports[reportKey].insert(artifact, state);
+  m_dirty = true;
+}
+
+void SyncManifest::forget(const QString& reportKey)
+{
+  if (m_reports.remove(reportKey) > 0) m_dirty = true;
+}
+
+void SyncManifest::forgetArtifacts(const QString& reportKey, const QStringList& artifacts)
+{
+  auto it = m_reports.find(reportKey);
+  if (it == m_reports.end()) return;
+
+  for (const QString& artifact : artifacts) {
+    if (it->remove(artifact) > 0) m_dirty = true;
+  }
+  if (it->isEmpty()) m_reports.erase(it);
+}
+
+void SyncManifest::setLastServerSync(const QString& timestamp)
+{
+  if (m_lastServerSync == timestamp) return;
+  m_lastServerSync = timestamp;
+  m_dirty = true;
+}
+
+QString SyncManifest::reportKey(const QString& numberTO, const QString& date)
+{
+  return numberTO + "/" + date;
+}
+
+SyncManifest::FileState SyncManifest::stat(const QString& filePath)
+{
+  FileState state;
+  QFileInfo info(filePath);
+  if (!info.exists()) return state;
+
+  state.size = info.size();
+  state.mtime = info.lastModified().toMSecsSinceEpoch();
+  return state;
+}
+
+QByteArray SyncManifest::hashFile(const QString& filePath)
+{
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly)) return QByteArray();
+
+  QCryptographicHash hash(QCryptographicHash::Sha256);
+  hash.addData(&file);
+  return hash.result();
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+// Local record of what the server has already acknowledged.
+// For every report it keeps the state (size, mtime, sha256) of each artifact at the time the server
+// accepted it. An artifact is rehashed only when its size or mtime changed, and resent only when the
+// hash differs, so a sync over a large unchanged backlog costs no uploads at all.
+// The manifest itself lives on the GUI thread; the static comparison helpers touch only the file and can
+// run on a pool thread with a copy of the acknowledged state.
+class SyncManifest
+{
+public:
+  struct FileState {
+    qint64 size = -1;
+    qint64 mtime = -1;
+    QByteArray hash;
+  };
+
+  explicit SyncManifest(const QString& filePath);
+
+  void load();
+  bool save();
+  void clear();
+  bool isDirty() const { return m_dirty; }
+
+  // State of an artifact when the server accepted it, size -1 when it never did
+  FileState acknowledged(const QString& reportKey, const QString& artifact) const
+  {
+    return m_reports.value(reportKey).value(artifact);
+  }
+  bool isKnown(const QString& reportKey) const { return m_reports.contains(reportKey); }
+  QStringList reportKeys() const { return m_reports.keys(); }
+
+  void acknowledge(const QString& reportKey, const QString& artifact, const FileState& state);
+  void forget(const QString& reportKey);
+  void forgetArtifacts(const QString& reportKey, const QStringList& artifacts);
+
+  // Server timestamp of the last processed report listing, passed back as ?since=
+  QString lastServerSync() const { return m_lastServerSync; }
+  void setLastServerSync(const QString& timestamp);
+
+  static QString reportKey(const QString& numberTO, const QString& date);
+  // Compares a local file with an acknowledged state; fills |state| with the current one
+  static bool needsUpload(const FileState& acknowledged, const QString& filePath, FileState* state);
+  static FileState stat(const QString& filePath);
+  static QByteArray hashFile(const QString& filePath);
+
+private:
+  static constexpr int Version = 1;
+
+private:
+  QString m_filePath;
+  QString m_lastServerSync;
+  QHash<QString, QHash<QString, FileState>> m_reports;
+  bool m_dirty = false;
+};
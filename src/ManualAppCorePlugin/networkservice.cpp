@@ -8,11 +8,16 @@
 #include <QNetworkProxy>
 #include <QNetworkRequest>
 #include <QTimer>
-#include <QUrlQuery>
 
+#include "file/configmanager.h"
 #include "file/fileservice.h"
 #include "file/loger.h"
+#include "file/reportcodec.h"
+#include "network/chunkeduploader.h"
+#include "network/dedupuploader.h"
 #include "network/httpclient.h"
+#include "network/progressaggregator.h"
+#include "network/reportuploader.h"
 #include "network/synchttpclient.h"
 #include "reportmanager.h"
 #include "settings/settingsmanager.h"
@@ -22,7 +27,13 @@ NetworkService::NetworkService(FileService* fileService, ReportManager* reportMa
     : QObject(parent)
     , m_fileService(fileService)
     , m_reportManager(reportManager)
+    , m_reportUploader(new ReportUploader(this))
+    , m_progress(new ProgressAggregator(this))
 {
+  m_reportUploader->setMaxConcurrentReports(ConfigManager::instance().uploadConcurrency());
+  m_progress->setMinInterval(1000 / ConfigManager::instance().progressUpdateRate());
+  m_progress->setMinStep(ConfigManager::instance().progressUpdateStep());
+  connect(m_progress, &ProgressAggregator::progressChanged, this, &NetworkService::progressChanged);
   DEBUG_COLORED("NetworkService", "Constructor", "Initialized", COLOR_BLUE, COLOR_BLUE);
 }
 
@@ -44,7 +55,7 @@ void NetworkService::getJsonFromDjango(const QUrl& url, std::function<void(const
 
   auto client = new HttpClient();
 
-  connect(client, &HttpClient::progress, this, &NetworkService::onProgress);
+  trackProgress(client);
 
   connect(client, &HttpClient::finished, this,
           [client, onSuccess, onError](const HttpClient::HttpResponse& response) {
@@ -62,28 +73,6 @@ void NetworkService::getJsonFromDjango(const QUrl& url, std::function<void(const
 }
 
 
-QUrl NetworkService::buildUploadUrl(const QUrl& apiBaseUrl, const QString& endpoint,
-                                    const QString& serialNumber, const QString& uploadTime,
-                                    const QString& numberTO, const QString& model)
-{
-  QUrlQuery query;
-  query.addQueryItem("serial_number", serialNumber);
-  query.addQueryItem("upload_time", uploadTime);
-  query.addQueryItem("number_to", numberTO);
-  query.addQueryItem("equipment_type", model);
-
-  QString path = apiBaseUrl.path();
-  if (!path.endsWith('/')) {
-    path += '/';
-  }
-
-  QUrl url = apiBaseUrl;
-  url.setPath(path + serialNumber + endpoint);
-  url.setQuery(query);
-
-  return url;
-}
-
 bool NetworkService::uploadFileSynchronous(const QUrl& apiUrl, const QString& filePath)
 {
   DEBUG_COLORED("NetworkService", "uploadFileSynchronous",
@@ -126,7 +115,7 @@ void NetworkService::downloadFile(const QUrl& url, const QString& filePath)
 
   auto* client = new HttpClient();
 
-  connect(client, &HttpClient::progress, this, &NetworkService::onProgress);
+  trackProgress(client);
 
   connect(client, &HttpClient::finished, this, [this, client](const HttpClient::HttpResponse& response) {
     emit uploadFinished(response.success, response.errorMessage);
@@ -177,9 +166,9 @@ bool NetworkService::uploadReportSynchronous(const QUrl& apiBaseUrl, const QStri
   const QString reportId = reportDir.dirName();
   if (reportId.isEmpty()) return false;
 
-  SettingsManager settings;
-  const QString serialNumber = settings.serialNumber();
-  const QString model = settings.currentModel();
+  const SettingsManager* settings = SettingsManager::instance();
+  const QString serialNumber = settings->serialNumber();
+  const QString model = settings->currentModel();
 
   if (uploadTime.isEmpty() && m_reportManager) uploadTime = m_reportManager->startTime();
 
@@ -192,26 +181,16 @@ bool NetworkService::uploadReportSynchronous(const QUrl& apiBaseUrl, const QStri
   const QString jsonPath = reportDir.filePath("report.json");
   if (!QFile::exists(jsonPath)) return false;
 
-  QFile jsonFile(jsonPath);
-  if (!jsonFile.open(QIODevice::ReadOnly)) return false;
-
-  QJsonDocument jsonDoc = QJsonDocument::fromJson(jsonFile.readAll());
-  jsonFile.close();
-
-  if (jsonDoc.isNull()) return false;
-
-  QJsonObject reportData = jsonDoc.object();
-
-  QJsonObject metadata{{"serial_number", serialNumber},
-                       {"upload_time", uploadTime},
-                       {"number_to", numberTO},
-                       {"equipment_type", model}};
+  // report.cbor, when stored, holds the same document and skips the text parse
+  QJsonObject reportData = ReportCodec::readFile(ReportCodec::preferredFile(reportDir));
+  if (reportData.isEmpty()) return false;
 
-  reportData["metadata"] = metadata;
+  reportData["metadata"] = ReportUploader::buildReportMetadata(serialNumber, uploadTime, numberTO, model);
   reportData["report_id"] = reportId;
 
   QUrl jsonUrl = apiBaseUrl;
-  auto jsonResponse = client.postJson(jsonUrl, reportData);
+  auto jsonResponse = ConfigManager::instance().cborUpload() ? client.postCbor(jsonUrl, reportData)
+                                                             : client.postJson(jsonUrl, reportData);
   if (!jsonResponse.success) return false;
 
 
@@ -221,9 +200,16 @@ bool NetworkService::uploadReportSynchronous(const QUrl& apiBaseUrl, const QStri
     QFileInfo info(localPath);
     if (info.size() == 0) return true;
 
-    QUrl fileUrl = buildUploadUrl(apiBaseUrl, endpoint, serialNumber, uploadTime, numberTO, model);
+    QUrl fileUrl =
+        ReportUploader::buildUploadUrl(apiBaseUrl, endpoint, serialNumber, uploadTime, numberTO, model);
 
-    auto response = client.postFile(fileUrl, localPath);
+    HttpClient::HttpResponse response;
+    if (DedupUploader::isEnabledFor(localPath))
+      response = client.postFileDeduplicated(fileUrl, localPath);
+    else if (ChunkedUploader::isEnabledFor(localPath))
+      response = client.postFileChunked(fileUrl, localPath);
+    else
+      response = client.postFile(fileUrl, localPath);
 
     if (!response.success) {
       DEBUG_ERROR_COLORED("NetworkService", "uploadReportSynchronous",
@@ -258,7 +244,7 @@ void NetworkService::uploadFile(const QUrl& apiUrl, const QString& filePath)
 
   auto* client = new HttpClient();
 
-  connect(client, &HttpClient::progress, this, &NetworkService::onProgress);
+  trackProgress(client);
 
   connect(client, &HttpClient::finished, this, [this, client](const HttpClient::HttpResponse& response) {
     m_isUploadingReport = false;
@@ -278,7 +264,9 @@ void NetworkService::uploadReport(const QUrl& apiBaseUrl, const QString& reportP
 }
 
 
-void NetworkService::onProgress(qint64 sent, qint64 total)
+void NetworkService::trackProgress(HttpClient* client)
 {
-  emit progressChanged(sent, total);
+  connect(client, &HttpClient::progress, m_progress,
+          [this, client](qint64 sent, qint64 total) { m_progress->update(client, sent, total); });
+  connect(client, &HttpClient::finished, m_progress, [this, client]() { m_progress->finish(client); });
 }
\ No newline at end of file
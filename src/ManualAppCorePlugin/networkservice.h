@@ -12,7 +12,10 @@
 #include <QUrlQuery>
 
 class FileService;
+class HttpClient;
+class ProgressAggregator;
 class ReportManager;
+class ReportUploader;
 
 class NetworkService : public QObject
 {
@@ -44,6 +47,9 @@ public:
   // Control methods
   void cancelUpload();
   void setReportManager(ReportManager* reportManager);
+  ReportUploader* reportUploader() const { return m_reportUploader; }
+  // Combined, throttled progress of the transfers behind progressChanged(), with throughput and ETA
+  ProgressAggregator* progress() const { return m_progress; }
 
   // Post methods
   void postJson(const QNetworkRequest& request, const QByteArray& json,
@@ -56,13 +62,9 @@ signals:
   void downloadFinished(bool success, const QString& filePath, const QString& error);
   void progressChanged(qint64 bytesSent, qint64 bytesTotal);
   void errorOccurred(const QString& error);
-private slots:
-  void onProgress(qint64 sent, qint64 total);
 
 private:
-  // Private helper methods
-  QUrl buildUploadUrl(const QUrl& apiBaseUrl, const QString& endpoint, const QString& serialNumber,
-                      const QString& uploadTime, const QString& numberTO, const QString& model);
+  void trackProgress(HttpClient* client);
 
 private:
   // Upload state
@@ -71,4 +73,6 @@ private:
   // Service dependencies
   FileService* m_fileService;
   ReportManager* m_reportManager;
+  ReportUploader* m_reportUploader;
+  ProgressAggregator* m_progress;
 };
\ No newline at end of file
@@ -1,6 +1,5 @@
 #include "reportmanager.h"
 
-#include <JlCompress.h>
 #include <qcoreapplication.h>
 #include <qfileinfo.h>
 #include <qvariant.h>
@@ -14,20 +13,74 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QRegularExpression>
+#include <memory>
 
+#include "file/configmanager.h"
 #include "file/fileservice.h"
 #include "file/loger.h"
+#include "file/parallelarchiver.h"
+#include "file/pdfbatchexporter.h"
 #include "file/pdfexporter.h"
+#include "file/reporthtmlbuilder.h"
+#include "file/reportcodec.h"
+#include "file/reportindex.h"
+#include "file/reportioexecutor.h"
+#include "file/stepjournal.h"
 #include "networkservice.h"
 
 
+namespace
+{
+
+// Journal records after which the steps are snapshotted and the journal is truncated
+constexpr int JournalCompactRecords = 256;
+
+// Snapshots of an unfinished report never use the report.json/report.cbor names, which index, upload
+// and PDF regeneration take for a finished report
+const QStringList& snapshotFileNames()
+{
+  static const QStringList names = {"report.snapshot.json", "report.snapshot.cbor"};
+  return names;
+}
+
+QString snapshotFileName()
+{
+  return snapshotFileNames().at(ConfigManager::instance().reportCbor() ? 1 : 0);
+}
+
+// The newer of the two snapshot files, empty when there is none
+QString latestSnapshot(const QDir& reportDir)
+{
+  QString latest;
+  QDateTime latestTime;
+  for (const QString& name : snapshotFileNames()) {
+    const QFileInfo info(reportDir.filePath(name));
+    if (!info.exists() || (latestTime.isValid() && info.lastModified() < latestTime)) continue;
+    latest = info.filePath();
+    latestTime = info.lastModified();
+  }
+  return latest;
+}
+
+} // namespace
+
 ReportManager::ReportManager(FileService* fileService, NetworkService* networkService, QObject* parent)
     : QObject(parent)
     , m_fileService(fileService)
     , m_networkService(networkService)
 {
   DEBUG_COLORED("ReportManager", "Constructor", "Constructor called", COLOR_GREEN, COLOR_GREEN);
-  m_model.setSteps({});
+  m_settingsManager = SettingsManager::instance();
+
+  m_reportIndex =
+      std::make_unique<ReportIndex>(getReportDirPath(), m_fileService->getFullFilePath("report_index.json"));
+  m_reportIndex->load();
+  m_ioExecutor = std::make_unique<ReportIoExecutor>();
+
+  connect(&m_model, &StepModel::dataChanged, this,
+          [this](const QModelIndex& topLeft, const QModelIndex& bottomRight) {
+            journalSteps(topLeft.row(), bottomRight.row());
+          });
 
   connect(m_networkService.get(), &NetworkService::uploadFinished, this,
           [this](bool success, const QString& error) {
@@ -37,6 +90,8 @@ ReportManager::ReportManager(FileService* fileService, NetworkService* networkSe
           });
 }
 
+ReportManager::~ReportManager() = default;
+
 QString ReportManager::getReportDirPath() const
 {
   return m_fileService->ensureAppDataDirectory() + "/reports/";
@@ -44,144 +99,212 @@ QString ReportManager::getReportDirPath() const
 
 QVariantMap ReportManager::performedTOs() const
 {
-  QVariantMap result;
+  return m_reportIndex->performedTOs();
+}
 
-  const QString basePath = getReportDirPath();
-  QDir baseDir(basePath);
-  if (!baseDir.exists()) return result;
+QVariantMap ReportManager::performedTOsNew() const
+{
+  return m_reportIndex->performedTOsNew();
+}
 
-  // Старая логика (поддержка старого формата)
-  QFileInfoList toDirs = baseDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
-  QRegularExpression toRe("^TO-.*", QRegularExpression::CaseInsensitiveOption);
+QString ReportManager::findReportPdf(const QString& categoryKey, const QString& dateIso) const
+{
+  return m_reportIndex->stablePdfPath(categoryKey, dateIso);
+}
 
-  for (const QFileInfo& toInfo : toDirs) {
-    const QString toName = toInfo.fileName();
-    if (!toRe.match(toName).hasMatch()) continue;
+QString ReportManager::currentReportPath() const
+{
+  if (m_numberTO.isEmpty() || m_startTime.isEmpty()) return QString();
+  return getReportDirPath() + m_numberTO + "/" + m_startTime;
+}
 
-    QDir toDir(toInfo.absoluteFilePath());
-    QFileInfoList dateDirs = toDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+QString ReportManager::stablePdfPath() const
+{
+  return getReportDirPath() + "TOs/" + startTime() + "-" + currentNumberTO() + ".pdf";
+}
 
-    QList<QDate> dates;
-    for (const QFileInfo& dateInfo : dateDirs) {
-      QDate date = QDate::fromString(dateInfo.fileName(), "yyyy-MM-dd");
-      if (!date.isValid()) continue;
+QString ReportManager::readReport(FileService* fileService, const QString& path, QString& title,
+                                  std::vector<Step>& steps)
+{
+  if (!fileService->fileExists(path)) return tr("File does not exist: %1").arg(path);
 
-      QDir d(dateInfo.absoluteFilePath());
-      if (!(d.exists("report.json") && d.exists("report.pdf"))) continue;
+  DEBUG_COLORED("ReportManager", "readReport", "Loading JSON from file...", COLOR_GREEN, COLOR_GREEN);
+  QJsonObject json = fileService->loadJsonFromFile(path);
+  if (json.isEmpty()) return tr("Failed to load or parse JSON from: %1").arg(path);
 
-      dates.append(date);
-    }
-    if (dates.isEmpty()) continue;
+  if (!json.contains("title") || !json["title"].isString())
+    return tr("Invalid or missing 'title' field in JSON");
+  title = json["title"].toString();
 
-    std::sort(dates.begin(), dates.end(), std::greater<QDate>());
-    QVariantList dateList;
-    for (const QDate& d : dates)
-      dateList << d.toString("yyyy-MM-dd");
+  if (!json.contains("steps") || !json["steps"].isArray())
+    return tr("Invalid or missing 'steps' array in JSON");
 
-    result.insert(toName, dateList);
-  }
+  const QJsonArray stepsArray = json["steps"].toArray();
+  steps.reserve(stepsArray.size());
+  DEBUG_COLORED("ReportManager", "readReport", QString("Found %1 steps").arg(stepsArray.size()), COLOR_GREEN,
+                COLOR_GREEN);
 
-  return result;
+  for (const QJsonValue& val : stepsArray)
+    if (val.isObject()) steps.push_back(Step::fromJson(val.toObject()));
+  return QString();
 }
 
-QVariantMap ReportManager::performedTOsNew() const
+void ReportManager::applyReport(const QString& title, std::vector<Step> steps)
 {
-  QVariantMap result;
-  const QString basePath = getReportDirPath() + "TOs/";
-  QDir dir(basePath);
-  if (!dir.exists()) return result;
+  resetJournal();
+  std::unique_ptr<StepJournal> journal = restoreFromJournal(title, steps);
 
-  QRegularExpression fileRe(R"(^(\d{4}-\d{2}-\d{2})-(TO-\d+)\.pdf$)",
-                            QRegularExpression::CaseInsensitiveOption);
+  m_title = title;
+  emit titleChanged();
 
-  QFileInfoList pdfFiles = dir.entryInfoList({"*.pdf"}, QDir::Files, QDir::Name);
+  const qsizetype stepCount = steps.size();
+  m_model.setSteps(std::move(steps));
+  DEBUG_COLORED("ReportManager", "applyReport", QString("Successfully loaded %1 steps").arg(stepCount),
+                COLOR_GREEN, COLOR_GREEN);
 
-  QMap<QString, QList<QDate>> grouped;
-  for (const QFileInfo& file : pdfFiles) {
-    auto match = fileRe.match(file.fileName());
-    if (!match.hasMatch()) continue;
+  // Installed after setSteps(), loading is not an edit
+  m_journal = std::move(journal);
+  emit reportLoaded();
+}
 
-    QDate date = QDate::fromString(match.captured(1), "yyyy-MM-dd");
-    QString toKey = match.captured(2);
-    if (!date.isValid()) continue;
+std::unique_ptr<StepJournal> ReportManager::restoreFromJournal(const QString& title, std::vector<Step>& steps)
+{
+  const QString reportPath = currentReportPath();
+  if (reportPath.isEmpty() || !QDir(reportPath).exists()) return nullptr;
+  QDir dir(reportPath);
+
+  // A snapshot written by compactJournal() carries journal_seq, the last record it covers.
+  // The final save removes it, so a new test in the same directory starts from the template.
+  qint64 snapshotSeq = 0;
+  QFile snapshotFile(latestSnapshot(dir));
+  QByteArray snapshotData;
+  if (!snapshotFile.fileName().isEmpty() && snapshotFile.open(QIODevice::ReadOnly))
+    snapshotData = snapshotFile.readAll();
+  // Checked without decoding the steps
+  if (ReportCodec::field(snapshotData, "journal_seq").isDouble()) {
+    const QJsonObject snapshot = ReportCodec::decode(snapshotData);
+    const QJsonArray stepsArray = snapshot["steps"].toArray();
+    if (snapshot["title"].toString() == title && stepsArray.size() == qsizetype(steps.size())) {
+      for (qsizetype i = 0; i < stepsArray.size(); ++i) {
+        Step restored = Step::fromJson(stepsArray.at(i).toObject(), true);
+        if (restored.title == steps[i].title) steps[i] = std::move(restored);
+      }
+      snapshotSeq = snapshot["journal_seq"].toInteger();
+    }
+  }
+
+  auto journal = std::make_unique<StepJournal>(dir.filePath("report.journal"));
+  if (!journal->open(snapshotSeq)) return nullptr;
 
-    grouped[toKey].append(date);
+  int replayed = 0;
+  for (const StepJournal::Entry& entry : journal->entries()) {
+    if (entry.index < int(steps.size()) && StepJournal::apply(entry, steps[entry.index])) ++replayed;
   }
+  if (snapshotSeq > 0 || replayed > 0) {
+    DEBUG_COLORED("ReportManager", "restoreFromJournal",
+                  QString("Restored snapshot #%1 and replayed %2 edits").arg(snapshotSeq).arg(replayed),
+                  COLOR_GREEN, COLOR_GREEN);
+  }
+  return journal;
+}
+
+void ReportManager::journalSteps(int first, int last)
+{
+  if (!m_journal) return;
 
-  for (auto it = grouped.begin(); it != grouped.end(); ++it) {
-    std::sort(it.value().begin(), it.value().end(), std::greater<QDate>());
-    QVariantList dateList;
-    for (const QDate& d : it.value())
-      dateList << d.toString("yyyy-MM-dd");
-    result.insert(it.key(), dateList);
+  for (int row = first; row <= last; ++row) {
+    if (const Step* step = m_model.stepAt(row)) m_journal->append(row, *step);
   }
+  if (!m_compactionPending && m_journal->entries().size() >= JournalCompactRecords) compactJournal();
+}
 
-  return result;
+void ReportManager::compactJournal()
+{
+  QJsonObject json = reportJson();
+  const qint64 seq = m_journal->lastSeq();
+  json["journal_seq"] = seq;
+
+  m_compactionPending = true;
+  const QString path = QDir(currentReportPath()).filePath(snapshotFileName());
+  const quint64 generation = m_journalGeneration;
+  FileService* fileService = m_fileService;
+  m_ioExecutor->submit(
+      reportKey(),
+      [fileService, path, json](const ReportIoExecutor::Context&) {
+        return writeJson(fileService, path, json);
+      },
+      [this, generation, seq](const QString& error) {
+        if (generation != m_journalGeneration) return;
+        m_compactionPending = false;
+        if (!error.isEmpty()) {
+          DEBUG_ERROR_COLORED("ReportManager", "compactJournal", error, COLOR_GREEN, COLOR_GREEN);
+          return;
+        }
+        m_journal->truncateThrough(seq);
+      });
 }
 
-QString ReportManager::findReportPdf(const QString& categoryKey, const QString& dateIso) const
+void ReportManager::resetJournal()
 {
-  const QString path = getReportDirPath() + "TOs/";
-  QDir dir(path);
-  if (!dir.exists()) return QString();
+  m_journal.reset();
+  ++m_journalGeneration;
+  m_compactionPending = false;
+}
 
-  const QString fileName = QString("%1-%2.pdf").arg(dateIso, categoryKey);
-  QFileInfo file(path + fileName);
-  if (file.exists()) return file.absoluteFilePath();
+void ReportManager::discardJournal(const QString& reportPath)
+{
+  resetJournal();
 
-  return QString();
+  QDir dir(reportPath);
+  QFile::remove(dir.filePath("report.journal"));
+  for (const QString& name : snapshotFileNames()) QFile::remove(dir.filePath(name));
 }
 
 bool ReportManager::loadReport(const QString& filePath)
 {
-  auto handleError = [this](const QString& message) {
-    DEBUG_ERROR_COLORED("ReportManager", "loadReport", message, COLOR_RED, COLOR_GREEN);
-    setError(message);
-    return false;
-  };
-
   DEBUG_COLORED("ReportManager", "loadReport", QString("Attempting to load file: %1").arg(filePath),
                 COLOR_GREEN, COLOR_GREEN);
   const QString path = resolveResourcePath(filePath);
   DEBUG_COLORED("ReportManager", "loadReport", QString("Resolved path: %1").arg(path), COLOR_GREEN,
                 COLOR_GREEN);
 
-  if (!m_fileService->fileExists(path)) return handleError(tr("File does not exist: %1").arg(path));
-
-  DEBUG_COLORED("ReportManager", "loadReport", "Loading JSON from file...", COLOR_GREEN, COLOR_GREEN);
-  QJsonObject json = m_fileService->loadJsonFromFile(path);
-  if (json.isEmpty()) return handleError(tr("Failed to load or parse JSON from: %1").arg(path));
-
-  if (!json.contains("title") || !json["title"].isString())
-    return handleError(tr("Invalid or missing 'title' field in JSON"));
-
-  m_title = json["title"].toString();
-  emit titleChanged();
-
-  if (!json.contains("steps") || !json["steps"].isArray())
-    return handleError(tr("Invalid or missing 'steps' array in JSON"));
-
-  QList<Step> steps;
-  const QJsonArray stepsArray = json["steps"].toArray();
-  DEBUG_COLORED("ReportManager", "loadReport", QString("Found %1 steps").arg(stepsArray.size()), COLOR_GREEN,
-                COLOR_GREEN);
-
-  for (const QJsonValue& val : stepsArray)
-    if (val.isObject()) steps.push_back(Step::fromJson(val.toObject()));
-
-  m_model.setSteps(steps);
-  DEBUG_COLORED("ReportManager", "loadReport", QString("Successfully loaded %1 steps").arg(steps.size()),
-                COLOR_GREEN, COLOR_GREEN);
+  QString title;
+  std::vector<Step> steps;
+  const QString error = readReport(m_fileService, path, title, steps);
+  if (!error.isEmpty()) {
+    setError(error);
+    return false;
+  }
 
-  emit reportLoaded();
+  applyReport(title, std::move(steps));
   DEBUG_COLORED("ReportManager", "loadReport", "Load completed successfully", COLOR_GREEN, COLOR_GREEN);
   return true;
 }
 
-void ReportManager::saveReportJson(const QString& path)
+int ReportManager::loadReportAsync(const QString& filePath)
+{
+  const QString path = resolveResourcePath(filePath);
+  auto title = std::make_shared<QString>();
+  auto steps = std::make_shared<std::vector<Step>>();
+
+  FileService* fileService = m_fileService;
+  // Keyed like the saves of the current report, so the load cannot overtake one that is still queued
+  return m_ioExecutor->submit(
+      reportKey(),
+      [fileService, path, title, steps](const ReportIoExecutor::Context&) {
+        return readReport(fileService, path, *title, *steps);
+      },
+      [this, title, steps](const QString& error) {
+        if (!error.isEmpty()) {
+          setError(error);
+          return;
+        }
+        applyReport(*title, std::move(*steps));
+      });
+}
+
+QJsonObject ReportManager::reportJson() const
 {
-  DEBUG_COLORED("ReportManager", "saveReportJson", QString("called with path: %1").arg(path), COLOR_GREEN,
-                COLOR_GREEN);
   QJsonObject root;
   root["title"] = m_title;
 
@@ -193,144 +316,179 @@ void ReportManager::saveReportJson(const QString& path)
   }
 
   QJsonArray stepsArray;
-  for (const Step& step : m_model.getSteps()) {
+  for (const Step& step : m_model.steps()) {
     stepsArray.append(step.toJson());
   }
   root["steps"] = stepsArray;
+  return root;
+}
 
-  if (!m_fileService->saveJsonToFile(path, root)) {
-    setError(tr("Error saving to file: %1").arg(path));
-    return;
-  }
+QString ReportManager::writeJson(FileService* fileService, const QString& path, const QJsonObject& json)
+{
+  if (!fileService->saveJsonToFile(path, json)) return tr("Error saving to file: %1").arg(path);
 
-  DEBUG_COLORED("ReportManager", "saveReportJson", QString("JSON saved to: %1").arg(path), COLOR_GREEN,
+  DEBUG_COLORED("ReportManager", "writeJson", QString("JSON saved to: %1").arg(path), COLOR_GREEN,
                 COLOR_GREEN);
+  return QString();
 }
 
-void ReportManager::exportReportToPdf(const QString& path)
+void ReportManager::saveReportJson(const QString& path)
 {
-  DEBUG_COLORED("ReportManager", "exportReportToPdf", QString("called with path: %1").arg(path), COLOR_GREEN,
+  DEBUG_COLORED("ReportManager", "saveReportJson", QString("called with path: %1").arg(path), COLOR_GREEN,
                 COLOR_GREEN);
-  QString html;
-  html += "<html><head><style>"
-          "body { font-family: Arial; font-size: 12pt; }"
-          "h1 { font-size: 18pt; }"
-          "table { width: 100%; border-collapse: collapse; margin-top: 10pt; }"
-          "th, td { border: 1px solid #444; padding: 6px; text-align: left; }"
-          "th { background-color: #eee; }"
-          ".defect-details { margin-left: 20px; font-size: 10pt; }"
-          "</style></head><body>";
-
-  html += QString("<h1>%1</h1>").arg(m_title);
-  if (m_settingsManager) {
-    html += "<div class='serials'>";
-    html += QString("<div class='serial-item'><b>S/n:</b> %1</div>").arg(m_settingsManager->serialNumber());
-    html += "</div>";
-  }
-
-  html += QString("<p>Date: %1</p>").arg(QDateTime::currentDateTime().toString("dd.MM.yyyy HH:mm"));
-
-  html += "<table>"
-          "<tr>"
-          "<th>#</th>"
-          "<th>Step</th>"
-          "<th>Status</th>"
-          "<th>Damage Details</th>"
-          "</tr>";
-
-  for (int i = 0; i < m_model.rowCount(); ++i) {
-    const Step step = m_model.get(i);
-    QString statusText;
-    switch (step.completionStatus) {
-      case Step::CompletionStatus::NotStarted: statusText = "Not Started"; break;
-      case Step::CompletionStatus::Completed: statusText = "Completed"; break;
-      case Step::CompletionStatus::HasDefect: statusText = "Has Damage"; break;
-      case Step::CompletionStatus::Skipped: statusText = "Skipped"; break;
-    }
+  const QString error = writeJson(m_fileService, path, reportJson());
+  if (!error.isEmpty()) setError(error);
+}
 
-    QString defectDetails;
-    if (step.completionStatus == Step::CompletionStatus::HasDefect) {
-      defectDetails = QString("<div class='defect-details'>"
-                              "<p><b>Description:</b> %1</p>"
-                              "<p><b>Repair Method:</b> %2</p>"
-                              "<p><b>Status:</b> %3</p>"
-                              "</div>")
-                          .arg(step.defectDetails.description)
-                          .arg(step.defectDetails.repairMethod)
-                          .arg([&]() {
-                            switch (step.defectDetails.fixStatus) {
-                              case Step::DefectDetails::FixStatus::Fixed: return "Fixed";
-                              case Step::DefectDetails::FixStatus::Postponed: return "Postponed";
-                              case Step::DefectDetails::FixStatus::NotRequired: return "Not Required";
-                              case Step::DefectDetails::FixStatus::NotFixed: return "Not Fixed";
-                              default: return "Unknown";
-                            }
-                          }());
-    }
+int ReportManager::saveReportJsonAsync(const QString& path)
+{
+  FileService* fileService = m_fileService;
+  const QJsonObject json = reportJson();
+  return m_ioExecutor->submit(
+      reportKey(),
+      [fileService, path, json](const ReportIoExecutor::Context&) {
+        return writeJson(fileService, path, json);
+      },
+      [this](const QString& error) {
+        if (!error.isEmpty()) setError(error);
+      });
+}
 
-    html += QString("<tr>"
-                    "<td>%1</td>"
-                    "<td>%2</td>"
-                    "<td>%3</td>"
-                    "<td>%4</td>"
-                    "</tr>")
-                .arg(i + 1)
-                .arg(step.title)
-                .arg(statusText)
-                .arg(defectDetails);
-  }
+QString ReportManager::reportHtml() const
+{
+  ReportHtmlBuilder::Report report;
+  report.title = m_title;
+  if (m_settingsManager) report.serialNumber = m_settingsManager->serialNumber();
+  report.date = QDateTime::currentDateTime().toString("dd.MM.yyyy HH:mm");
+  report.steps = m_model.steps();
+  return ReportHtmlBuilder::build(report);
+}
 
-  html += "</table></body></html>";
-  QString tosDirPath = getReportDirPath() + "TOs/";
+QString ReportManager::writePdf(const QString& html, const QString& path, const QString& stablePath)
+{
+  const QString tosDirPath = QFileInfo(stablePath).absolutePath();
   QDir tosDir(tosDirPath);
   if (!tosDir.exists()) {
-    if (!tosDir.mkpath(".")) {
-      setError(tr("Cannot create directory: %1").arg(tosDirPath));
-      return;
-    }
+    if (!tosDir.mkpath(".")) return tr("Cannot create directory: %1").arg(tosDirPath);
   }
 
-  QString stableSavePath = tosDirPath + startTime() + "-" + currentNumberTO() + ".pdf";
-  if (!PdfExporter::exportToPdf(html, path, stableSavePath)) {
-    setError(tr("PDF export error: %1 and %2").arg(path, stableSavePath));
+  if (!PdfExporter::exportToPdf(html, path, stablePath))
+    return tr("PDF export error: %1 and %2").arg(path, stablePath);
+
+  DEBUG_COLORED("ReportManager", "writePdf",
+                QString("PDF successfully exported to: %1 %2").arg(path, stablePath), COLOR_GREEN,
+                COLOR_GREEN);
+  return QString();
+}
+
+void ReportManager::exportReportToPdf(const QString& path)
+{
+  DEBUG_COLORED("ReportManager", "exportReportToPdf", QString("called with path: %1").arg(path), COLOR_GREEN,
+                COLOR_GREEN);
+  const QString error = writePdf(reportHtml(), path, stablePdfPath());
+  if (!error.isEmpty()) {
+    setError(error);
     return;
   }
-  DEBUG_COLORED("ReportManager", "exportReportToPdf",
-                QString("PDF successfully exported to: %1 %2").arg(path, stableSavePath), COLOR_GREEN,
-                COLOR_GREEN);
+  m_reportIndex->refreshStablePdf(currentNumberTO(), startTime());
+}
+
+int ReportManager::exportReportToPdfAsync(const QString& path)
+{
+  const QString html = reportHtml();
+  const QString stablePath = stablePdfPath();
+  const QString numberTO = currentNumberTO();
+  const QString date = startTime();
+  return m_ioExecutor->submit(
+      reportKey(),
+      [html, path, stablePath](const ReportIoExecutor::Context&) { return writePdf(html, path, stablePath); },
+      [this, numberTO, date](const QString& error) {
+        if (!error.isEmpty()) {
+          setError(error);
+          return;
+        }
+        m_reportIndex->refreshStablePdf(numberTO, date);
+      });
+}
+
+QString ReportManager::makeReportDir(const QString& reportPath)
+{
+  QDir dir(reportPath);
+  if (!dir.exists() && !dir.mkpath(".")) return tr("Failed to create directory: %1").arg(reportPath);
+  return QString();
 }
 
 void ReportManager::saveReport(bool firstSave)
 {
   DEBUG_COLORED("ReportManager", "saveReport", QString("called with firstSave: %1").arg(firstSave),
                 COLOR_GREEN, COLOR_GREEN);
-  const QString basePath = getReportDirPath() + m_numberTO + "/";
-  DEBUG_COLORED("ReportManager", "saveReport", QString("path for save: %1").arg(basePath), COLOR_GREEN,
+  const QString reportPath = getReportDirPath() + m_numberTO + "/" + m_startTime;
+  DEBUG_COLORED("ReportManager", "saveReport", QString("path for save: %1").arg(reportPath), COLOR_GREEN,
                 COLOR_GREEN);
-  QDir dir(basePath);
 
-  if (!dir.exists() && !dir.mkpath(".")) {
-    setError(tr("Failed to create directory: %1").arg(basePath));
+  const QString error = makeReportDir(reportPath);
+  if (!error.isEmpty()) {
+    setError(error);
     return;
   }
 
-  const QString reportPath = basePath + m_startTime;
-  dir.setPath(reportPath);
-
-  if (!dir.exists() && !dir.mkpath(".")) {
-    setError(tr("Failed to create directory: %1").arg(reportPath));
-    return;
+  QDir dir(reportPath);
+  if (!firstSave) {
+    const QJsonObject json = reportJson();
+    QString jsonError = writeJson(m_fileService, dir.filePath("report.json"), json);
+    if (jsonError.isEmpty() && ConfigManager::instance().reportCbor())
+      jsonError = writeJson(m_fileService, dir.filePath("report.cbor"), json);
+    if (jsonError.isEmpty())
+      discardJournal(reportPath);
+    else
+      setError(jsonError);
+    exportReportToPdf(dir.filePath("report.pdf"));
   }
+  m_reportIndex->refreshReport(m_numberTO, m_startTime);
 
-  const QString json_path = dir.filePath("report.json");
-  const QString pdf_path = dir.filePath("report.pdf");
+  DEBUG_COLORED("ReportManager", "saveReport", "Report saved successfully", COLOR_GREEN, COLOR_GREEN);
+}
 
+int ReportManager::saveReportAsync(bool firstSave)
+{
+  const QString reportPath = getReportDirPath() + m_numberTO + "/" + m_startTime;
+  const QString numberTO = m_numberTO;
+  const QString date = m_startTime;
+  const quint64 generation = m_journalGeneration;
+  const bool writeCbor = ConfigManager::instance().reportCbor();
+  FileService* fileService = m_fileService;
+
+  // Snapshots are only needed when the report content is written
+  QJsonObject json;
+  QString html;
+  QString stablePath;
   if (!firstSave) {
-    saveReportJson(json_path);
-    exportReportToPdf(pdf_path);
+    json = reportJson();
+    html = reportHtml();
+    stablePath = stablePdfPath();
   }
 
-  DEBUG_COLORED("ReportManager", "saveReport", "Report saved successfully", COLOR_GREEN, COLOR_GREEN);
+  return m_ioExecutor->submit(
+      reportKey(),
+      [reportPath, firstSave, writeCbor, fileService, json, html,
+       stablePath](const ReportIoExecutor::Context& context) {
+        QString error = makeReportDir(reportPath);
+        if (!error.isEmpty() || firstSave) return error;
+
+        QDir dir(reportPath);
+        error = writeJson(fileService, dir.filePath("report.json"), json);
+        if (error.isEmpty() && writeCbor) error = writeJson(fileService, dir.filePath("report.cbor"), json);
+        context.setProgress(1, 2);
+        if (error.isEmpty()) error = writePdf(html, dir.filePath("report.pdf"), stablePath);
+        context.setProgress(2, 2);
+        return error;
+      },
+      [this, reportPath, numberTO, date, firstSave, generation](const QString& error) {
+        if (!error.isEmpty()) setError(error);
+        if (!firstSave && error.isEmpty() && generation == m_journalGeneration) discardJournal(reportPath);
+        if (!firstSave) m_reportIndex->refreshStablePdf(numberTO, date);
+        m_reportIndex->refreshReport(numberTO, date);
+      });
 }
 
 void ReportManager::revokeReport()
@@ -350,9 +508,12 @@ void ReportManager::revokeReport()
     return;
   }
 
+  // The journal lives in the directory and is still open
+  resetJournal();
   bool success = removeDir(reportPath);
 
   if (success) {
+    m_reportIndex->removeReport(currentNumberTO(), startTime());
     DEBUG_COLORED("ReportManager", "revokeReport",
                   QString("Successfully revoked report at: %1").arg(reportPath), COLOR_GREEN, COLOR_GREEN);
     m_startTime = "";
@@ -363,34 +524,15 @@ void ReportManager::revokeReport()
   }
 }
 
-bool ReportManager::uploadReport(const QString& sourceFolderPath, bool after)
+QString ReportManager::copyFolder(const QString& sourceFolderPath, const QString& destPath)
 {
-  DEBUG_COLORED("ReportManager", "uploadReport",
-                QString("called with sourceFolderPath: %1, after: %2").arg(sourceFolderPath).arg(after),
-                COLOR_GREEN, COLOR_GREEN);
-
-  if (sourceFolderPath.isEmpty()) {
-    setError(tr("Source folder path is empty"));
-    return false;
-  }
+  if (sourceFolderPath.isEmpty()) return tr("Source folder path is empty");
 
   QDir sourceDir(sourceFolderPath);
-  if (!sourceDir.exists()) {
-    setError(tr("Source folder does not exist: %1").arg(sourceFolderPath));
-    return false;
-  }
-
-  // Создаем базовый путь для сохранения
-  const QString basePath = getReportDirPath();
-  const QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd_HH-mm-ss");
-  const QString destPath =
-      after ? (basePath + timestamp + "/before_to/") : (basePath + timestamp + "/after_to/");
+  if (!sourceDir.exists()) return tr("Source folder does not exist: %1").arg(sourceFolderPath);
 
   QDir destDir(destPath);
-  if (!destDir.mkpath(".")) {
-    setError(tr("Failed to create destination directory: %1").arg(destPath));
-    return false;
-  }
+  if (!destDir.mkpath(".")) return tr("Failed to create destination directory: %1").arg(destPath);
 
   // Копируем все файлы из исходной папки
   bool allFilesCopied = true;
@@ -400,74 +542,161 @@ bool ReportManager::uploadReport(const QString& sourceFolderPath, bool after)
     QString destFilePath = destPath + fileInfo.fileName();
     if (!QFile::copy(fileInfo.absoluteFilePath(), destFilePath)) {
       allFilesCopied = false;
-      DEBUG_COLORED("ReportManager", "uploadReport",
+      DEBUG_COLORED("ReportManager", "copyFolder",
                     QString("Failed to copy file: %1").arg(fileInfo.fileName()), COLOR_RED, COLOR_GREEN);
     }
   }
 
-  if (!allFilesCopied) {
-    setError(tr("Failed to copy some files"));
-    return false;
-  }
+  if (!allFilesCopied) return tr("Failed to copy some files");
 
-  DEBUG_COLORED("ReportManager", "uploadReport", QString("Report uploaded successfully to: %1").arg(destPath),
+  DEBUG_COLORED("ReportManager", "copyFolder", QString("Report uploaded successfully to: %1").arg(destPath),
                 COLOR_GREEN, COLOR_GREEN);
-  return true;
+  return QString();
 }
 
-bool ReportManager::createArchive(const QString& folderPath, const QString& mode)
+bool ReportManager::uploadReport(const QString& sourceFolderPath, bool after)
 {
-  DEBUG_COLORED("ReportManager", "createArchive",
-                QString("called with folderPath: %1, mode: %2").arg(folderPath).arg(mode), COLOR_GREEN,
-                COLOR_GREEN);
+  DEBUG_COLORED("ReportManager", "uploadReport",
+                QString("called with sourceFolderPath: %1, after: %2").arg(sourceFolderPath).arg(after),
+                COLOR_GREEN, COLOR_GREEN);
 
-  QDir sourceDir(folderPath);
-  if (!sourceDir.exists()) {
-    setError("Папка не существует: " + folderPath);
-    return false;
-  }
+  // Создаем базовый путь для сохранения
+  const QString basePath = getReportDirPath();
+  const QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd_HH-mm-ss");
+  const QString destPath =
+      after ? (basePath + timestamp + "/before_to/") : (basePath + timestamp + "/after_to/");
 
-  const qint64 MAX_SIZE = 100 * 1024 * 1024;
-  qint64 folderSize = getDirSize(folderPath);
-  if (folderSize > MAX_SIZE) {
-    setError(QString("Размер папки превышает 100 МБ: %1 МБ").arg(folderSize / (1024 * 1024)));
+  const QString error = copyFolder(sourceFolderPath, destPath);
+  if (!error.isEmpty()) {
+    setError(error);
     return false;
   }
+  return true;
+}
 
-  const QString basePath = getReportDirPath() + m_numberTO + "/";
-  const QString subDir = (mode == "before") ? "before_to" : "after_to";
-  const QString destDirPath = basePath + startTime() + "/" + subDir + "/";
+int ReportManager::uploadReportAsync(const QString& sourceFolderPath, bool after)
+{
+  const QString basePath = getReportDirPath();
+  const QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd_HH-mm-ss");
+  const QString destPath =
+      after ? (basePath + timestamp + "/before_to/") : (basePath + timestamp + "/after_to/");
+
+  return m_ioExecutor->submit(
+      destPath,
+      [sourceFolderPath, destPath](const ReportIoExecutor::Context&) {
+        return copyFolder(sourceFolderPath, destPath);
+      },
+      [this](const QString& error) {
+        if (!error.isEmpty()) setError(error);
+      });
+}
+
+QString ReportManager::archiveFolder(const QString& folderPath, const QString& destDirPath,
+                                     const std::function<void(qint64, qint64)>& progress)
+{
+  QDir sourceDir(folderPath);
+  if (!sourceDir.exists()) return "Папка не существует: " + folderPath;
+
+  const qint64 MAX_SIZE = 100 * 1024 * 1024;
 
   QDir destDir(destDirPath);
-  if (!destDir.mkpath(".")) {
-    setError("Не удалось создать директорию: " + destDirPath);
-    return false;
-  }
+  if (!destDir.mkpath(".")) return "Не удалось создать директорию: " + destDirPath;
 
   QString zipFileName = destDirPath + "rail_record.zip";
-  if (!JlCompress::compressDir(zipFileName, folderPath)) {
-    setError("Не удалось создать архив");
-    return false;
+  ParallelArchiver::Options options;
+  options.compressionLevel = ConfigManager::instance().archiveCompressionLevel();
+  options.threadCount = ConfigManager::instance().archiveThreadCount();
+  options.maxTotalSize = MAX_SIZE;
+  ParallelArchiver archiver(options);
+  QObject::connect(&archiver, &ParallelArchiver::progressChanged, progress);
+  if (!archiver.compressDir(zipFileName, folderPath)) {
+    if (archiver.sizeLimitExceeded()) {
+      QDir().rmdir(destDirPath);
+      return QString("Размер папки превышает 100 МБ: %1 МБ").arg(archiver.totalSize() / (1024 * 1024));
+    }
+    DEBUG_ERROR_COLORED("ReportManager", "archiveFolder", archiver.errorString(), COLOR_GREEN, COLOR_GREEN);
+    return "Не удалось создать архив";
   }
 
-  DEBUG_COLORED("ReportManager", "createArchive", QString("Архив успешно создан: %1").arg(zipFileName),
+  DEBUG_COLORED("ReportManager", "archiveFolder", QString("Архив успешно создан: %1").arg(zipFileName),
                 COLOR_GREEN, COLOR_GREEN);
-  return true;
+  return QString();
 }
 
-qint64 ReportManager::getDirSize(const QString& path)
+bool ReportManager::createArchive(const QString& folderPath, const QString& mode)
 {
-  qint64 size = 0;
-  QDir dir(path);
-  QFileInfoList list = dir.entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
-  for (const QFileInfo& fi : list) {
-    if (fi.isDir()) {
-      size += getDirSize(fi.absoluteFilePath());
-    } else {
-      size += fi.size();
-    }
+  DEBUG_COLORED("ReportManager", "createArchive",
+                QString("called with folderPath: %1, mode: %2").arg(folderPath).arg(mode), COLOR_GREEN,
+                COLOR_GREEN);
+
+  const QString subDir = (mode == "before") ? "before_to" : "after_to";
+  const QString destDirPath = getReportDirPath() + m_numberTO + "/" + startTime() + "/" + subDir + "/";
+
+  const QString error = archiveFolder(folderPath, destDirPath, [this](qint64 processed, qint64 total) {
+    emit archiveProgress(processed, total);
+  });
+  if (!error.isEmpty()) {
+    setError(error);
+    return false;
   }
-  return size;
+  m_reportIndex->refreshReport(m_numberTO, startTime());
+  return true;
+}
+
+int ReportManager::createArchiveAsync(const QString& folderPath, const QString& mode)
+{
+  const QString subDir = (mode == "before") ? "before_to" : "after_to";
+  const QString destDirPath = getReportDirPath() + m_numberTO + "/" + startTime() + "/" + subDir + "/";
+  const QString numberTO = m_numberTO;
+  const QString date = startTime();
+
+  return m_ioExecutor->submit(
+      reportKey(),
+      [this, folderPath, destDirPath](const ReportIoExecutor::Context& context) {
+        // Signals emitted from the worker reach GUI-thread receivers through queued connections
+        return archiveFolder(folderPath, destDirPath, [this, &context](qint64 processed, qint64 total) {
+          context.setProgress(processed, total);
+          emit archiveProgress(processed, total);
+        });
+      },
+      [this, numberTO, date](const QString& error) {
+        if (!error.isEmpty()) {
+          setError(error);
+          return;
+        }
+        m_reportIndex->refreshReport(numberTO, date);
+      });
+}
+
+int ReportManager::regenerateAllPdfsAsync()
+{
+  QList<PdfBatchExporter::Target> targets;
+  for (const ReportIndex::Entry& entry : m_reportIndex->entries())
+    if (entry.hasJson) targets.append({entry.numberTO, entry.date});
+
+  DEBUG_COLORED("ReportManager", "regenerateAllPdfsAsync",
+                QString("Regenerating %1 PDFs").arg(targets.size()), COLOR_GREEN, COLOR_GREEN);
+
+  const QString root = getReportDirPath();
+  return m_ioExecutor->submit(
+      "pdf-batch",
+      [root, targets](const ReportIoExecutor::Context& context) {
+        PdfBatchExporter exporter(root);
+        QObject::connect(&exporter, &PdfBatchExporter::progressChanged,
+                         [&context](int finished, int total) { context.setProgress(finished, total); });
+        int failed = 0;
+        for (const PdfBatchExporter::Result& result : exporter.run(targets))
+          if (!result.error.isEmpty()) ++failed;
+        if (failed == 0) return QString();
+        return QString("Failed to regenerate %1 of %2 PDFs").arg(failed).arg(targets.size());
+      },
+      [this, targets](const QString& error) {
+        for (const PdfBatchExporter::Target& target : targets) {
+          m_reportIndex->refreshReport(target.numberTO, target.date);
+          m_reportIndex->refreshStablePdf(target.numberTO, target.date);
+        }
+        if (!error.isEmpty()) setError(error);
+      });
 }
 
 void ReportManager::setStartTime(const QString& time)
@@ -476,6 +705,7 @@ void ReportManager::setStartTime(const QString& time)
     DEBUG_COLORED("ReportManager", "setStartTime",
                   QString("Changing start time from %1 to %2").arg(m_startTime).arg(time), COLOR_GREEN,
                   COLOR_GREEN);
+    resetJournal();
     m_startTime = time;
     emit startTimeChanged();
   }
@@ -487,6 +717,7 @@ void ReportManager::setCurrentNumberTO(const QString& numberTO)
     DEBUG_COLORED("ReportManager", "setCurrentNumberTO",
                   QString("Changing number TO from %1 to %2").arg(m_numberTO).arg(numberTO), COLOR_GREEN,
                   COLOR_GREEN);
+    resetJournal();
     m_numberTO = numberTO;
     emit numberTOChanged();
   }
@@ -2,8 +2,10 @@
 
 #include <qtmetamacros.h>
 
+#include <QJsonObject>
 #include <QObject>
 #include <QVariant>
+#include <functional>
 
 #include "models/stepmodel.h"
 #include "settings/settingsmanager.h"
@@ -12,6 +14,9 @@
 class NetworkService;
 class FileService;
 class PdfExporter;
+class ReportIndex;
+class ReportIoExecutor;
+class StepJournal;
 
 class ReportManager : public QObject
 {
@@ -24,7 +29,7 @@ class ReportManager : public QObject
 public:
   // Construction/Destruction
   explicit ReportManager(FileService* fileService, NetworkService* networkService, QObject* parent = nullptr);
-  ~ReportManager() = default;
+  ~ReportManager();
 
   // Q_INVOKABLE methods - Report Operations
   Q_INVOKABLE bool loadReport(const QString& filePath);
@@ -35,6 +40,17 @@ public:
   Q_INVOKABLE bool uploadReport(const QString& sourceFolderPath, bool after);
   Q_INVOKABLE bool createArchive(const QString& folderPath, const QString& mode);
 
+  // Asynchronous variants: the blocking part runs on the I/O executor, serialized per report, and the
+  // outcome arrives through ReportIoExecutor::jobFinished with the returned job id
+  int loadReportAsync(const QString& filePath);
+  int saveReportJsonAsync(const QString& path);
+  int exportReportToPdfAsync(const QString& path);
+  int saveReportAsync(bool firstSave);
+  int uploadReportAsync(const QString& sourceFolderPath, bool after);
+  int createArchiveAsync(const QString& folderPath, const QString& mode);
+  // Re-renders report.pdf and the reports/TOs/ copy of every stored report that has a report.json
+  int regenerateAllPdfsAsync();
+
   // Q_INVOKABLE methods - Utility
   Q_INVOKABLE QVariantMap performedTOs() const;
   Q_INVOKABLE QVariantMap performedTOsNew() const;
@@ -48,6 +64,8 @@ public:
   StepModel* stepsModel() { return &m_model; }
   FileService* fileService() const { return m_fileService; }
   NetworkService* networkService() const { return m_networkService.get(); }
+  ReportIndex* reportIndex() const { return m_reportIndex.get(); }
+  ReportIoExecutor* ioExecutor() const { return m_ioExecutor.get(); }
 
   // Property setters
   void setStartTime(const QString& time);
@@ -64,12 +82,39 @@ signals:
   // Operation signals
   void reportLoaded();
   void errorOccurred(const QString& error);
+  void archiveProgress(qint64 processedBytes, qint64 totalBytes);
 
 private:
   // Private helper methods
-  qint64 getDirSize(const QString& path);
   bool removeDir(const QString& dirPath);
   void setError(const QString& error);
+  QString reportKey() const { return m_numberTO + "/" + m_startTime; }
+  // Directory of the report being filled in, empty until a test is started
+  QString currentReportPath() const;
+  QString stablePdfPath() const;
+
+  // Snapshots taken on the GUI thread, handed to the I/O workers
+  QJsonObject reportJson() const;
+  QString reportHtml() const;
+  void applyReport(const QString& title, std::vector<Step> steps);
+
+  // Step edits are journaled next to the report, see StepJournal
+  std::unique_ptr<StepJournal> restoreFromJournal(const QString& title, std::vector<Step>& steps);
+  void journalSteps(int first, int last);
+  void compactJournal();
+  void resetJournal();
+  // Called once the final report.json is written, the journal and its snapshots are no longer needed
+  void discardJournal(const QString& reportPath);
+
+  // Blocking parts, safe to run on a worker thread; each returns an error message, empty on success
+  static QString readReport(FileService* fileService, const QString& path, QString& title,
+                            std::vector<Step>& steps);
+  static QString writeJson(FileService* fileService, const QString& path, const QJsonObject& json);
+  static QString writePdf(const QString& html, const QString& path, const QString& stablePath);
+  static QString makeReportDir(const QString& reportPath);
+  static QString copyFolder(const QString& sourceFolderPath, const QString& destPath);
+  static QString archiveFolder(const QString& folderPath, const QString& destDirPath,
+                               const std::function<void(qint64, qint64)>& progress);
 
 private:
   // Core data members
@@ -82,4 +127,11 @@ private:
   SettingsManager* m_settingsManager = nullptr;
   FileService* m_fileService;
   std::unique_ptr<NetworkService> m_networkService;
+  std::unique_ptr<ReportIndex> m_reportIndex;
+  std::unique_ptr<StepJournal> m_journal;
+  // Bumped whenever m_journal is replaced, so late snapshot results are ignored
+  quint64 m_journalGeneration = 0;
+  bool m_compactionPending = false;
+  // Declared last: destroyed first, so no worker outlives the members it was handed
+  std::unique_ptr<ReportIoExecutor> m_ioExecutor;
 };
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "modelsconfigcache.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonDocument>
+#include <QMutex>
+#include <QMutexLocker>
+
+
+namespace
+{
+
+struct CachedConfig {
+  qint64 size = -1;
+  qint64 mtime = -1;
+  QJsonObject root;
+};
+
+QMutex& cacheMutex()
+{
+  static QMutex mutex;
+  return mutex;
+}
+
+QHash<QString, CachedConfig>& cache()
+{
+  static QHash<QString, CachedConfig> entries;
+  return entries;
+}
+
+} // namespace
+
+QJsonObject ModelsConfigCache::root(const QString& filePath)
+{
+  const QFileInfo info(filePath);
+  const qint64 size = info.size();
+  const qint64 mtime = info.lastModified().toMSecsSinceEpoch();
+
+  QMutexLocker locker(&cacheMutex());
+  const auto cached = cache().constFind(filePath);
+  if (cached != cache().constEnd() && cached->size == size && cached->mtime == mtime) return cached->root;
+
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    qWarning() << "Cannot open file:" << filePath;
+    return QJsonObject();
+  }
+
+  QJsonParseError parseError;
+  const QJsonDocument jsonDoc = QJsonDocument::fromJson(file.readAll(), &parseError);
+  if (parseError.error != QJsonParseError::NoError) {
+    qWarning() << "JSON parse error:" << parseError.errorString();
+    return QJsonObject();
+  }
+
+  cache().insert(filePath, {size, mtime, jsonDoc.object()});
+  return jsonDoc.object();
+}
+
+void ModelsConfigCache::clear()
+{
+  QMutexLocker locker(&cacheMutex());
+  cache().clear();
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QString>
+
+// Process-wide cache of parsed model configuration files (media/jsons/models.json).
+// A file is read and parsed once per path, size and modification time; every SettingsManager and
+// ModelSettings then shares the same implicitly shared, read-only tree. A file changed on disk is
+// parsed again on the next lookup. Safe to call from any thread.
+class ModelsConfigCache
+{
+public:
+  // Root object of the file, empty if it cannot be read or parsed
+  static QJsonObject root(const QString& filePath);
+  static void clear();
+};
@@ -5,7 +5,79 @@
 #include <QMetaProperty>
 #include <QMetaType>
 
-int ModelSettings::s_propertyCounter = 0;
+#include "modelsconfigcache.h"
+
+
+namespace
+{
+
+bool isTrueString(const QString& value)
+{
+  const QString str = value.toLower();
+  return str == "true" || str == "1" || str == "yes" || str == "да";
+}
+
+// Stored values: SettingsStore may hand back strings for anything written by an older version
+
+QVariant boolFromSetting(const QVariant& value)
+{
+  if (value.typeId() == QMetaType::QString) return isTrueString(value.toString());
+  if (value.typeId() == QMetaType::Int) return value.toInt() != 0;
+  if (value.typeId() != QMetaType::Bool) return value.toBool();
+  return value;
+}
+
+QVariant intFromSetting(const QVariant& value)
+{
+  if (value.typeId() == QMetaType::QString) return value.toString().toInt();
+  if (value.typeId() != QMetaType::Int) return value.toInt();
+  return value;
+}
+
+QVariant doubleFromSetting(const QVariant& value)
+{
+  if (value.typeId() == QMetaType::QString) return value.toString().replace(',', '.').toDouble();
+  if (value.typeId() != QMetaType::Double) return value.toDouble();
+  return value;
+}
+
+QVariant stringFromSetting(const QVariant& value)
+{
+  return value;
+}
+
+// Values coming from the server
+
+QVariant boolFromJson(const QJsonValue& value)
+{
+  if (value.isBool()) return value.toBool();
+  if (value.isString()) return isTrueString(value.toString());
+  if (value.isDouble()) return value.toInt() != 0;
+  return false;
+}
+
+QVariant intFromJson(const QJsonValue& value)
+{
+  if (value.isDouble()) return value.toInt();
+  if (value.isString()) return value.toString().toInt();
+  return 0;
+}
+
+QVariant doubleFromJson(const QJsonValue& value)
+{
+  if (value.isDouble()) return value.toDouble();
+  if (value.isString()) return value.toString().replace(',', '.').toDouble();
+  return 0.0;
+}
+
+QVariant stringFromJson(const QJsonValue& value)
+{
+  if (value.isNull() || value.isUndefined()) return QString();
+  if (value.isString()) return value.toString();
+  return value.toVariant();
+}
+
+} // namespace
 
 QVariantMap ModelSettings::FieldMetadata::toVariantMap() const
 {
@@ -30,21 +102,16 @@ ModelSettings::ModelSettings(const QString& modelName, QObject* parent)
 
 bool ModelSettings::loadConfiguration(const QString& jsonPath)
 {
-  QFile file(jsonPath);
-  if (!file.open(QIODevice::ReadOnly)) {
-    qWarning() << "Failed to open config file:" << jsonPath;
-    return false;
-  }
-
-  QByteArray data = file.readAll();
-  QJsonDocument doc = QJsonDocument::fromJson(data);
-  if (doc.isNull()) {
+  const QJsonObject root = ModelsConfigCache::root(jsonPath);
+  if (root.isEmpty()) {
     qWarning() << "Invalid JSON in config file:" << jsonPath;
     return false;
   }
+  return loadConfiguration(root);
+}
 
-  QJsonObject root = doc.object();
-
+bool ModelSettings::loadConfiguration(const QJsonObject& root)
+{
   if (root.contains("models") && root["models"].isObject()) {
     QJsonObject models = root["models"].toObject();
     if (models.contains(m_modelName) && models[m_modelName].isObject()) {
@@ -90,17 +157,29 @@ void ModelSettings::parseModelMetadata(const QJsonObject& config)
   }
 }
 
+ModelSettings::ValueType ModelSettings::valueTypeOf(const QString& cppType)
+{
+  if (cppType == "bool") return ValueType::Bool;
+  if (cppType == "int") return ValueType::Int;
+  if (cppType == "double") return ValueType::Double;
+  return ValueType::String;
+}
+
 void ModelSettings::createPropertiesFromConfig(const QJsonObject& config)
 {
   m_sections.clear();
-  m_fieldsMetadata.clear();
+  m_fields.clear();
   m_values.clear();
+  m_fieldIndex.clear();
+  m_jsonKeyIndex.clear();
 
   if (!config.contains("sections") || !config["sections"].isArray()) {
     qWarning() << "Missing sections array in" << m_modelName << "config";
     return;
   }
 
+  // Sorted by name and deduplicated, the order every listing of the fields has always used
+  QMap<QString, FieldMetadata> fieldsByName;
   QJsonArray sectionsArray = config["sections"].toArray();
 
   for (const QJsonValue& sectionVal : sectionsArray) {
@@ -127,44 +206,60 @@ void ModelSettings::createPropertiesFromConfig(const QJsonObject& config)
       metadata.cppType = field["cpptype"].toString();
       metadata.visibleInInitialMode = field["visibleInInitialMode"].toBool(false);
       metadata.checkboxText = field["checkboxText"].toString();
+      metadata.valueType = valueTypeOf(metadata.cppType);
+      metadata.settingsKey = m_modelName + "/" + metadata.name;
+
+      switch (metadata.valueType) {
+        case ValueType::Bool:
+          metadata.defaultValue = field["default"].toBool(false);
+          metadata.fromSetting = boolFromSetting;
+          metadata.fromJson = boolFromJson;
+          break;
+        case ValueType::Int:
+          metadata.defaultValue = field["default"].toInt(0);
+          metadata.fromSetting = intFromSetting;
+          metadata.fromJson = intFromJson;
+          break;
+        case ValueType::Double:
+          metadata.defaultValue = field["default"].toDouble(0.0);
+          metadata.fromSetting = doubleFromSetting;
+          metadata.fromJson = doubleFromJson;
+          break;
+        case ValueType::String:
+          metadata.defaultValue = field["default"].toString("");
+          metadata.fromSetting = stringFromSetting;
+          metadata.fromJson = stringFromJson;
+          break;
+      }
 
-      QVariant defaultValue;
-
-      if (metadata.cppType == "bool")
-        defaultValue = field["default"].toBool(false);
-      else if (metadata.cppType == "int")
-        defaultValue = field["default"].toInt(0);
-      else if (metadata.cppType == "double")
-        defaultValue = field["default"].toDouble(0.0);
-      else
-        defaultValue = field["default"].toString("");
-
-      metadata.defaultValue = defaultValue;
-
-      m_fieldsMetadata[metadata.name] = metadata;
-      m_values[metadata.name] = defaultValue;
-
-      setProperty(metadata.name.toLatin1().constData(), defaultValue);
-
+      fieldsByName[metadata.name] = metadata;
       section.fields.append(metadata);
     }
 
     m_sections.append(section);
   }
 
+  m_fields.reserve(fieldsByName.size());
+  m_values.reserve(fieldsByName.size());
+  for (const FieldMetadata& metadata : std::as_const(fieldsByName)) {
+    m_fieldIndex.insert(metadata.name, m_fields.size());
+    if (!metadata.jsonKey.isEmpty()) m_jsonKeyIndex.insert(metadata.jsonKey, m_fields.size());
+    m_fields.append(metadata);
+    m_values.append(metadata.defaultValue);
+  }
+
   emit fieldsChanged();
 }
-void ModelSettings::loadFromSettings(QSettings& settings, const QString& currentModel, const QString& prefix)
+void ModelSettings::loadFromSettings(SettingsStore& settings, const QString& currentModel,
+                                     const QString& prefix)
 {
-  QString pre = prefix.isEmpty() ? m_modelName + "/" : prefix;
-
-  for (auto it = m_fieldsMetadata.begin(); it != m_fieldsMetadata.end(); ++it) {
-    const QString& fieldName = it.key();
-    const FieldMetadata& metadata = it.value();
+  for (int i = 0; i < m_fields.size(); ++i) {
+    const FieldMetadata& metadata = m_fields.at(i);
+    const QString& fieldName = metadata.name;
 
     QVariant value;
-    QString key = pre + fieldName;
-    QString generalKey = fieldName;
+    const QString key = prefix.isEmpty() ? metadata.settingsKey : prefix + fieldName;
+    const QString& generalKey = fieldName;
 
     if (fieldName == "serialNumber") {
       if (settings.contains(key)) {
@@ -188,47 +283,20 @@ void ModelSettings::loadFromSettings(QSettings& settings, const QString& current
           qDebug() << "Set default serialNumber in both locations:" << value;
         }
       }
-    } else if (settings.contains(key)) {
-      value = settings.value(key, metadata.defaultValue);
     } else {
-      value = metadata.defaultValue;
-    }
-
-    if (metadata.cppType == "bool") {
-      if (value.typeId() == QMetaType::QString) {
-        QString str = value.toString().toLower();
-        value = (str == "true" || str == "1" || str == "yes" || str == "да");
-      } else if (value.typeId() == QMetaType::Int) {
-        value = value.toInt() != 0;
-      } else if (value.typeId() != QMetaType::Bool) {
-        value = value.toBool();
-      }
-    } else if (metadata.cppType == "int") {
-      if (value.typeId() == QMetaType::QString) {
-        value = value.toString().toInt();
-      } else if (value.typeId() != QMetaType::Int) {
-        value = value.toInt();
-      }
-    } else if (metadata.cppType == "double") {
-      if (value.typeId() == QMetaType::QString) {
-        value = value.toString().replace(',', '.').toDouble();
-      } else if (value.typeId() != QMetaType::Double) {
-        value = value.toDouble();
-      }
+      value = settings.value(key, metadata.defaultValue);
     }
 
-    m_values[fieldName] = value;
-    setProperty(fieldName.toLatin1().constData(), value);
+    m_values[i] = metadata.fromSetting(value);
   }
 }
 
 
-void ModelSettings::saveToSettings(QSettings& settings, const QString& prefix) const
+void ModelSettings::saveToSettings(SettingsStore& settings, const QString& prefix) const
 {
-  QString pre = prefix.isEmpty() ? m_modelName + "/" : prefix;
-
-  for (auto it = m_values.constBegin(); it != m_values.constEnd(); ++it) {
-    settings.setValue(pre + it.key(), it.value());
+  for (int i = 0; i < m_fields.size(); ++i) {
+    const FieldMetadata& metadata = m_fields.at(i);
+    settings.setValue(prefix.isEmpty() ? metadata.settingsKey : prefix + metadata.name, m_values.at(i));
   }
 }
 
@@ -236,12 +304,8 @@ QJsonObject ModelSettings::toJson() const
 {
   QJsonObject obj;
 
-  for (auto it = m_values.constBegin(); it != m_values.constEnd(); ++it) {
-    const QString& fieldName = it.key();
-    if (m_fieldsMetadata.contains(fieldName)) {
-      const FieldMetadata& metadata = m_fieldsMetadata[fieldName];
-      obj[metadata.jsonKey] = QJsonValue::fromVariant(it.value());
-    }
+  for (int i = 0; i < m_fields.size(); ++i) {
+    obj[m_fields.at(i).jsonKey] = QJsonValue::fromVariant(m_values.at(i));
   }
 
   return obj;
@@ -249,71 +313,39 @@ QJsonObject ModelSettings::toJson() const
 
 void ModelSettings::fromJson(const QJsonObject& obj)
 {
-  for (auto it = m_fieldsMetadata.begin(); it != m_fieldsMetadata.end(); ++it) {
-    const QString& fieldName = it.key();
-    const FieldMetadata& metadata = it.value();
-
-    if (obj.contains(metadata.jsonKey)) {
-      QJsonValue val = obj[metadata.jsonKey];
-      QVariant variant;
-
-      if (metadata.cppType == "bool") {
-        if (val.isBool()) {
-          variant = val.toBool();
-        } else if (val.isString()) {
-          QString str = val.toString().toLower();
-          variant = (str == "true" || str == "1" || str == "yes" || str == "да");
-        } else if (val.isDouble()) {
-          variant = val.toInt() != 0;
-        } else {
-          variant = false;
-        }
-      } else if (metadata.cppType == "int") {
-        if (val.isDouble()) {
-          variant = val.toInt();
-        } else if (val.isString()) {
-          variant = val.toString().toInt();
-        } else {
-          variant = 0;
-        }
-      } else if (metadata.cppType == "double") {
-        if (val.isDouble()) {
-          variant = val.toDouble();
-        } else if (val.isString()) {
-          variant = val.toString().replace(',', '.').toDouble();
-        } else {
-          variant = 0.0;
-        }
-      } else {
-        if (val.isNull() || val.isUndefined()) {
-          variant = QString();
-        } else if (val.isString()) {
-          variant = val.toString();
-        } else {
-          variant = val.toVariant();
-        }
-      }
+  for (auto it = obj.constBegin(); it != obj.constEnd(); ++it) {
+    const auto index = m_jsonKeyIndex.constFind(it.key());
+    if (index == m_jsonKeyIndex.constEnd()) continue;
 
-      m_values[fieldName] = variant;
-      setProperty(fieldName.toLatin1().constData(), variant);
-    }
+    m_values[index.value()] = m_fields.at(index.value()).fromJson(it.value());
   }
 }
 
 void ModelSettings::debugPrint() const
 {
   qDebug() << "=== " << m_modelName << " Settings (Dynamic) ===";
-  for (auto it = m_values.constBegin(); it != m_values.constEnd(); ++it) {
-    qDebug() << it.key() << "=" << it.value();
+  for (int i = 0; i < m_fields.size(); ++i) {
+    qDebug() << m_fields.at(i).name << "=" << m_values.at(i);
   }
 }
 
 QVariant ModelSettings::getValue(const QString& name) const
 {
-  return property(name.toLatin1().constData());
+  const int index = m_fieldIndex.value(name, -1);
+  return index < 0 ? QVariant() : m_values.at(index);
 }
 
 void ModelSettings::setValue(const QString& name, const QVariant& value)
+{
+  const int index = m_fieldIndex.value(name, -1);
+  if (index < 0) {
+    qWarning() << "Unknown setting" << name << "for model" << m_modelName;
+    return;
+  }
+  setValueAt(index, value);
+}
+
+void ModelSettings::setValueAt(int index, const QVariant& value)
 {
   QVariant newValue = value;
 
@@ -323,34 +355,35 @@ void ModelSettings::setValue(const QString& name, const QVariant& value)
     newValue = value.toDateTime().date().toString(Qt::ISODate);
   }
 
-  QVariant oldValue = property(name.toLatin1().constData());
-
-  if (oldValue != newValue) {
-    setProperty(name.toLatin1().constData(), newValue);
-    m_values[name] = newValue;
-    emit propertyChanged(name, newValue);
+  if (m_values.at(index) != newValue) {
+    m_values[index] = newValue;
+    emit propertyChanged(m_fields.at(index).name, newValue);
   }
 }
 
 QStringList ModelSettings::getPropertyNames() const
 {
-  return m_values.keys();
+  QStringList names;
+  names.reserve(m_fields.size());
+  for (const FieldMetadata& metadata : m_fields) names.append(metadata.name);
+  return names;
 }
 
 QVariantMap ModelSettings::getFieldMetadata(const QString& fieldName) const
 {
-  if (!m_fieldsMetadata.contains(fieldName)) {
+  const int index = m_fieldIndex.value(fieldName, -1);
+  if (index < 0) {
     return QVariantMap();
   }
 
-  return m_fieldsMetadata[fieldName].toVariantMap();
+  return m_fields.at(index).toVariantMap();
 }
 
 QVariantList ModelSettings::getFieldsMetadata() const
 {
   QVariantList result;
-  for (auto it = m_fieldsMetadata.constBegin(); it != m_fieldsMetadata.constEnd(); ++it) {
-    result.append(it.value().toVariantMap());
+  for (const FieldMetadata& metadata : m_fields) {
+    result.append(metadata.toVariantMap());
   }
   return result;
 }
@@ -4,11 +4,13 @@
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QHash>
 #include <QMap>
 #include <QQmlEngine>
-#include <QSettings>
 #include <QVector>
 
+#include "settingsstore.h"
+
 class ModelSettings : public QObject
 {
   Q_OBJECT
@@ -26,8 +28,10 @@ public:
   ~ModelSettings() = default;
 
   bool loadConfiguration(const QString& jsonPath);
-  void loadFromSettings(QSettings& settings, const QString& currentModel, const QString& prefix = "");
-  void saveToSettings(QSettings& settings, const QString& prefix = "") const;
+  // Same as above for a models.json tree that is already parsed
+  bool loadConfiguration(const QJsonObject& root);
+  void loadFromSettings(SettingsStore& settings, const QString& currentModel, const QString& prefix = "");
+  void saveToSettings(SettingsStore& settings, const QString& prefix = "") const;
   QJsonObject toJson() const;
   void fromJson(const QJsonObject& obj);
   void debugPrint() const;
@@ -36,6 +40,8 @@ public:
   Q_INVOKABLE void setValue(const QString& name, const QVariant& value);
   Q_INVOKABLE QStringList getPropertyNames() const;
 
+  enum class ValueType { String, Bool, Int, Double };
+
   struct FieldMetadata {
     QString name;
     QString label;
@@ -47,6 +53,13 @@ public:
     bool visibleInInitialMode;
     QString checkboxText;
 
+    // Resolved once from cppType when the configuration is loaded
+    ValueType valueType = ValueType::String;
+    QVariant (*fromSetting)(const QVariant& value) = nullptr;
+    QVariant (*fromJson)(const QJsonValue& value) = nullptr;
+    // "<model>/<name>", the default key in SettingsStore
+    QString settingsKey;
+
     QVariantMap toVariantMap() const;
   };
 
@@ -69,8 +82,9 @@ signals:
 
 private:
   void createPropertiesFromConfig(const QJsonObject& config);
-  void registerDynamicProperty(const QString& name, const QVariant& defaultValue);
   void parseModelMetadata(const QJsonObject& config);
+  void setValueAt(int index, const QVariant& value);
+  static ValueType valueTypeOf(const QString& cppType);
 
   QString m_modelName;
   QString m_modelTitle;
@@ -78,8 +92,10 @@ private:
   QString m_modelInstallerPath;
 
   QList<Section> m_sections;
-  QMap<QString, FieldMetadata> m_fieldsMetadata;
-  QMap<QString, QVariant> m_values;
 
-  static int s_propertyCounter;
+  // Field table sorted by name; m_values holds the value of m_fields[i] at index i
+  QList<FieldMetadata> m_fields;
+  QList<QVariant> m_values;
+  QHash<QString, int> m_fieldIndex;
+  QHash<QString, int> m_jsonKeyIndex;
 };
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include <QMetaProperty>
 
 #include "../file/loger.h"
+#include "modelsconfigcache.h"
 
 
 namespace
@@ -21,31 +22,119 @@ const QHash<QString, QString>& specialCamelToSnake()
   return map;
 }
 
-const QHash<QString, QString>& specialSnakeToCamel()
-{
-  static QHash<QString, QString> rev;
-  if (rev.isEmpty()) {
-    const QHash<QString, QString>& fwd = specialCamelToSnake();
-    for (auto it = fwd.constBegin(); it != fwd.constEnd(); ++it) {
-      rev.insert(it.value(), it.key());
-    }
-  }
-  return rev;
-}
-
 bool stringToBool(const QString& s)
 {
   QString t = s.trimmed().toLower();
   return (t == QLatin1String("true") || t == QLatin1String("1") || t == QLatin1String("yes") ||
           t == QLatin1String("да") || t == QLatin1String("y"));
 }
+
+QVariant dateFromJson(const QJsonValue& val)
+{
+  if (!val.isString()) return QString();
+
+  const QString s = val.toString().trimmed();
+  if (s.isEmpty()) return QString();
+
+  const QDate d = QDate::fromString(s, Qt::ISODate);
+  return d.isValid() ? d.toString(Qt::ISODate) : s;
+}
+
+QVariant boolFromJson(const QJsonValue& val)
+{
+  if (val.isBool()) return val.toBool();
+  if (val.isString()) return stringToBool(val.toString());
+  if (val.isDouble()) return val.toInt() != 0;
+  return false;
+}
+
+QVariant doubleFromJson(const QJsonValue& val)
+{
+  if (val.isDouble()) return val.toDouble();
+  if (val.isString()) {
+    QString s = val.toString().trimmed();
+    s.replace(',', '.');
+    return s.isEmpty() ? 0.0 : s.toDouble();
+  }
+  if (val.isBool()) return val.toBool() ? 1.0 : 0.0;
+  return QVariant();
+}
+
+QVariant intFromJson(const QJsonValue& val)
+{
+  if (val.isDouble()) return val.toInt();
+  if (val.isString()) return val.toString().toInt();
+  if (val.isBool()) return val.toBool() ? 1 : 0;
+  return QVariant();
+}
+
+QVariant valueFromJson(const QJsonValue& val)
+{
+  if (val.isNull() || val.isUndefined()) return QString();
+  if (val.isString()) return val.toString();
+  return val.toVariant();
+}
+
+// A SettingsManager property with everything serialization needs, resolved once
+struct CommonField {
+  QMetaProperty property;
+  QString name;
+  // Key used by the server, empty when the setting is not sent there
+  QString jsonKey;
+  bool isDate = false;
+  QVariant (*fromJson)(const QJsonValue& val) = valueFromJson;
+};
+
+const QList<CommonField>& commonFields()
+{
+  static const QList<CommonField> fields = []() {
+    QList<CommonField> result;
+    const QMetaObject& meta = SettingsManager::staticMetaObject;
+    for (int i = meta.propertyOffset(); i < meta.propertyCount(); ++i) {
+      CommonField field;
+      field.property = meta.property(i);
+      field.name = QString::fromLatin1(field.property.name());
+      field.jsonKey = specialCamelToSnake().value(field.name);
+
+      switch (field.property.metaType().id()) {
+        case QMetaType::QDate:
+          field.isDate = true;
+          field.fromJson = dateFromJson;
+          break;
+        case QMetaType::Bool: field.fromJson = boolFromJson; break;
+        case QMetaType::Double: field.fromJson = doubleFromJson; break;
+        case QMetaType::Int: field.fromJson = intFromJson; break;
+        default: break;
+      }
+      result.append(field);
+    }
+    return result;
+  }();
+  return fields;
+}
+
+// Incoming JSON may use either the server key or the property name
+const QHash<QString, int>& commonFieldsByKey()
+{
+  static const QHash<QString, int> index = []() {
+    QHash<QString, int> result;
+    const QList<CommonField>& fields = commonFields();
+    for (int i = 0; i < fields.size(); ++i) {
+      result.insert(fields.at(i).name, i);
+      if (!fields.at(i).jsonKey.isEmpty()) result.insert(fields.at(i).jsonKey, i);
+    }
+    return result;
+  }();
+  return index;
+}
 } // namespace
 SettingsManager::SettingsManager(QObject* parent)
     : QObject(parent)
-    , m_settings("technovotum", "ManualApp")
+    , m_settings(SettingsStore::instance())
 {
   initializeModels();
   loadAllSettings();
+  connect(&m_settings, &SettingsStore::valueChanged, this, &SettingsManager::onStoredValueChanged);
 }
 
 SettingsManager::~SettingsManager()
@@ -80,7 +169,7 @@ void SettingsManager::initializeModels()
   for (const QString& modelName : modelNames) {
     ModelSettings* settings = new ModelSettings(modelName, this);
 
-    if (!settings->loadConfiguration(configPath)) {
+    if (!settings->loadConfiguration(rootObj)) {
       qWarning() << "Failed to load configuration for model:" << modelName;
     } else {
       m_models[modelName] = settings;
@@ -90,24 +179,30 @@ void SettingsManager::initializeModels()
 
 QJsonObject SettingsManager::readJsonFile(const QString& filePath)
 {
-  QFile file(filePath);
-  if (!file.open(QIODevice::ReadOnly)) {
-    qWarning() << "Cannot open file:" << filePath;
-    return QJsonObject();
-  }
-
-  QByteArray jsonData = file.readAll();
-  file.close();
-
-  QJsonParseError parseError;
-  QJsonDocument jsonDoc = QJsonDocument::fromJson(jsonData, &parseError);
+  return ModelsConfigCache::root(filePath);
+}
 
-  if (parseError.error != QJsonParseError::NoError) {
-    qWarning() << "JSON parse error:" << parseError.errorString();
-    return QJsonObject();
-  }
+SettingsManager* SettingsManager::instance()
+{
+  // Owned by the application object, which outlives every QML engine
+  static SettingsManager* settings = []() {
+    auto* manager = new SettingsManager();
+    if (QCoreApplication* app = QCoreApplication::instance()) {
+      manager->moveToThread(app->thread());
+      manager->setParent(app);
+    }
+    return manager;
+  }();
+  return settings;
+}
 
-  return jsonDoc.object();
+SettingsManager* SettingsManager::create(QQmlEngine* qmlEngine, QJSEngine* jsEngine)
+{
+  Q_UNUSED(qmlEngine)
+  Q_UNUSED(jsEngine)
+  SettingsManager* settings = instance();
+  QJSEngine::setObjectOwnership(settings, QJSEngine::CppOwnership);
+  return settings;
 }
 
 ModelSettings* SettingsManager::getModelSettings(const QString& modelName) const
@@ -122,7 +217,7 @@ void SettingsManager::completeFirstRun()
 {
   DEBUG_COLORED("SettingsManager", "completeFirstRun", "Initial setup completed - first run flag cleared",
                 COLOR_GREEN, COLOR_GREEN);
-  m_settings.setValue("isFirstRun", false);
+  setisFirstRun(false);
   updateLastManualAppDate();
 }
 
@@ -141,22 +236,19 @@ void SettingsManager::saveAllSettings()
   DEBUG_COLORED("SettingsManager", "saveAllSettings", "Saving all settings to persistent storage",
                 COLOR_GREEN, COLOR_GREEN);
 
-  const QMetaObject* meta = this->metaObject();
-  for (int i = meta->propertyOffset(); i < meta->propertyCount(); ++i) {
-    QMetaProperty prop = meta->property(i);
-    if (!prop.isReadable()) continue;
+  for (const CommonField& field : commonFields()) {
+    if (!field.property.isReadable()) continue;
 
-    QVariant value = prop.read(this);
-    if (value.metaType().id() == QMetaType::QDate) {
-      m_settings.setValue(prop.name(), value.toDate().toString(Qt::ISODate));
+    const QVariant value = field.property.read(this);
+    if (field.isDate) {
+      m_settings.setValue(field.name, value.toDate().toString(Qt::ISODate));
     } else {
-      m_settings.setValue(prop.name(), value);
+      m_settings.setValue(field.name, value);
     }
   }
 
+  // Persisted in one batch by SettingsStore
   saveModelSettings();
-
-  m_settings.sync();
 }
 
 void SettingsManager::loadAllSettings()
@@ -164,21 +256,7 @@ void SettingsManager::loadAllSettings()
   DEBUG_COLORED("SettingsManager", "loadAllSettings", "Loading all settings from persistent storage",
                 COLOR_GREEN, COLOR_GREEN);
 
-  const QMetaObject* meta = this->metaObject();
-  for (int i = meta->propertyOffset(); i < meta->propertyCount(); ++i) {
-    QMetaProperty prop = meta->property(i);
-    if (!prop.isWritable()) continue;
-
-    if (!m_settings.contains(prop.name())) continue;
-
-    QVariant val = m_settings.value(prop.name());
-    if (prop.metaType().id() == QMetaType::QDate) {
-      QDate date = QDate::fromString(val.toString(), Qt::ISODate);
-      prop.write(this, date);
-    } else {
-      prop.write(this, val);
-    }
-  }
+  for (int i = 0; i < commonFields().size(); ++i) loadCommonSetting(i);
 
   for (auto it = m_models.begin(); it != m_models.end(); ++it) {
     it.value()->loadFromSettings(m_settings, currentModel());
@@ -190,11 +268,8 @@ void SettingsManager::loadAllSettings()
 void SettingsManager::debugPrint() const
 {
   qDebug() << "=== Common Settings ===";
-  const QMetaObject* meta = this->metaObject();
-  for (int i = meta->propertyOffset(); i < meta->propertyCount(); ++i) {
-    QMetaProperty prop = meta->property(i);
-    QVariant value = prop.read(this);
-    qDebug() << prop.name() << "=" << value;
+  for (const CommonField& field : commonFields()) {
+    qDebug() << field.name << "=" << field.property.read(this);
   }
 
   if (m_models.contains(currentModel())) {
@@ -205,32 +280,15 @@ void SettingsManager::debugPrint() const
 QJsonObject SettingsManager::toJsonForDjango() const
 {
   QJsonObject obj;
-  const QMetaObject* meta = this->metaObject();
-  const QHash<QString, QString>& special = specialCamelToSnake();
-
-  for (int i = meta->propertyOffset(); i < meta->propertyCount(); ++i) {
-    QMetaProperty prop = meta->property(i);
-    if (!prop.isReadable()) continue;
-
-    QVariant value = prop.read(this);
-    const int type = value.userType();
-
-    QString originalName = QString::fromLatin1(prop.name());
-    QString outKey;
-    if (special.contains(originalName)) {
-      outKey = special.value(originalName);
-    } else {
-      continue;
-    }
+  for (const CommonField& field : commonFields()) {
+    if (field.jsonKey.isEmpty() || !field.property.isReadable()) continue;
 
-    if (type == QMetaType::QDate) {
-      QDate date = value.toDate();
-      if (date.isValid())
-        obj[outKey] = date.toString(Qt::ISODate);
-      else
-        obj[outKey] = QString();
+    const QVariant value = field.property.read(this);
+    if (field.isDate) {
+      const QDate date = value.toDate();
+      obj[field.jsonKey] = date.isValid() ? date.toString(Qt::ISODate) : QString();
     } else {
-      obj[outKey] = QJsonValue::fromVariant(value);
+      obj[field.jsonKey] = QJsonValue::fromVariant(value);
     }
   }
 
@@ -248,82 +306,17 @@ void SettingsManager::fromJson(const QJsonObject& obj)
 {
   DEBUG_COLORED("SettingsManager", "fromJson", "Loading settings from JSON object", COLOR_GREEN, COLOR_GREEN);
 
-  const QMetaObject* meta = this->metaObject();
-  const QHash<QString, QString>& specialRev = specialSnakeToCamel();
+  const QList<CommonField>& fields = commonFields();
+  const QHash<QString, int>& fieldsByKey = commonFieldsByKey();
 
   for (auto it = obj.constBegin(); it != obj.constEnd(); ++it) {
-    const QString key = it.key();
-    const QJsonValue val = it.value();
-
-    QString propName = specialRev.contains(key) ? specialRev.value(key) : key;
-    if (propName.isEmpty()) {
-      continue;
-    }
-
-    int propIndex = meta->indexOfProperty(propName.toLatin1().constData());
-    if (propIndex < 0) {
-      continue;
-    }
-
-    QMetaProperty prop = meta->property(propIndex);
-    QString settingsKey = QString::fromLatin1(prop.name());
-    QVariant writeVal;
-
-    if (prop.metaType().id() == QMetaType::QDate) {
-      if (val.isString()) {
-        QString s = val.toString().trimmed();
-        if (s.isEmpty()) {
-          writeVal = QString();
-        } else {
-          QDate d = QDate::fromString(s, Qt::ISODate);
-          if (d.isValid())
-            writeVal = d.toString(Qt::ISODate);
-          else
-            writeVal = s;
-        }
-      } else {
-        writeVal = QString();
-      }
-    } else if (prop.metaType().id() == QMetaType::Bool) {
-      if (val.isBool())
-        writeVal = val.toBool();
-      else if (val.isString())
-        writeVal = stringToBool(val.toString());
-      else if (val.isDouble())
-        writeVal = (val.toInt() != 0);
-      else
-        writeVal = false;
-    } else if (prop.metaType().id() == QMetaType::Double) {
-      if (val.isDouble())
-        writeVal = val.toDouble();
-      else if (val.isString()) {
-        QString s = val.toString().trimmed();
-        s.replace(',', '.');
-        writeVal = s.isEmpty() ? 0.0 : s.toDouble();
-      } else if (val.isBool())
-        writeVal = val.toBool() ? 1.0 : 0.0;
-      else
-        writeVal = QVariant();
-    } else if (prop.metaType().id() == QMetaType::Int) {
-      if (val.isDouble())
-        writeVal = val.toInt();
-      else if (val.isString())
-        writeVal = val.toString().toInt();
-      else if (val.isBool())
-        writeVal = val.toBool() ? 1 : 0;
-      else
-        writeVal = QVariant();
-    } else {
-      if (val.isNull() || val.isUndefined())
-        writeVal = QString();
-      else if (val.isString())
-        writeVal = val.toString();
-      else
-        writeVal = val.toVariant();
-    }
+    const auto index = fieldsByKey.constFind(it.key());
+    if (index == fieldsByKey.constEnd()) continue;
 
+    const CommonField& field = fields.at(index.value());
+    const QVariant writeVal = field.fromJson(it.value());
     if (writeVal.isValid()) {
-      m_settings.setValue(settingsKey, writeVal);
+      m_settings.setValue(field.name, writeVal);
     }
   }
 
@@ -336,11 +329,37 @@ void SettingsManager::fromJson(const QJsonObject& obj)
     m_models[modelToUse]->saveToSettings(m_settings);
   }
 
-  m_settings.sync();
+  // Reads back from SettingsStore's memory, nothing waits on the disk here
   loadAllSettings();
 }
 
 
+void SettingsManager::loadCommonSetting(int fieldIndex)
+{
+  const CommonField& field = commonFields().at(fieldIndex);
+  if (!field.property.isWritable()) return;
+
+  const QVariant val = m_settings.value(field.name);
+  if (!val.isValid()) return;
+
+  // The value already is in the store, the setter only has to update the member and notify
+  m_loadingSnapshot = true;
+  if (field.isDate) {
+    field.property.write(this, QDate::fromString(val.toString(), Qt::ISODate));
+  } else {
+    field.property.write(this, val);
+  }
+  m_loadingSnapshot = false;
+}
+
+void SettingsManager::onStoredValueChanged(const QString& key)
+{
+  const auto index = commonFieldsByKey().constFind(key);
+  if (index == commonFieldsByKey().constEnd() || commonFields().at(index.value()).name != key) return;
+
+  loadCommonSetting(index.value());
+}
+
 void SettingsManager::saveDateIso(const QString& key, const QString& dateStr)
 {
   if (key.isEmpty()) return;
@@ -7,22 +7,27 @@
 #include <QMap>
 #include <QObject>
 #include <QQmlEngine>
-#include <QSettings>
 
 #include "modelsettings.h"
+#include "settingsstore.h"
 
 
+// Common settings are kept as typed members loaded from SettingsStore, so getters are plain reads.
+// Setters write through to the store; loadAllSettings() and changes made elsewhere refresh the members.
 #define DEFINE_SETTING(Type, Name, Default)                                                                  \
   Q_PROPERTY(Type Name READ Name WRITE set##Name NOTIFY Name##Changed)                                       \
+private:                                                                                                     \
+  Type m_##Name = Default;                                                                                   \
 public:                                                                                                      \
   [[nodiscard]] Type Name() const                                                                            \
   {                                                                                                          \
-    return m_settings.value(#Name, Default).value<Type>();                                                   \
+    return m_##Name;                                                                                         \
   }                                                                                                          \
   void set##Name(const Type& value)                                                                          \
   {                                                                                                          \
-    if (value != Name()) {                                                                                   \
-      m_settings.setValue(#Name, value);                                                                     \
+    if (value != m_##Name) {                                                                                 \
+      m_##Name = value;                                                                                      \
+      if (!m_loadingSnapshot) m_settings.setValue(#Name, value);                                             \
       emit Name##Changed();                                                                                  \
     }                                                                                                        \
   }                                                                                                          \
@@ -30,15 +35,18 @@ public:
 
 #define DEFINE_DATE_SETTING(Name)                                                                            \
   Q_PROPERTY(QDate Name READ Name WRITE set##Name NOTIFY Name##Changed)                                      \
+private:                                                                                                     \
+  QDate m_##Name;                                                                                            \
 public:                                                                                                      \
   [[nodiscard]] QDate Name() const                                                                           \
   {                                                                                                          \
-    return QDate::fromString(m_settings.value(#Name).toString(), Qt::ISODate);                               \
+    return m_##Name;                                                                                         \
   }                                                                                                          \
   void set##Name(const QDate& value)                                                                         \
   {                                                                                                          \
-    if (value != Name()) {                                                                                   \
-      m_settings.setValue(#Name, value.toString(Qt::ISODate));                                               \
+    if (value != m_##Name) {                                                                                 \
+      m_##Name = value;                                                                                      \
+      if (!m_loadingSnapshot) m_settings.setValue(#Name, value.toString(Qt::ISODate));                       \
       emit Name##Changed();                                                                                  \
     }                                                                                                        \
   }                                                                                                          \
@@ -67,6 +75,10 @@ public:
   explicit SettingsManager(QObject* parent = nullptr);
   ~SettingsManager();
 
+  // The one instance used by C++ code and, through create(), by QML
+  static SettingsManager* instance();
+  static SettingsManager* create(QQmlEngine* qmlEngine, QJSEngine* jsEngine);
+
   Q_INVOKABLE ModelSettings* getModelSettings(const QString& modelName = QString()) const;
   Q_INVOKABLE QStringList availableModels() const { return m_models.keys(); }
 
@@ -85,6 +97,7 @@ public:
   Q_INVOKABLE void saveDateIso(const QString& key, const QString& dateStr);
 
   [[nodiscard]] QJsonObject toJsonForDjango() const;
+  // Served from ModelsConfigCache, the file is parsed once per modification
   QJsonObject readJsonFile(const QString& filePath);
   void fromJson(const QJsonObject& obj);
 
@@ -94,9 +107,13 @@ signals:
 
 private:
   void initializeModels();
+  // Reads one common setting from the store into its member without writing it back
+  void loadCommonSetting(int fieldIndex);
+  void onStoredValueChanged(const QString& key);
 
 private:
-  QSettings m_settings;
+  SettingsStore& m_settings;
+  bool m_loadingSnapshot = false;
   QMap<QString, ModelSettings*> m_models;
   QString m_configPath;
 };
\ No newline at end of file
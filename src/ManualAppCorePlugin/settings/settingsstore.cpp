@@ -0,0 +1,245 @@
+#include "settingsstore.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QMutexLocker>
+#include <QSettings>
+
+#include "../file/loger.h"
+
+
+namespace
+{
+
+// File formats hand every value back as a string, so a bool written here reads back as "true"
+bool sameStoredValue(const QVariant& local, const QVariant& stored)
+{
+  if (local == stored) return true;
+  return stored.typeId() == QMetaType::QString && local.canConvert<QString>() &&
+         local.toString() == stored.toString();
+}
+
+// The Windows registry has no file to watch
+bool isFileBased(const QSettings& settings)
+{
+#ifdef Q_OS_WIN
+  return settings.format() != QSettings::NativeFormat;
+#else
+  Q_UNUSED(settings)
+  return true;
+#endif
+}
+
+} // namespace
+
+SettingsStore::SettingsStore(const QString& organization, const QString& application, QObject* parent)
+    : QObject(parent)
+    , m_organization(organization)
+    , m_application(application)
+{
+  QSettings settings(m_organization, m_application);
+  for (const QString& key : settings.allKeys()) m_values.insert(key, settings.value(key));
+
+  // Editors usually replace the file, so it is re-added after every change. The directory is watched
+  // as well: on a first run the file only appears with the first write, and a replaced file may be
+  // missing for a moment when fileChanged arrives.
+  if (isFileBased(settings)) {
+    const QString filePath = settings.fileName();
+    const QString dirPath = QFileInfo(filePath).absolutePath();
+    QDir().mkpath(dirPath);
+
+    m_watcher = new QFileSystemWatcher(this);
+    m_watcher->addPath(dirPath);
+    if (QFileInfo::exists(filePath)) m_watcher->addPath(filePath);
+    m_reloadTimer.setSingleShot(true);
+    m_reloadTimer.setInterval(FlushDelayMs);
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, [this](const QString& path) {
+      if (!m_watcher->files().contains(path) && QFileInfo::exists(path)) m_watcher->addPath(path);
+      m_reloadTimer.start();
+    });
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, this, [this, filePath]() {
+      if (m_watcher->files().contains(filePath) || !QFileInfo::exists(filePath)) return;
+      m_watcher->addPath(filePath);
+      m_reloadTimer.start();
+    });
+    connect(&m_reloadTimer, &QTimer::timeout, this, &SettingsStore::reload);
+  }
+
+  m_writer.setMaxThreadCount(1);
+  m_flushTimer.setSingleShot(true);
+  m_flushTimer.setInterval(FlushDelayMs);
+  connect(&m_flushTimer, &QTimer::timeout, this, [this]() { m_writer.start([this]() { writePending(); }); });
+}
+
+SettingsStore::~SettingsStore()
+{
+  flush();
+}
+
+SettingsStore& SettingsStore::instance()
+{
+  static SettingsStore* store = []() {
+    auto* settingsStore = new SettingsStore("technovotum", "ManualApp");
+    if (QCoreApplication* app = QCoreApplication::instance()) {
+      settingsStore->moveToThread(app->thread());
+      settingsStore->setParent(app);
+      connect(app, &QCoreApplication::aboutToQuit, settingsStore, &SettingsStore::flush);
+    }
+    return settingsStore;
+  }();
+  return *store;
+}
+
+QVariant SettingsStore::value(const QString& key, const QVariant& defaultValue) const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_values.value(key, defaultValue);
+}
+
+bool SettingsStore::contains(const QString& key) const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_values.contains(key);
+}
+
+QStringList SettingsStore::childKeys(const QString& group) const
+{
+  const QString prefix = group.endsWith('/') ? group : group + '/';
+
+  QMutexLocker locker(&m_mutex);
+  QStringList keys;
+  for (auto it = m_values.constBegin(); it != m_values.constEnd(); ++it) {
+    if (it.key().startsWith(prefix) && !it.key().mid(prefix.size()).contains('/'))
+      keys.append(it.key().mid(prefix.size()));
+  }
+  return keys;
+}
+
+void SettingsStore::setValue(const QString& key, const QVariant& value)
+{
+  {
+    QMutexLocker locker(&m_mutex);
+    const auto current = m_values.constFind(key);
+    if (current != m_values.constEnd() && current.value() == value) return;
+    m_values.insert(key, value);
+  }
+  markDirty(key, value);
+  emit valueChanged(key);
+}
+
+void SettingsStore::remove(const QString& key)
+{
+  {
+    QMutexLocker locker(&m_mutex);
+    if (m_values.remove(key) == 0) return;
+  }
+  markDirty(key, std::nullopt);
+  emit valueChanged(key);
+}
+
+void SettingsStore::reload()
+{
+  // A batch being written has already left m_dirty; waiting for it keeps the file from undoing it
+  QMutexLocker writeLocker(&m_writeMutex);
+
+  QSettings settings(m_organization, m_application);
+  QHash<QString, QVariant> stored;
+  for (const QString& key : settings.allKeys()) stored.insert(key, settings.value(key));
+
+  QStringList changed;
+  {
+    QMutexLocker locker(&m_mutex);
+    for (auto it = stored.constBegin(); it != stored.constEnd(); ++it) {
+      if (m_dirty.contains(it.key())) continue;
+      const auto current = m_values.constFind(it.key());
+      if (current != m_values.constEnd() && sameStoredValue(current.value(), it.value())) continue;
+      m_values.insert(it.key(), it.value());
+      changed.append(it.key());
+    }
+    for (auto it = m_values.begin(); it != m_values.end();) {
+      if (!stored.contains(it.key()) && !m_dirty.contains(it.key())) {
+        changed.append(it.key());
+        it = m_values.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    if (!changed.isEmpty()) m_generation.fetch_add(1, std::memory_order_release);
+  }
+
+  writeLocker.unlock();
+  for (const QString& key : std::as_const(changed)) emit valueChanged(key);
+}
+
+bool SettingsStore::hasPendingChanges() const
+{
+  QMutexLocker locker(&m_mutex);
+  return !m_dirty.isEmpty();
+}
+
+void SettingsStore::flush()
+{
+  m_flushTimer.stop();
+  m_writer.waitForDone();
+  writePending();
+}
+
+void SettingsStore::markDirty(const QString& key, const std::optional<QVariant>& value)
+{
+  {
+    QMutexLocker locker(&m_mutex);
+    if (m_dirty.isEmpty()) m_dirtySince = QDateTime::currentMSecsSinceEpoch();
+    m_dirty.insert(key, value);
+    m_generation.fetch_add(1, std::memory_order_release);
+  }
+  // Timers belong to the store's thread
+  QMetaObject::invokeMethod(this, [this]() { scheduleFlush(); }, Qt::AutoConnection);
+}
+
+void SettingsStore::scheduleFlush()
+{
+  qint64 pendingFor = 0;
+  {
+    QMutexLocker locker(&m_mutex);
+    if (m_dirty.isEmpty()) return;
+    pendingFor = QDateTime::currentMSecsSinceEpoch() - m_dirtySince;
+  }
+
+  // Every change restarts the debounce, but a steady stream of changes still gets written
+  m_flushTimer.start(qBound<qint64>(0, MaxFlushDelayMs - pendingFor, FlushDelayMs));
+}
+
+void SettingsStore::writePending()
+{
+  QMutexLocker writeLocker(&m_writeMutex);
+
+  QHash<QString, std::optional<QVariant>> dirty;
+  {
+    QMutexLocker locker(&m_mutex);
+    dirty.swap(m_dirty);
+  }
+  if (dirty.isEmpty()) return;
+
+  QSettings settings(m_organization, m_application);
+  for (auto it = dirty.constBegin(); it != dirty.constEnd(); ++it) {
+    if (it.value())
+      settings.setValue(it.key(), *it.value());
+    else
+      settings.remove(it.key());
+  }
+  settings.sync();
+
+  if (settings.status() != QSettings::NoError) {
+    DEBUG_ERROR_COLORED("SettingsStore", "writePending",
+                        QString("Failed to persist %1 settings, will retry").arg(dirty.size()), COLOR_GREEN,
+                        COLOR_GREEN);
+    // Changes made since the swap are newer and win
+    QMutexLocker locker(&m_mutex);
+    for (auto it = dirty.constBegin(); it != dirty.constEnd(); ++it)
+      if (!m_dirty.contains(it.key())) m_dirty.insert(it.key(), it.value());
+    QMetaObject::invokeMethod(this, [this]() { scheduleFlush(); }, Qt::QueuedConnection);
+  }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVariant>
+#include <atomic>
+#include <optional>
+
+class QFileSystemWatcher;
+
+// In-memory copy of the application's QSettings with write-behind persistence.
+// Reads and writes only touch memory. Changed keys are tracked and written in one batch on a
+// background thread once no change has arrived for FlushDelayMs, and at the latest MaxFlushDelayMs
+// after the first pending change. flush() writes synchronously and is called when the application
+// quits, so registry or flash storage sees one batch instead of a write per key.
+// Changes made by other processes are picked up by watching the settings file.
+class SettingsStore : public QObject
+{
+  Q_OBJECT
+public:
+  SettingsStore(const QString& organization, const QString& application, QObject* parent = nullptr);
+  ~SettingsStore() override;
+
+  // Store behind QSettings("technovotum", "ManualApp"), shared by every settings user
+  static SettingsStore& instance();
+
+  QVariant value(const QString& key, const QVariant& defaultValue = QVariant()) const;
+  bool contains(const QString& key) const;
+  // Direct children of a group, like QSettings::childKeys() inside beginGroup(group)
+  QStringList childKeys(const QString& group) const;
+
+  void setValue(const QString& key, const QVariant& value);
+  void remove(const QString& key);
+
+  // Writes all pending changes and syncs on the calling thread
+  void flush();
+  bool hasPendingChanges() const;
+
+  // Re-reads the backing store; keys with unwritten local changes keep their local value. Waits for a
+  // batch that is being written, its keys are no longer tracked as changed.
+  void reload();
+  // Incremented on every change, so callers can tell cheaply whether cached values are stale
+  quint64 generation() const { return m_generation.load(std::memory_order_acquire); }
+
+  static constexpr int FlushDelayMs = 500;
+  static constexpr int MaxFlushDelayMs = 5000;
+
+signals:
+  // Emitted on the thread that made the change, or the store's thread for reload()
+  void valueChanged(const QString& key);
+
+private:
+  void markDirty(const QString& key, const std::optional<QVariant>& value);
+  void scheduleFlush();
+  void writePending();
+
+private:
+  const QString m_organization;
+  const QString m_application;
+
+  mutable QMutex m_mutex;
+  QHash<QString, QVariant> m_values;
+  // Keys changed since the last write; nullopt marks a removal
+  QHash<QString, std::optional<QVariant>> m_dirty;
+  qint64 m_dirtySince = 0;
+  std::atomic<quint64> m_generation{0};
+
+  // Only for file-based formats; the Windows registry is not watched
+  QFileSystemWatcher* m_watcher = nullptr;
+  QTimer m_reloadTimer;
+
+  QTimer m_flushTimer;
+  // One thread, so batches reach QSettings in order
+  QThreadPool m_writer;
+  // Held while a batch is written and while reload() reads the backing store
+  QMutex m_writeMutex;
+};
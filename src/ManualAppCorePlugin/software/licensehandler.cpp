@@ -11,6 +11,8 @@
 
 #include <QBuffer>
 #include <QByteArray>
+#include <QCryptographicHash>
+#include <memory>
 #endif
 
 #include <QCoreApplication>
@@ -124,13 +126,98 @@ static EVP_PKEY* loadPublicKey()
 
   return key;
 }
+
+// Parsed once per process; verification only reads the key, so it is shared by every check
+static EVP_PKEY* publicKey()
+{
+  using KeyPtr = std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)>;
+  static const KeyPtr key(loadPublicKey(), &EVP_PKEY_free);
+  return key.get();
+}
+
+// Full check of a stored license key: payload, expiry and RSA signature.
+// On success expiry is set to the license's expiry day, or to a null date if it has none.
+static bool verifyLicenseKey(const QString& licenseKey, QDate& expiry)
+{
+  DEBUG_COLORED("LicenseHandler", "verifyLicense", "Starting license verification", COLOR_GREEN, COLOR_GREEN);
+
+  expiry = QDate();
+  if (licenseKey.isEmpty()) {
+    DEBUG_ERROR_COLORED("LicenseHandler", "verifyLicense", "No license key found in settings", COLOR_GREEN,
+                        COLOR_GREEN);
+    return false;
+  }
+
+  const QStringList parts = licenseKey.split('.');
+  if (parts.size() != 2) {
+    DEBUG_ERROR_COLORED("LicenseHandler", "verifyLicense",
+                        "Invalid license_key format - expected two parts separated by dot", COLOR_GREEN,
+                        COLOR_GREEN);
+    return false;
+  }
+
+  QByteArray canonicalRaw = lenientBase64Decode(parts[0].toLatin1());
+  QByteArray signatureRaw = lenientBase64Decode(parts[1].toLatin1());
+
+  if (canonicalRaw.isEmpty() || signatureRaw.isEmpty()) {
+    DEBUG_ERROR_COLORED("LicenseHandler", "verifyLicense", "Failed to decode license parts from base64",
+                        COLOR_GREEN, COLOR_GREEN);
+    return false;
+  }
+
+  QByteArray canonicalized = canonicalizeJson(canonicalRaw);
+  QJsonDocument doc = QJsonDocument::fromJson(canonicalized);
+  if (!doc.isObject()) {
+    DEBUG_ERROR_COLORED("LicenseHandler", "verifyLicense", "Invalid license payload JSON", COLOR_GREEN,
+                        COLOR_GREEN);
+    return false;
+  }
+
+  const QJsonObject payload = doc.object();
+  QStringList requiredFields = {"ver", "product", "company_name", "host_hwid", "exp"};
+  for (const QString& field : requiredFields) {
+    if (!payload.contains(field)) {
+      DEBUG_ERROR_COLORED("LicenseHandler", "verifyLicense", QString("Missing required field: %1").arg(field),
+                          COLOR_GREEN, COLOR_GREEN);
+      return false;
+    }
+  }
+
+  const QString expStr = payload.value("exp").toString();
+  const QDate expDate = QDate::fromString(expStr, Qt::ISODate);
+  if (expDate.isValid() && expDate < QDate::currentDate()) {
+    DEBUG_ERROR_COLORED("LicenseHandler", "verifyLicense", QString("License expired on %1").arg(expStr),
+                        COLOR_GREEN, COLOR_GREEN);
+    return false;
+  }
+
+  EVP_PKEY* pubkey = publicKey();
+  if (!pubkey) {
+    DEBUG_ERROR_COLORED("LicenseHandler", "verifyLicense", "Failed to load public key for verification",
+                        COLOR_GREEN, COLOR_GREEN);
+    return false;
+  }
+
+  const bool valid = verifySignatureSha256(pubkey, canonicalized, signatureRaw);
+
+  if (valid) {
+    DEBUG_COLORED("LicenseHandler", "verifyLicense", "License verification SUCCESS", COLOR_GREEN,
+                  COLOR_GREEN);
+    expiry = expDate;
+  } else {
+    DEBUG_ERROR_COLORED("LicenseHandler", "verifyLicense", "License verification FAILED - signature invalid",
+                        COLOR_GREEN, COLOR_GREEN);
+  }
+
+  return valid;
+}
 #endif
 
 } // namespace
 
 LicenseHandler::LicenseHandler(QObject* parent)
     : QObject(parent)
-    , m_settings("technovotum", "ManualApp")
+    , m_settings(SettingsStore::instance())
     , m_isLicenseActivate(false)
 {
   checkLicenseKeyOnStart();
@@ -140,9 +227,7 @@ LicenseHandler::~LicenseHandler() {}
 
 void LicenseHandler::checkLicenseKeyOnStart()
 {
-  m_settings.beginGroup("license");
-  QString licenseKey = m_settings.value("license_key").toString();
-  m_settings.endGroup();
+  QString licenseKey = m_settings.value("license/license_key").toString();
 
   if (!licenseKey.isEmpty()) {
     DEBUG_COLORED("LicenseHandler", "checkLicenseKeyOnStart", QString("Found license key on start"),
@@ -157,9 +242,7 @@ void LicenseHandler::checkLicenseKeyOnStart()
 
 void LicenseHandler::updateActivationStatusFromSettings()
 {
-  m_settings.beginGroup("license");
-  QString licenseKey = m_settings.value("license_key").toString();
-  m_settings.endGroup();
+  QString licenseKey = m_settings.value("license/license_key").toString();
 
   setIsLicenseActivate(!licenseKey.isEmpty());
 }
@@ -203,25 +286,24 @@ void LicenseHandler::saveLicense(const QJsonObject& license)
   DEBUG_COLORED("LicenseHandler", "saveLicense", "Saving license to persistent storage", COLOR_GREEN,
                 COLOR_GREEN);
 
-  m_settings.beginGroup("license");
-
   QString licenseKey = license.value("license_key").toString();
-  m_settings.setValue("license_key", licenseKey);
-  m_settings.setValue("signature", license.value("signature").toString());
+  m_settings.setValue("license/license_key", licenseKey);
+  m_settings.setValue("license/signature", license.value("signature").toString());
 
   QJsonObject payload = license.value("payload").toObject();
-  m_settings.setValue("ver", payload.value("ver").toString());
-  m_settings.setValue("product", payload.value("product").toString());
-  m_settings.setValue("company_name", payload.value("company_name").toString());
-  m_settings.setValue("host_hwid", payload.value("host_hwid").toString());
-  m_settings.setValue("device_hwid", payload.value("device_hwid").toString());
-  m_settings.setValue("exp", payload.value("exp").toString());
+  m_settings.setValue("license/ver", payload.value("ver").toString());
+  m_settings.setValue("license/product", payload.value("product").toString());
+  m_settings.setValue("license/company_name", payload.value("company_name").toString());
+  m_settings.setValue("license/host_hwid", payload.value("host_hwid").toString());
+  m_settings.setValue("license/device_hwid", payload.value("device_hwid").toString());
+  m_settings.setValue("license/exp", payload.value("exp").toString());
 
   QJsonObject features = payload.value("features").toObject();
-  m_settings.setValue("features", QJsonDocument(features).toJson(QJsonDocument::Compact));
+  m_settings.setValue("license/features", QJsonDocument(features).toJson(QJsonDocument::Compact));
 
-  m_settings.endGroup();
-  m_settings.sync();
+  // Activation must survive a crash, so it is not left to the write-behind timer
+  m_settings.flush();
+  m_verification = {};
 
   if (!licenseKey.isEmpty()) {
     setIsLicenseActivate(true);
@@ -251,12 +333,11 @@ void LicenseHandler::clearLicense()
   DEBUG_ERROR_COLORED("LicenseHandler", "clearLicense", "Clearing license from settings", COLOR_GREEN,
                       COLOR_GREEN);
 
-  m_settings.beginGroup("license");
-  for (const QString& k : m_settings.childKeys()) {
-    m_settings.remove(k);
+  for (const QString& k : m_settings.childKeys("license")) {
+    m_settings.remove("license/" + k);
   }
-  m_settings.endGroup();
-  m_settings.sync();
+  m_settings.flush();
+  m_verification = {};
 
   setIsLicenseActivate(false);
   emit licenseChanged();
@@ -264,108 +345,37 @@ void LicenseHandler::clearLicense()
 
 bool LicenseHandler::verifyLicense()
 {
-#ifdef Q_OS_LINUX
-  DEBUG_COLORED("LicenseHandler", "verifyLicense", "Starting license verification", COLOR_GREEN, COLOR_GREEN);
-
-  if (!hasLicense()) {
-    DEBUG_ERROR_COLORED("LicenseHandler", "verifyLicense", "No license found in settings", COLOR_GREEN,
-                        COLOR_GREEN);
-    setIsLicenseActivate(false);
-    emit licenseVerified(false);
-    return false;
-  }
-
-  const QString licenseKey = license().value("license_key").toString();
-  if (licenseKey.isEmpty()) {
-    DEBUG_ERROR_COLORED("LicenseHandler", "verifyLicense", "License key is empty", COLOR_GREEN, COLOR_GREEN);
-    setIsLicenseActivate(false);
-    emit licenseVerified(false);
-    return false;
-  }
-
-  const QStringList parts = licenseKey.split('.');
-  if (parts.size() != 2) {
-    DEBUG_ERROR_COLORED("LicenseHandler", "verifyLicense",
-                        "Invalid license_key format - expected two parts separated by dot", COLOR_GREEN,
-                        COLOR_GREEN);
-    setIsLicenseActivate(false);
-    emit licenseVerified(false);
-    return false;
-  }
-
-  QByteArray canonicalRaw = lenientBase64Decode(parts[0].toLatin1());
-  QByteArray signatureRaw = lenientBase64Decode(parts[1].toLatin1());
-
-  if (canonicalRaw.isEmpty() || signatureRaw.isEmpty()) {
-    DEBUG_ERROR_COLORED("LicenseHandler", "verifyLicense", "Failed to decode license parts from base64",
-                        COLOR_GREEN, COLOR_GREEN);
-    setIsLicenseActivate(false);
-    emit licenseVerified(false);
-    return false;
-  }
-
-  QByteArray canonicalized = canonicalizeJson(canonicalRaw);
-  QJsonDocument doc = QJsonDocument::fromJson(canonicalized);
-  if (!doc.isObject()) {
-    DEBUG_ERROR_COLORED("LicenseHandler", "verifyLicense", "Invalid license payload JSON", COLOR_GREEN,
-                        COLOR_GREEN);
-    setIsLicenseActivate(false);
-    emit licenseVerified(false);
-    return false;
-  }
-
-  const QJsonObject payload = doc.object();
-  QStringList requiredFields = {"ver", "product", "company_name", "host_hwid", "exp"};
-  for (const QString& field : requiredFields) {
-    if (!payload.contains(field)) {
-      DEBUG_ERROR_COLORED("LicenseHandler", "verifyLicense", QString("Missing required field: %1").arg(field),
-                          COLOR_GREEN, COLOR_GREEN);
-      setIsLicenseActivate(false);
-      emit licenseVerified(false);
-      return false;
-    }
-  }
-
-  const QString expStr = payload.value("exp").toString();
-  const QDate expDate = QDate::fromString(expStr, Qt::ISODate);
-  if (expDate.isValid() && expDate < QDate::currentDate()) {
-    DEBUG_ERROR_COLORED("LicenseHandler", "verifyLicense", QString("License expired on %1").arg(expStr),
-                        COLOR_GREEN, COLOR_GREEN);
-    setIsLicenseActivate(false);
-    emit licenseVerified(false);
-    return false;
-  }
-
-  EVP_PKEY* pubkey = loadPublicKey();
-  if (!pubkey) {
-    DEBUG_ERROR_COLORED("LicenseHandler", "verifyLicense", "Failed to load public key for verification",
-                        COLOR_GREEN, COLOR_GREEN);
-    setIsLicenseActivate(false);
-    emit licenseVerified(false);
-    return false;
-  }
-
-  const bool valid = verifySignatureSha256(pubkey, canonicalized, signatureRaw);
-  EVP_PKEY_free(pubkey);
+#ifndef Q_OS_LINUX
+  DEBUG_COLORED("LicenseHandler", "verifyLicense",
+                "License verification not supported on this platform, returning true", COLOR_GREEN,
+                COLOR_GREEN);
+#endif
+  const bool valid = isLicenseValid();
+  setIsLicenseActivate(valid);
+  emit licenseVerified(valid);
+  return valid;
+}
 
-  if (valid) {
-    DEBUG_COLORED("LicenseHandler", "verifyLicense", "License verification SUCCESS", COLOR_GREEN,
-                  COLOR_GREEN);
-    setIsLicenseActivate(true);
-  } else {
-    DEBUG_ERROR_COLORED("LicenseHandler", "verifyLicense", "License verification FAILED - signature invalid",
-                        COLOR_GREEN, COLOR_GREEN);
-    setIsLicenseActivate(false);
+bool LicenseHandler::isLicenseValid()
+{
+#ifdef Q_OS_LINUX
+  const QString licenseKey = m_settings.value("license/license_key").toString();
+  const QByteArray licenseHash = QCryptographicHash::hash(licenseKey.toUtf8(), QCryptographicHash::Sha256);
+  const QDate today = QDate::currentDate();
+
+  // Only a new license or a new day past the license's expiry can change the outcome
+  if (m_verification.checked && m_verification.licenseHash == licenseHash) {
+    if (m_verification.verifiedOn == today) return m_verification.valid;
+    if (m_verification.valid && (!m_verification.expiresOn.isValid() || today <= m_verification.expiresOn))
+      return true;
   }
 
-  emit licenseVerified(valid);
-  return valid;
+  m_verification.checked = true;
+  m_verification.licenseHash = licenseHash;
+  m_verification.verifiedOn = today;
+  m_verification.valid = verifyLicenseKey(licenseKey, m_verification.expiresOn);
+  return m_verification.valid;
 #else
-  DEBUG_COLORED("LicenseHandler", "verifyLicense",
-                "License verification not supported on this platform, returning true", COLOR_GREEN,
-                COLOR_GREEN);
-  setIsLicenseActivate(true);
-  emit licenseVerified(true);
   return true;
 #endif
 }
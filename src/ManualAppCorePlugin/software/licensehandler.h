@@ -3,7 +3,8 @@
 #include <QDate>
 #include <QJsonObject>
 #include <QObject>
-#include <QSettings>
+
+#include "../settings/settingsstore.h"
 
 class LicenseHandler : public QObject
 {
@@ -18,6 +19,8 @@ public:
   void saveLicense(const QJsonObject& license);
   void clearLicense();
   bool verifyLicense();
+  // Cached result of verifyLicense() without its signals, cheap enough for QML bindings
+  Q_INVOKABLE bool isLicenseValid();
   Q_INVOKABLE void licenseActivationSucceeded() { setIsLicenseActivate(true); }
   Q_INVOKABLE bool isLicenseActivate() const;
   void setIsLicenseActivate(bool value);
@@ -33,6 +36,17 @@ private:
   void updateActivationStatusFromSettings();
 
 private:
-  QSettings m_settings;
+  struct VerificationCache {
+    bool checked = false;
+    // SHA-256 of the stored license key the result belongs to
+    QByteArray licenseHash;
+    QDate verifiedOn;
+    // Valid results are reused until this day has passed, a null date never expires
+    QDate expiresOn;
+    bool valid = false;
+  };
+
+  SettingsStore& m_settings;
   bool m_isLicenseActivate;
+  VerificationCache m_verification;
 };
\ No newline at end of file
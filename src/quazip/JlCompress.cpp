@@ -26,14 +26,42 @@ see quazip/(un)zip.h files for details. Basically it's the zlib license.
 #include "JlCompress.h"
 #include <memory>
 
+// Size of the reusable copy buffer and of the slices written from a mapped file.
+// Can be overridden at build time.
+#ifndef JLCOMPRESS_COPY_BUFSIZE
+#define JLCOMPRESS_COPY_BUFSIZE (1024 * 1024)
+#endif
+
 bool JlCompress::copyData(QIODevice &inFile, QIODevice &outFile)
 {
+    // Regular files are mapped and handed to the writer directly, without a copy into a buffer
+    QFile *file = qobject_cast<QFile*>(&inFile);
+    if (file && !file->isSequential()) {
+        const qint64 offset = file->pos();
+        const qint64 size = file->size() - offset;
+        if (size <= 0)
+            return true;
+        uchar *data = file->map(offset, size);
+        if (data) {
+            bool ok = true;
+            for (qint64 pos = 0; ok && pos < size; pos += JLCOMPRESS_COPY_BUFSIZE) {
+                const qint64 len = qMin<qint64>(JLCOMPRESS_COPY_BUFSIZE, size - pos);
+                ok = outFile.write(reinterpret_cast<const char*>(data + pos), len) == len;
+            }
+            file->unmap(data);
+            if (ok)
+                file->seek(offset + size);
+            return ok;
+        }
+    }
+
+    // One heap buffer per thread, reused across entries
+    thread_local std::unique_ptr<char[]> buf(new char[JLCOMPRESS_COPY_BUFSIZE]);
     while (!inFile.atEnd()) {
-        char buf[4096];
-        qint64 readLen = inFile.read(buf, 4096);
+        qint64 readLen = inFile.read(buf.get(), JLCOMPRESS_COPY_BUFSIZE);
         if (readLen <= 0)
             return false;
-        if (outFile.write(buf, readLen) != readLen)
+        if (outFile.write(buf.get(), readLen) != readLen)
             return false;
     }
     return true;
@@ -26,8 +26,14 @@ see quazip/(un)zip.h files for details. Basically it's the zlib license.
 
 #include "quaziodevice.h"
 
-#define QUAZIO_INBUFSIZE 4096
-#define QUAZIO_OUTBUFSIZE 4096
+// Larger buffers mean fewer read()/deflate() round trips on multi-megabyte streams.
+// Both can be overridden at build time.
+#ifndef QUAZIO_INBUFSIZE
+#define QUAZIO_INBUFSIZE (256 * 1024)
+#endif
+#ifndef QUAZIO_OUTBUFSIZE
+#define QUAZIO_OUTBUFSIZE (256 * 1024)
+#endif
 
 /// \cond internal
 class QuaZIODevicePrivate {
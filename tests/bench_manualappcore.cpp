@@ -0,0 +1,325 @@
+#include <QCoreApplication>
+#include <QDate>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <JlCompress.h>
+#include <quazip.h>
+#include <quazipfile.h>
+#include <quazipnewinfo.h>
+#include <zlib.h>
+
+#include "file/reportcodec.h"
+#include "models/step.h"
+#include "settings/settingsmanager.h"
+#include "settings/settingsstore.h"
+
+
+namespace
+{
+
+// JlCompress::copyData before the large-buffer change
+bool copyDataWith4KBuffer(QIODevice& inFile, QIODevice& outFile)
+{
+  while (!inFile.atEnd()) {
+    char buf[4096];
+    const qint64 readLen = inFile.read(buf, 4096);
+    if (readLen <= 0) return false;
+    if (outFile.write(buf, readLen) != readLen) return false;
+  }
+  return true;
+}
+
+// A finished report as ReportManager::reportJson() stores it: every step of the shipped TO template
+// done, every third one with a defect
+QJsonObject filledReport(const QString& templateName)
+{
+  QFile file(QCoreApplication::applicationDirPath() + "/media/jsons/" + templateName + ".json");
+  if (!file.open(QIODevice::ReadOnly)) return QJsonObject();
+  const QJsonObject source = QJsonDocument::fromJson(file.readAll()).object();
+
+  QJsonArray steps;
+  int index = 0;
+  for (const QJsonValue& value : source.value("steps").toArray()) {
+    Step step = Step::fromJson(value.toObject());
+    if (++index % 3 == 0) {
+      step.completionStatus = Step::CompletionStatus::HasDefect;
+      step.defectDetails.description = "Cable insulation worn through near the probe connector";
+      step.defectDetails.repairMethod = "Cable replaced from the spare kit";
+    } else {
+      step.completionStatus = Step::CompletionStatus::Completed;
+    }
+    steps.append(step.toJson());
+  }
+
+  return {{"title", source.value("title")},
+          {"serials", QJsonObject{{"serial_number", "BENCH-0001"}}},
+          {"steps", steps}};
+}
+
+void reportThroughput(qint64 bytes, const QElapsedTimer& timer)
+{
+  const double seconds = timer.nsecsElapsed() / 1e9;
+  if (seconds > 0) qInfo("%.1f MB/s", bytes / 1e6 / seconds);
+}
+
+} // namespace
+
+
+// Throughput of the reworked hot paths next to the code they replaced.
+// Not registered with ctest; run bench_manualappcore directly, e.g. with -median 5.
+class BenchManualAppCore : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+
+  void settingsFromJsonRoundTrip_data();
+  void settingsFromJsonRoundTrip();
+
+  void settingsGetter_data();
+  void settingsGetter();
+
+  void reportCodec_data();
+  void reportCodec();
+
+  void zipCopyData_data();
+  void zipCopyData();
+
+private:
+  // Incompressible like the recordings that make up most of an archive, written once per size
+  QString inputFile(qint64 size);
+
+private:
+  QTemporaryDir m_dir;
+};
+
+void BenchManualAppCore::initTestCase()
+{
+  QVERIFY(m_dir.isValid());
+  // File-based settings stay out of the user's profile. The Windows registry cannot be redirected,
+  // the settings benchmark restores what it changes there.
+  QSettings::setPath(QSettings::NativeFormat, QSettings::UserScope, m_dir.path());
+  QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, m_dir.path());
+}
+
+void BenchManualAppCore::settingsFromJsonRoundTrip_data()
+{
+  QTest::addColumn<QString>("path");
+
+  // What fromJson did before SettingsStore: a QSettings write per field, sync, every value read back
+  QTest::newRow("QSettings per field") << "qsettings";
+  QTest::newRow("SettingsStore") << "store";
+  // The same, plus the batch write a debounced flush would do later on the writer thread
+  QTest::newRow("SettingsStore + flush") << "flush";
+}
+
+void BenchManualAppCore::settingsFromJsonRoundTrip()
+{
+  QFETCH(QString, path);
+
+  SettingsManager* manager = SettingsManager::instance();
+  const QJsonObject original = manager->toJsonForDjango();
+  QVERIFY(!original.isEmpty());
+  int round = 0;
+
+  if (path == "qsettings") {
+    QSettings settings("technovotum", "ManualAppBenchmark");
+    QBENCHMARK {
+      QJsonObject json = manager->toJsonForDjango();
+      json["serial_number"] = QString("BENCH-%1").arg(++round);
+      for (auto it = json.constBegin(); it != json.constEnd(); ++it)
+        settings.setValue(it.key(), it.value().toVariant());
+      settings.sync();
+      for (const QString& key : settings.allKeys()) settings.value(key);
+    }
+    settings.clear();
+    settings.sync();
+    return;
+  }
+
+  QBENCHMARK {
+    QJsonObject json = manager->toJsonForDjango();
+    json["serial_number"] = QString("BENCH-%1").arg(++round);
+    manager->fromJson(json);
+    if (path == "flush") SettingsStore::instance().flush();
+  }
+  manager->fromJson(original);
+  SettingsStore::instance().flush();
+}
+
+void BenchManualAppCore::settingsGetter_data()
+{
+  QTest::addColumn<QString>("property");
+  QTest::addColumn<QString>("path");
+
+  for (const char* property : {"serialNumber", "lastUpdateManualAppDate"}) {
+    // The getter before SettingsStore: a locked QSettings lookup, a QVariant conversion, a date parse
+    QTest::addRow("%s, QSettings", property) << property << "qsettings";
+    // The getter before the typed members: the same conversions on SettingsStore's in-memory copy
+    QTest::addRow("%s, SettingsStore", property) << property << "store";
+    QTest::addRow("%s, member", property) << property << "member";
+  }
+}
+
+void BenchManualAppCore::settingsGetter()
+{
+  QFETCH(QString, property);
+  QFETCH(QString, path);
+
+  SettingsManager* manager = SettingsManager::instance();
+  const QString serialNumber = manager->serialNumber();
+  const QDate date = manager->lastUpdateManualAppDate();
+  manager->setserialNumber("BENCH-0001");
+  manager->setlastUpdateManualAppDate(QDate(2026, 1, 2));
+  SettingsStore::instance().flush();
+
+  const bool isDate = property == "lastUpdateManualAppDate";
+  QSettings settings("technovotum", "ManualApp");
+  SettingsStore& store = SettingsStore::instance();
+  qint64 sink = 0;
+
+  if (path == "qsettings") {
+    QBENCHMARK {
+      if (isDate)
+        sink += QDate::fromString(settings.value(property).toString(), Qt::ISODate).day();
+      else
+        sink += settings.value(property, QString()).value<QString>().size();
+    }
+  } else if (path == "store") {
+    QBENCHMARK {
+      if (isDate)
+        sink += QDate::fromString(store.value(property).toString(), Qt::ISODate).day();
+      else
+        sink += store.value(property, QString()).value<QString>().size();
+    }
+  } else {
+    QBENCHMARK {
+      if (isDate)
+        sink += manager->lastUpdateManualAppDate().day();
+      else
+        sink += manager->serialNumber().size();
+    }
+  }
+  QVERIFY(sink > 0);
+
+  manager->setserialNumber(serialNumber);
+  manager->setlastUpdateManualAppDate(date);
+  SettingsStore::instance().flush();
+}
+
+void BenchManualAppCore::reportCodec_data()
+{
+  QTest::addColumn<QString>("templateName");
+  QTest::addColumn<int>("format");
+  QTest::addColumn<QString>("operation");
+
+  const QList<QPair<const char*, ReportCodec::Format>> formats = {{"json", ReportCodec::Format::Json},
+                                                                  {"cbor", ReportCodec::Format::Cbor}};
+  for (const char* templateName : {"TO1", "TO2", "TO3"}) {
+    for (const auto& format : formats) {
+      for (const char* operation : {"serialize", "parse", "title"}) {
+        QTest::addRow("%s %s %s", templateName, format.first, operation)
+            << templateName << static_cast<int>(format.second) << operation;
+      }
+    }
+  }
+}
+
+void BenchManualAppCore::reportCodec()
+{
+  QFETCH(QString, templateName);
+  QFETCH(int, format);
+  QFETCH(QString, operation);
+
+  const QJsonObject report = filledReport(templateName);
+  QVERIFY(!report.isEmpty());
+  const auto codecFormat = static_cast<ReportCodec::Format>(format);
+  const QByteArray encoded = ReportCodec::encode(report, codecFormat);
+  QCOMPARE(ReportCodec::decode(encoded), report);
+  qInfo("%lld bytes", static_cast<long long>(encoded.size()));
+
+  qint64 sink = 0;
+  if (operation == "serialize") {
+    QBENCHMARK { sink += ReportCodec::encode(report, codecFormat).size(); }
+  } else if (operation == "parse") {
+    QBENCHMARK { sink += ReportCodec::decode(encoded).size(); }
+  } else {
+    // One top-level field; for CBOR the steps are skipped without being decoded
+    QBENCHMARK { sink += ReportCodec::field(encoded, "title").toString().size(); }
+  }
+  QVERIFY(sink > 0);
+}
+
+void BenchManualAppCore::zipCopyData_data()
+{
+  QTest::addColumn<qint64>("size");
+  QTest::addColumn<int>("method");
+  QTest::addColumn<bool>("legacy");
+
+  const QList<QPair<const char*, qint64>> sizes = {
+      {"1 KB", 1024}, {"1 MB", 1024 * 1024}, {"100 MB", 100 * 1024 * 1024}};
+  const QList<QPair<const char*, int>> methods = {{"store", 0}, {"deflate", Z_DEFLATED}};
+  for (const auto& size : sizes) {
+    for (const auto& method : methods) {
+      QTest::addRow("%s %s, 4 KB buffer", method.first, size.first) << size.second << method.second << true;
+      QTest::addRow("%s %s, copyData", method.first, size.first) << size.second << method.second << false;
+    }
+  }
+}
+
+void BenchManualAppCore::zipCopyData()
+{
+  QFETCH(qint64, size);
+  QFETCH(int, method);
+  QFETCH(bool, legacy);
+
+  const QString source = inputFile(size);
+  QVERIFY(!source.isEmpty());
+  const QString zipPath = m_dir.filePath("bench.zip");
+  const int level = method == 0 ? 0 : Z_DEFAULT_COMPRESSION;
+
+  QElapsedTimer timer;
+  qint64 bytes = 0;
+  timer.start();
+  QBENCHMARK {
+    QuaZip zip(zipPath);
+    QVERIFY(zip.open(QuaZip::mdCreate));
+    QFile in(source);
+    QVERIFY(in.open(QIODevice::ReadOnly));
+    QuaZipFile out(&zip);
+    QVERIFY(out.open(QIODevice::WriteOnly, QuaZipNewInfo("entry.bin", source), nullptr, 0, method, level));
+    QVERIFY(legacy ? copyDataWith4KBuffer(in, out) : JlCompress::copyData(in, out));
+    out.close();
+    zip.close();
+    bytes += size;
+  }
+  reportThroughput(bytes, timer);
+}
+
+QString BenchManualAppCore::inputFile(qint64 size)
+{
+  const QString path = m_dir.filePath(QString("input-%1.bin").arg(size));
+  if (QFileInfo(path).size() == size) return path;
+
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly)) return QString();
+  QRandomGenerator generator(static_cast<quint32>(size));
+  QByteArray block(qMin<qint64>(size, 1024 * 1024), Qt::Uninitialized);
+  for (qint64 written = 0; written < size; written += block.size()) {
+    generator.fillRange(reinterpret_cast<quint32*>(block.data()), block.size() / sizeof(quint32));
+    file.write(block.constData(), qMin<qint64>(block.size(), size - written));
+  }
+  return path;
+}
+
+QTEST_GUILESS_MAIN(BenchManualAppCore)
+#include "bench_manualappcore.moc"
@@ -0,0 +1,118 @@
+#include "mockhttpserver.h"
+
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QTcpSocket>
+
+
+namespace
+{
+
+QByteArray reasonPhrase(int status)
+{
+  switch (status) {
+    case 200: return "OK";
+    case 201: return "Created";
+    case 206: return "Partial Content";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 409: return "Conflict";
+    case 415: return "Unsupported Media Type";
+    case 416: return "Range Not Satisfiable";
+    case 500: return "Internal Server Error";
+    default: return "Status";
+  }
+}
+
+} // namespace
+
+QJsonObject MockHttpServer::Request::json() const
+{
+  return QJsonDocument::fromJson(body).object();
+}
+
+MockHttpServer::Response MockHttpServer::Response::json(const QJsonObject& object, int status)
+{
+  Response response;
+  response.status = status;
+  response.headers.append({"Content-Type", "application/json"});
+  response.body = QJsonDocument(object).toJson(QJsonDocument::Compact);
+  return response;
+}
+
+MockHttpServer::MockHttpServer(Handler handler, QObject* parent)
+    : QObject(parent)
+    , m_handler(std::move(handler))
+{
+  connect(&m_server, &QTcpServer::newConnection, this, &MockHttpServer::onNewConnection);
+  m_server.listen(QHostAddress::LocalHost);
+}
+
+QUrl MockHttpServer::url(const QString& path) const
+{
+  QUrl url;
+  url.setScheme("http");
+  url.setHost("127.0.0.1");
+  url.setPort(m_server.serverPort());
+  url.setPath(path);
+  return url;
+}
+
+void MockHttpServer::onNewConnection()
+{
+  while (QTcpSocket* socket = m_server.nextPendingConnection()) {
+    socket->setParent(this);
+    connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+    connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+      m_buffers.remove(socket);
+      socket->deleteLater();
+    });
+  }
+}
+
+void MockHttpServer::onReadyRead(QTcpSocket* socket)
+{
+  QByteArray& buffer = m_buffers[socket];
+  buffer += socket->readAll();
+
+  // One read may hold several pipelined requests, or only part of one
+  for (;;) {
+    const qsizetype headerEnd = buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) return;
+
+    const QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+    const QList<QByteArray> requestLine = lines.value(0).trimmed().split(' ');
+
+    Request request;
+    request.method = requestLine.value(0);
+    const QUrl target(QString::fromLatin1(requestLine.value(1)));
+    request.path = target.path();
+    request.query = QUrlQuery(target);
+    for (qsizetype i = 1; i < lines.size(); ++i) {
+      const qsizetype colon = lines.at(i).indexOf(':');
+      if (colon <= 0) continue;
+      request.headers.insert(lines.at(i).left(colon).trimmed().toLower(),
+                             lines.at(i).mid(colon + 1).trimmed());
+    }
+
+    const qsizetype bodyLength = request.header("Content-Length").toLongLong();
+    if (buffer.size() < headerEnd + 4 + bodyLength) return;
+
+    request.body = buffer.mid(headerEnd + 4, bodyLength);
+    buffer.remove(0, headerEnd + 4 + bodyLength);
+
+    m_requests.append(request);
+    respond(socket, m_handler(request));
+  }
+}
+
+void MockHttpServer::respond(QTcpSocket* socket, const Response& response)
+{
+  QByteArray data = "HTTP/1.1 " + QByteArray::number(response.status) + ' ' + reasonPhrase(response.status) +
+                    "\r\nContent-Length: " + QByteArray::number(response.body.size()) +
+                    "\r\nConnection: keep-alive\r\n";
+  for (const auto& header : response.headers) data += header.first + ": " + header.second + "\r\n";
+  data += "\r\n" + response.body;
+
+  socket->write(data);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QTcpServer>
+#include <QUrl>
+#include <QUrlQuery>
+#include <functional>
+
+class QTcpSocket;
+
+// Stand-in for the Django server in protocol tests.
+// Listens on 127.0.0.1, parses HTTP/1.1 requests with a Content-Length body and keeps connections
+// alive the way QNetworkAccessManager expects; every request goes to the handler, which builds the
+// response.
+class MockHttpServer : public QObject
+{
+  Q_OBJECT
+public:
+  struct Request {
+    QByteArray method;
+    QString path;
+    QUrlQuery query;
+    // Header names in lower case
+    QHash<QByteArray, QByteArray> headers;
+    QByteArray body;
+
+    QByteArray header(const QByteArray& name) const { return headers.value(name.toLower()); }
+    QJsonObject json() const;
+  };
+
+  struct Response {
+    int status = 200;
+    QList<QPair<QByteArray, QByteArray>> headers;
+    QByteArray body;
+
+    static Response json(const QJsonObject& object, int status = 200);
+  };
+
+  using Handler = std::function<Response(const Request&)>;
+
+  explicit MockHttpServer(Handler handler, QObject* parent = nullptr);
+
+  bool isListening() const { return m_server.isListening(); }
+  QUrl url(const QString& path) const;
+  // Every request served so far, oldest first
+  const QList<Request>& requests() const { return m_requests; }
+  void clearRequests() { m_requests.clear(); }
+
+private:
+  void onNewConnection();
+  void onReadyRead(QTcpSocket* socket);
+  void respond(QTcpSocket* socket, const Response& response);
+
+private:
+  QTcpServer m_server;
+  Handler m_handler;
+  QHash<QTcpSocket*, QByteArray> m_buffers;
+  QList<Request> m_requests;
+};
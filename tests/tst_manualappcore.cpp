@@ -0,0 +1,824 @@
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDate>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QRandomGenerator>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <zlib.h>
+
+#include "file/contentchunker.h"
+#include "file/fileservice.h"
+#include "file/reportcodec.h"
+#include "file/reportindex.h"
+#include "file/reportioexecutor.h"
+#include "file/stepjournal.h"
+#include "mockhttpserver.h"
+#include "network/chunkeduploader.h"
+#include "network/dedupuploader.h"
+#include "network/httpclient.h"
+#include "network/reportsync.h"
+#include "network/reportuploader.h"
+#include "network/requestencoder.h"
+
+
+namespace
+{
+
+using Request = MockHttpServer::Request;
+using Response = MockHttpServer::Response;
+
+constexpr qint64 ChunkSize = 256 * 1024;
+
+// Collects the first finished() of an HttpClient or uploader; errors may be reported twice
+class FinishedSpy
+{
+public:
+  template <typename Sender>
+  explicit FinishedSpy(Sender* sender)
+  {
+    QObject::connect(sender, &Sender::finished, &m_context, [this](const HttpClient::HttpResponse& response) {
+      if (m_done) return;
+      m_response = response;
+      m_done = true;
+    });
+  }
+
+  bool wait(int timeoutMs = 10000)
+  {
+    return QTest::qWaitFor([this]() { return m_done; }, timeoutMs);
+  }
+  const HttpClient::HttpResponse& response() const { return m_response; }
+
+private:
+  QObject m_context;
+  bool m_done = false;
+  HttpClient::HttpResponse m_response;
+};
+
+QByteArray randomBytes(qsizetype size, quint32 seed)
+{
+  QByteArray data(size, Qt::Uninitialized);
+  QRandomGenerator generator(seed);
+  generator.fillRange(reinterpret_cast<quint32*>(data.data()), size / sizeof(quint32));
+  return data;
+}
+
+bool writeFile(const QString& path, const QByteArray& data)
+{
+  QFile file(path);
+  return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+QByteArray sha256Hex(const QByteArray& data)
+{
+  return QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex();
+}
+
+QByteArray gunzip(const QByteArray& data)
+{
+  z_stream stream{};
+  // 16 added to the window bits expects the gzip wrapper
+  if (inflateInit2(&stream, MAX_WBITS + 16) != Z_OK) return QByteArray();
+
+  QByteArray result;
+  QByteArray buffer(64 * 1024, Qt::Uninitialized);
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+  stream.avail_in = static_cast<uInt>(data.size());
+  int status = Z_OK;
+  while (status == Z_OK) {
+    stream.next_out = reinterpret_cast<Bytef*>(buffer.data());
+    stream.avail_out = static_cast<uInt>(buffer.size());
+    status = inflate(&stream, Z_NO_FLUSH);
+    result.append(buffer.constData(), buffer.size() - stream.avail_out);
+  }
+  inflateEnd(&stream);
+  return status == Z_STREAM_END ? result : QByteArray();
+}
+
+Step makeStep(const QString& title, Step::CompletionStatus status)
+{
+  Step step;
+  step.title = title;
+  step.completionStatus = status;
+  return step;
+}
+
+int countRequests(const MockHttpServer& server, const QByteArray& method, const QString& pathPart)
+{
+  int count = 0;
+  for (const Request& request : server.requests())
+    if (request.method == method && request.path.contains(pathPart)) ++count;
+  return count;
+}
+
+// A server behind middleware that inflates gzipped request bodies and says so in Accept-Encoding
+struct GzipServer {
+  // Off: gzip is advertised, but gzipped bodies are refused, e.g. by a proxy in front of the server
+  bool inflates = true;
+  // Request bodies as the application sees them
+  QList<QByteArray> bodies;
+
+  Response handle(const Request& request)
+  {
+    Response response = Response::json({{"ok", true}});
+    QByteArray body = request.body;
+    if (request.header("Content-Encoding") == "gzip") {
+      if (!inflates) response = Response::json({{"detail", "Unsupported content encoding"}}, 415);
+      body = gunzip(body);
+    }
+    if (response.status == 200) bodies.append(body);
+
+    response.headers.append({"Accept-Encoding", "gzip"});
+    return response;
+  }
+};
+
+// get_reports and the report endpoints; the listing is always empty, filtered by ?since= or not
+struct SyncServer {
+  QString serverTime;
+
+  Response handle(const Request& request)
+  {
+    if (request.method == "GET" && request.path.endsWith("/get_reports")) {
+      QJsonObject listing{{"server_time", serverTime}};
+      if (request.query.hasQueryItem("since")) listing["incremental"] = true;
+      return Response::json(listing);
+    }
+    return Response::json({});
+  }
+};
+
+// "<number_to> <endpoint>" of every upload, "metadata" for the report POST
+QStringList uploads(const MockHttpServer& server)
+{
+  QStringList result;
+  for (const Request& request : server.requests()) {
+    if (request.method != "POST") continue;
+    if (request.path == "/api/report/")
+      result << request.json().value("metadata").toObject().value("number_to").toString() + " metadata";
+    else
+      result << request.query.queryItemValue("number_to") + " " + request.path.section('/', -2, -2);
+  }
+  result.sort();
+  return result;
+}
+
+// Server side of ChunkedUploader: one upload id, chunks appended at the confirmed offset
+struct ChunkedServer {
+  QByteArray stored;
+  // Off: every chunk is acknowledged without moving the offset
+  bool advance = true;
+  // Not 0: the server has no chunked endpoints, answers them with this status and takes plain posts
+  int unsupportedStatus = 0;
+  QByteArray posted;
+
+  Response handle(const Request& request)
+  {
+    if (unsupportedStatus != 0) {
+      if (request.path.contains("/chunked/"))
+        return Response::json({{"detail", "no route"}}, unsupportedStatus);
+      posted = request.header("Content-Encoding") == "gzip" ? gunzip(request.body) : request.body;
+      return Response::json({});
+    }
+
+    if (request.method == "POST" && request.path.endsWith("/chunked/"))
+      return Response::json({{"upload_id", "u1"}, {"offset", stored.size()}});
+
+    if (request.method == "PUT" && request.path.endsWith("/chunked/u1/")) {
+      const QByteArray range = request.header("Content-Range");
+      const qint64 from = range.mid(6, range.indexOf('-') - 6).toLongLong();
+      if (from != stored.size() || sha256Hex(request.body) != request.header("X-Chunk-SHA256"))
+        return Response::json({{"detail", "bad chunk"}}, 409);
+      if (advance) stored += request.body;
+      return Response::json({{"offset", stored.size()}});
+    }
+
+    if (request.method == "POST" && request.path.endsWith("/chunked/u1/complete/"))
+      return Response::json({{"file_size", request.json().value("file_size")}});
+
+    return Response::json({}, 404);
+  }
+};
+
+// Server side of DedupUploader: a chunk store and the file rebuilt from the last manifest
+struct DedupServer {
+  QHash<QByteArray, QByteArray> chunks;
+  QByteArray assembled;
+
+  Response handle(const Request& request)
+  {
+    if (request.path.endsWith("/dedup/missing/")) {
+      QJsonArray missing;
+      for (const QJsonValue& hash : request.json().value("chunks").toArray())
+        if (!chunks.contains(hash.toString().toLatin1())) missing.append(hash);
+      return Response::json({{"missing", missing}});
+    }
+
+    if (request.method == "PUT" && request.path.contains("/dedup/chunks/")) {
+      const QByteArray hash = request.header("X-Chunk-SHA256");
+      if (sha256Hex(request.body) != hash) return Response::json({{"detail", "checksum mismatch"}}, 400);
+      chunks.insert(hash, request.body);
+      return Response::json({});
+    }
+
+    if (request.path.endsWith("/dedup/manifest/")) {
+      const QJsonObject manifest = request.json();
+      QByteArray file;
+      QJsonArray missing;
+      for (const QJsonValue& value : manifest.value("chunks").toArray()) {
+        const QByteArray hash = value.toObject().value("sha256").toString().toLatin1();
+        if (!chunks.contains(hash))
+          missing.append(QString::fromLatin1(hash));
+        else
+          file += chunks.value(hash);
+      }
+      if (!missing.isEmpty()) return Response::json({{"missing", missing}}, 409);
+      if (sha256Hex(file) != manifest.value("sha256").toString().toLatin1())
+        return Response::json({{"detail", "file checksum mismatch"}}, 400);
+      assembled = file;
+      return Response::json({});
+    }
+
+    return Response::json({}, 404);
+  }
+};
+
+// An installer endpoint that honours Range and announces the file's SHA-256 unless told not to
+struct DownloadServer {
+  QByteArray file;
+  bool announceChecksum = true;
+
+  Response handle(const Request& request)
+  {
+    Response response;
+    qint64 from = 0;
+    const QByteArray range = request.header("Range");
+    if (range.startsWith("bytes=")) {
+      from = range.mid(6, range.indexOf('-') - 6).toLongLong();
+      response.status = 206;
+      response.headers.append({"Content-Range", QString("bytes %1-%2/%3")
+                                                    .arg(from)
+                                                    .arg(file.size() - 1)
+                                                    .arg(file.size())
+                                                    .toLatin1()});
+    }
+    response.body = file.mid(from);
+    response.headers.append({"Content-Type", "application/octet-stream"});
+    response.headers.append({"ETag", "\"v1\""});
+    if (announceChecksum) response.headers.append({"X-Checksum-SHA256", sha256Hex(file)});
+    return response;
+  }
+};
+
+} // namespace
+
+class TestManualAppCore : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+
+  void syncSendsOnlyNewOrChangedArtifacts();
+
+  void journalReplaysAppendedSteps();
+  void journalSkipsCoveredAndTornRecords();
+
+  void cborRoundTrip();
+  void cborFallsBackToJsonOn415();
+
+  void gzipRoundTrip();
+  void gzipOnlyAfterServerConfirms();
+  void gzipFallsBackToRawOn415();
+  void gzipCompressesWholeMultipartBody();
+
+  void chunkedUploadSendsEveryChunk();
+  void chunkedUploadResumesFromConfirmedOffset();
+  void chunkedUploadFailsWhenOffsetDoesNotAdvance();
+  void chunkedUploadFallsBackToPostWithoutEndpoints();
+
+  void dedupUploadSendsOnlyMissingChunks();
+  void dedupUploadResendsChunksDroppedByServer();
+
+  void downloadResumesPartAndReplacesFile();
+  void downloadFailsWithoutChecksum();
+
+private:
+  QTemporaryDir m_dir;
+};
+
+void TestManualAppCore::initTestCase()
+{
+  QVERIFY(m_dir.isValid());
+  QStandardPaths::setTestModeEnabled(true);
+
+  // ConfigManager reads .config.ini next to the executable on first use
+  QVERIFY(writeFile(QCoreApplication::applicationDirPath() + "/.config.ini",
+                    "upload_chunk_size_kb=256\ndedup_upload=true\ngzip_requests=true\ngzip_min_bytes=64\n"));
+  QFile::remove(FileService().getFullFilePath("chunk_index.json"));
+}
+
+void TestManualAppCore::syncSendsOnlyNewOrChangedArtifacts()
+{
+  const QString root = m_dir.filePath("reports/");
+  const QString date = QDate::currentDate().toString("yyyy-MM-dd");
+  const QString first = root + "TO-1/" + date + "/";
+  QVERIFY(QDir().mkpath(first + "before_to"));
+  QVERIFY(writeFile(first + "report.json", R"({"title":"TO-1","steps":[]})"));
+  QVERIFY(writeFile(first + "report.pdf", "%PDF-1.4 first"));
+  QVERIFY(writeFile(first + "before_to/rail_record.zip", randomBytes(4096, 6)));
+
+  SyncServer state;
+  state.serverTime = "2026-03-01T10:00:00Z";
+  MockHttpServer server([&state](const Request& request) { return state.handle(request); });
+  const QString baseUrl = server.url("").toString();
+
+  ReportIndex index(root, m_dir.filePath("report_index.json"));
+  index.load();
+  ReportIoExecutor executor;
+  ReportUploader uploader;
+  const QString manifestPath = m_dir.filePath("sync_manifest.json");
+  ReportSync sync(manifestPath, &index, &executor, &uploader);
+  const QString firstKey = SyncManifest::reportKey("TO-1", date);
+
+  // First sync: full listing, the server has nothing yet
+  QSignalSpy finished(&sync, &ReportSync::finished);
+  sync.start(baseUrl, "SN1", "model");
+  QVERIFY(finished.wait());
+  QCOMPARE(finished.takeFirst().at(0).toInt(), 1);
+
+  QVERIFY(!server.requests().first().query.hasQueryItem("since"));
+  QCOMPARE(uploads(server), QStringList({"TO-1 before", "TO-1 json", "TO-1 metadata", "TO-1 pdf"}));
+  QCOMPARE(sync.manifest().lastServerSync(), state.serverTime);
+  QCOMPARE(sync.manifest().acknowledged(firstKey, "report.pdf").hash,
+           SyncManifest::hashFile(first + "report.pdf"));
+
+  // The PDF is regenerated and a TO-2 report is added
+  QVERIFY(writeFile(first + "report.pdf", "%PDF-1.4 regenerated"));
+  const QString second = root + "TO-2/" + date + "/";
+  QVERIFY(QDir().mkpath(second));
+  QVERIFY(writeFile(second + "report.json", R"({"title":"TO-2","steps":[]})"));
+  QVERIFY(writeFile(second + "report.pdf", "%PDF-1.4 second"));
+  index.refreshReport("TO-1", date);
+  index.refreshReport("TO-2", date);
+
+  const QString since = state.serverTime;
+  state.serverTime = "2026-03-02T10:00:00Z";
+  server.clearRequests();
+  sync.start(baseUrl, "SN1", "model");
+  QVERIFY(finished.wait());
+  QCOMPARE(finished.takeFirst().at(0).toInt(), 2);
+
+  // Delta listing, and only what the server has not acknowledged yet
+  QCOMPARE(server.requests().first().query.queryItemValue("since"), since);
+  QCOMPARE(uploads(server), QStringList({"TO-1 pdf", "TO-2 json", "TO-2 metadata", "TO-2 pdf"}));
+
+  SyncManifest stored(manifestPath);
+  stored.load();
+  QCOMPARE(stored.lastServerSync(), state.serverTime);
+  QCOMPARE(stored.acknowledged(firstKey, "report.pdf").hash, SyncManifest::hashFile(first + "report.pdf"));
+  QCOMPARE(stored.acknowledged(SyncManifest::reportKey("TO-2", date), "report.json").hash,
+           SyncManifest::hashFile(second + "report.json"));
+
+  // Nothing changed since: the listing is the only request
+  server.clearRequests();
+  sync.start(baseUrl, "SN1", "model");
+  QVERIFY(finished.wait());
+  QCOMPARE(finished.takeFirst().at(0).toInt(), 0);
+  QCOMPARE(server.requests().size(), 1);
+}
+
+void TestManualAppCore::journalReplaysAppendedSteps()
+{
+  const QString path = m_dir.filePath("replay.journal");
+  {
+    StepJournal journal(path);
+    QVERIFY(journal.open());
+    QCOMPARE(journal.append(0, makeStep("Brakes", Step::CompletionStatus::Completed)), qint64(1));
+
+    Step doors = makeStep("Doors", Step::CompletionStatus::HasDefect);
+    doors.defectDetails.description = "Hinge loose";
+    QCOMPARE(journal.append(1, doors), qint64(2));
+    QCOMPARE(journal.append(0, makeStep("Brakes", Step::CompletionStatus::Skipped)), qint64(3));
+  }
+
+  StepJournal journal(path);
+  QVERIFY(journal.open());
+  QCOMPARE(journal.entries().size(), 3);
+  QCOMPARE(journal.lastSeq(), qint64(3));
+
+  QList<Step> steps = {makeStep("Brakes", Step::CompletionStatus::NotStarted),
+                       makeStep("Doors", Step::CompletionStatus::NotStarted)};
+  for (const StepJournal::Entry& entry : journal.entries())
+    QVERIFY(StepJournal::apply(entry, steps[entry.index]));
+  QVERIFY(steps[0].completionStatus == Step::CompletionStatus::Skipped);
+  QVERIFY(steps[1].completionStatus == Step::CompletionStatus::HasDefect);
+  QCOMPARE(steps[1].defectDetails.description, QString("Hinge loose"));
+
+  // A journal written for another checklist is not applied
+  Step lights = makeStep("Lights", Step::CompletionStatus::NotStarted);
+  QVERIFY(!StepJournal::apply(journal.entries().first(), lights));
+}
+
+void TestManualAppCore::journalSkipsCoveredAndTornRecords()
+{
+  const QString path = m_dir.filePath("torn.journal");
+  {
+    StepJournal journal(path);
+    QVERIFY(journal.open());
+    for (int i = 0; i < 3; ++i)
+      journal.append(i, makeStep(QString("Step %1").arg(i), Step::CompletionStatus::Completed));
+    QVERIFY(journal.truncateThrough(2));
+  }
+  {
+    // A crash in the middle of a write leaves half a record behind
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+    file.write("{\"n\":4,\"i\":0,\"ti");
+  }
+
+  StepJournal journal(path);
+  QVERIFY(journal.open());
+  QCOMPARE(journal.entries().size(), 1);
+  QCOMPARE(journal.entries().first().seq, qint64(3));
+  QCOMPARE(journal.entries().first().index, 2);
+
+  // Records appended after the torn one are read back
+  QCOMPARE(journal.append(1, makeStep("Step 1", Step::CompletionStatus::Completed)), qint64(4));
+  QVERIFY(journal.sync());
+  StepJournal reopened(path);
+  QVERIFY(reopened.open());
+  QCOMPARE(reopened.entries().size(), 2);
+  QCOMPARE(reopened.entries().last().seq, qint64(4));
+  QCOMPARE(reopened.entries().last().index, 1);
+
+  // A snapshot that covers sequence 3 leaves nothing to replay, numbering continues after it
+  StepJournal covered(m_dir.filePath("replay.journal"));
+  QVERIFY(covered.open(3));
+  QVERIFY(covered.entries().isEmpty());
+  QCOMPARE(covered.lastSeq(), qint64(3));
+}
+
+void TestManualAppCore::cborRoundTrip()
+{
+  const QJsonObject report{{"title", "TO-1"},
+                           {"journal_seq", 7},
+                           {"ratio", 0.5},
+                           {"steps", QJsonArray{QJsonObject{{"title", "Brakes"}, {"completionStatus", 1}}}}};
+
+  const QByteArray cbor = ReportCodec::encode(report, ReportCodec::Format::Cbor);
+  QVERIFY(ReportCodec::isCbor(cbor));
+  QVERIFY(!ReportCodec::isCbor(ReportCodec::encode(report, ReportCodec::Format::Json)));
+  QCOMPARE(ReportCodec::decode(cbor), report);
+  QCOMPARE(ReportCodec::field(cbor, "journal_seq").toInt(), 7);
+  QVERIFY(ReportCodec::field(cbor, "missing").isUndefined());
+}
+
+void TestManualAppCore::cborFallsBackToJsonOn415()
+{
+  MockHttpServer server([](const Request& request) {
+    if (request.header("Content-Type").startsWith("application/cbor"))
+      return Response::json({{"detail", "Unsupported media type"}}, 415);
+    return Response::json({{"received", request.json()}});
+  });
+  QVERIFY(server.isListening());
+
+  const QJsonObject report{{"title", "TO-2"}, {"journal_seq", 3}};
+  HttpClient client;
+  FinishedSpy spy(&client);
+  client.postCbor(server.url("/api/report/"), report);
+  QVERIFY(spy.wait());
+  QVERIFY(spy.response().success);
+
+  QCOMPARE(server.requests().size(), 2);
+  QVERIFY(server.requests().at(0).header("Content-Type").startsWith("application/cbor"));
+  QCOMPARE(ReportCodec::decode(server.requests().at(0).body), report);
+  QVERIFY(server.requests().at(1).header("Content-Type").startsWith("application/json"));
+  QCOMPARE(server.requests().at(1).json(), report);
+
+  // The host is remembered, the next report goes out as JSON right away
+  HttpClient second;
+  FinishedSpy secondSpy(&second);
+  second.postCbor(server.url("/api/report/"), report);
+  QVERIFY(secondSpy.wait());
+  QCOMPARE(server.requests().size(), 3);
+  QVERIFY(server.requests().at(2).header("Content-Type").startsWith("application/json"));
+}
+
+void TestManualAppCore::gzipRoundTrip()
+{
+  const QByteArray data = QByteArray("{\"title\":\"Brakes\",\"completionStatus\":1},").repeated(200);
+  const QByteArray compressed = RequestEncoder::gzip(data);
+  QVERIFY(!compressed.isEmpty());
+  QVERIFY(compressed.size() < data.size());
+  QCOMPARE(gunzip(compressed), data);
+}
+
+void TestManualAppCore::gzipOnlyAfterServerConfirms()
+{
+  GzipServer state;
+  MockHttpServer server([&state](const Request& request) { return state.handle(request); });
+  const QJsonObject report{{"title", QString("Brakes checked. ").repeated(50)}};
+
+  // Nothing is known about the host yet: the body goes out as it is
+  HttpClient first;
+  FinishedSpy firstSpy(&first);
+  first.postJson(server.url("/api/report/"), report);
+  QVERIFY(firstSpy.wait());
+  QVERIFY(firstSpy.response().success);
+  QVERIFY(server.requests().at(0).header("Content-Encoding").isEmpty());
+
+  HttpClient second;
+  FinishedSpy secondSpy(&second);
+  second.postJson(server.url("/api/report/"), report);
+  QVERIFY(secondSpy.wait());
+  QVERIFY(secondSpy.response().success);
+
+  QCOMPARE(server.requests().size(), 2);
+  QCOMPARE(server.requests().at(1).header("Content-Encoding"), QByteArray("gzip"));
+  QVERIFY(server.requests().at(1).body.size() < state.bodies.at(1).size());
+  QCOMPARE(QJsonDocument::fromJson(state.bodies.at(1)).object(), report);
+}
+
+void TestManualAppCore::gzipFallsBackToRawOn415()
+{
+  GzipServer state;
+  state.inflates = false;
+  MockHttpServer server([&state](const Request& request) { return state.handle(request); });
+  const QJsonObject report{{"title", QString("Doors checked. ").repeated(50)}};
+
+  for (int i = 0; i < 3; ++i) {
+    HttpClient client;
+    FinishedSpy spy(&client);
+    client.postJson(server.url("/api/report/"), report);
+    QVERIFY(spy.wait());
+    QVERIFY2(spy.response().success, qPrintable(spy.response().errorMessage));
+  }
+
+  // Raw, then gzipped and refused, resent raw, and raw from then on
+  QCOMPARE(server.requests().size(), 4);
+  QVERIFY(server.requests().at(0).header("Content-Encoding").isEmpty());
+  QCOMPARE(server.requests().at(1).header("Content-Encoding"), QByteArray("gzip"));
+  QVERIFY(server.requests().at(2).header("Content-Encoding").isEmpty());
+  QVERIFY(server.requests().at(3).header("Content-Encoding").isEmpty());
+  QCOMPARE(state.bodies.size(), 3);
+  for (const QByteArray& body : std::as_const(state.bodies))
+    QCOMPARE(QJsonDocument::fromJson(body).object(), report);
+}
+
+void TestManualAppCore::gzipCompressesWholeMultipartBody()
+{
+  const QString path = m_dir.filePath("report.json");
+  const QByteArray data = QByteArray("{\"title\":\"Lights\",\"completionStatus\":2},").repeated(300);
+  QVERIFY(writeFile(path, data));
+
+  GzipServer state;
+  MockHttpServer server([&state](const Request& request) { return state.handle(request); });
+  {
+    HttpClient client;
+    FinishedSpy spy(&client);
+    client.postJson(server.url("/api/report/"), QJsonObject{{"title", "TO-3"}});
+    QVERIFY(spy.wait());
+  }
+
+  HttpClient client;
+  FinishedSpy spy(&client);
+  client.postFile(server.url("/api/report/json/"), path);
+  QVERIFY(spy.wait());
+  QVERIFY2(spy.response().success, qPrintable(spy.response().errorMessage));
+
+  const Request& request = server.requests().last();
+  QCOMPARE(request.header("Content-Encoding"), QByteArray("gzip"));
+  QVERIFY(request.body.size() < data.size());
+
+  // Inflated, it is an ordinary multipart body a Django parser reads as it is
+  const QByteArray contentType = request.header("Content-Type");
+  QVERIFY(contentType.startsWith("multipart/form-data; boundary="));
+  const QByteArray boundary = contentType.mid(contentType.indexOf('=') + 1);
+  const QByteArray body = state.bodies.last();
+  QVERIFY(body.startsWith("--" + boundary + "\r\n"));
+  QVERIFY(body.contains("filename=\"report.json\"\r\n\r\n" + data + "\r\n--" + boundary + "--\r\n"));
+}
+
+void TestManualAppCore::chunkedUploadSendsEveryChunk()
+{
+  const QString path = m_dir.filePath("chunked.zip");
+  const QByteArray data = randomBytes(2 * ChunkSize + 90 * 1024, 1);
+  QVERIFY(writeFile(path, data));
+
+  ChunkedServer state;
+  MockHttpServer server([&state](const Request& request) { return state.handle(request); });
+
+  ChunkedUploader uploader;
+  FinishedSpy spy(&uploader);
+  uploader.start(server.url("/api/report/before/"), path);
+  QVERIFY(spy.wait());
+  QVERIFY2(spy.response().success, qPrintable(spy.response().errorMessage));
+
+  QCOMPARE(state.stored, data);
+  QCOMPARE(countRequests(server, "PUT", "/chunked/u1/"), 3);
+  QCOMPARE(countRequests(server, "POST", "/complete/"), 1);
+  QCOMPARE(uploader.bytesSent(), qint64(data.size()));
+  QVERIFY(!QFile::exists(path + ".upload"));
+}
+
+void TestManualAppCore::chunkedUploadResumesFromConfirmedOffset()
+{
+  const QString path = m_dir.filePath("resumed.zip");
+  const QByteArray data = randomBytes(3 * ChunkSize, 2);
+  QVERIFY(writeFile(path, data));
+
+  // The server kept the first chunk of an earlier attempt
+  ChunkedServer state;
+  state.stored = data.left(ChunkSize);
+  MockHttpServer server([&state](const Request& request) { return state.handle(request); });
+
+  ChunkedUploader uploader;
+  FinishedSpy spy(&uploader);
+  uploader.start(server.url("/api/report/after/"), path);
+  QVERIFY(spy.wait());
+  QVERIFY2(spy.response().success, qPrintable(spy.response().errorMessage));
+
+  QCOMPARE(state.stored, data);
+  QCOMPARE(countRequests(server, "PUT", "/chunked/u1/"), 2);
+  for (const Request& request : server.requests()) {
+    if (request.method != "PUT") continue;
+    QVERIFY(request.header("Content-Range").startsWith("bytes " + QByteArray::number(ChunkSize)));
+    break;
+  }
+}
+
+void TestManualAppCore::chunkedUploadFailsWhenOffsetDoesNotAdvance()
+{
+  const QString path = m_dir.filePath("stuck.zip");
+  QVERIFY(writeFile(path, randomBytes(2 * ChunkSize, 3)));
+
+  ChunkedServer state;
+  state.advance = false;
+  MockHttpServer server([&state](const Request& request) { return state.handle(request); });
+
+  ChunkedUploader uploader;
+  FinishedSpy spy(&uploader);
+  uploader.start(server.url("/api/report/before/"), path);
+  // Retries back off by 1 + 2 + 3 seconds
+  QVERIFY(spy.wait(20000));
+  QVERIFY(!spy.response().success);
+  QCOMPARE(countRequests(server, "PUT", "/chunked/u1/"), 4);
+  QCOMPARE(countRequests(server, "POST", "/complete/"), 0);
+}
+
+void TestManualAppCore::chunkedUploadFallsBackToPostWithoutEndpoints()
+{
+  const QString path = m_dir.filePath("plain.zip");
+  const QByteArray data = randomBytes(ChunkSize + 1024, 7);
+  QVERIFY(writeFile(path, data));
+
+  // Django answers 404 for an unknown route and 405 for a route without a POST handler
+  for (const int status : {404, 405}) {
+    ChunkedServer state;
+    state.unsupportedStatus = status;
+    MockHttpServer server([&state](const Request& request) { return state.handle(request); });
+
+    ChunkedUploader uploader;
+    FinishedSpy spy(&uploader);
+    uploader.start(server.url("/api/report/before/"), path);
+    QVERIFY(spy.wait());
+    QVERIFY2(spy.response().success, qPrintable(spy.response().errorMessage));
+
+    QCOMPARE(server.requests().size(), 2);
+    QCOMPARE(countRequests(server, "POST", "/chunked/"), 1);
+    QVERIFY(server.requests().last().header("Content-Type").startsWith("multipart/form-data"));
+    QVERIFY(state.posted.contains(data));
+    QCOMPARE(uploader.bytesSent(), qint64(data.size()));
+    QVERIFY(!QFile::exists(path + ".upload"));
+  }
+}
+
+void TestManualAppCore::dedupUploadSendsOnlyMissingChunks()
+{
+  const QString path = m_dir.filePath("dedup.zip");
+  const QByteArray data = randomBytes(1024 * 1024, 4);
+  QVERIFY(writeFile(path, data));
+
+  const ContentChunker::Result split = ContentChunker::split(path);
+  QVERIFY(split.error.isEmpty());
+  QVERIFY(split.chunks.size() > 3);
+  for (const ContentChunker::Chunk& chunk : split.chunks) {
+    QVERIFY(chunk.size >= ContentChunker::MinChunkSize || chunk.offset + chunk.size == data.size());
+    QVERIFY(chunk.size <= ContentChunker::MaxChunkSize);
+  }
+
+  // The server already holds the first two chunks, e.g. from the before_to archive
+  DedupServer state;
+  for (int i = 0; i < 2; ++i) {
+    const ContentChunker::Chunk& chunk = split.chunks.at(i);
+    state.chunks.insert(chunk.sha256.toHex(), data.mid(chunk.offset, chunk.size));
+  }
+  MockHttpServer server([&state](const Request& request) { return state.handle(request); });
+
+  DedupUploader uploader;
+  FinishedSpy spy(&uploader);
+  uploader.start(server.url("/api/report/after/"), path);
+  QVERIFY(spy.wait());
+  QVERIFY2(spy.response().success, qPrintable(spy.response().errorMessage));
+
+  QCOMPARE(state.assembled, data);
+  QCOMPARE(countRequests(server, "PUT", "/dedup/chunks/"), int(split.chunks.size()) - 2);
+  QCOMPARE(uploader.bytesSkipped(), split.chunks.at(0).size + split.chunks.at(1).size);
+}
+
+void TestManualAppCore::dedupUploadResendsChunksDroppedByServer()
+{
+  const QString path = m_dir.filePath("dropped.zip");
+  const QByteArray data = randomBytes(768 * 1024, 5);
+  QVERIFY(writeFile(path, data));
+
+  DedupServer state;
+  MockHttpServer server([&state](const Request& request) { return state.handle(request); });
+  {
+    DedupUploader uploader;
+    FinishedSpy spy(&uploader);
+    uploader.start(server.url("/api/report/before/"), path);
+    QVERIFY(spy.wait());
+    QVERIFY(spy.response().success);
+  }
+
+  // The chunk index lists every chunk for this server now, but the server lost one of them
+  const ContentChunker::Result split = ContentChunker::split(path);
+  state.chunks.remove(split.chunks.last().sha256.toHex());
+  state.assembled.clear();
+  server.clearRequests();
+
+  DedupUploader uploader;
+  FinishedSpy spy(&uploader);
+  uploader.start(server.url("/api/report/before/"), path);
+  QVERIFY(spy.wait());
+  QVERIFY2(spy.response().success, qPrintable(spy.response().errorMessage));
+
+  QCOMPARE(state.assembled, data);
+  QCOMPARE(countRequests(server, "POST", "/dedup/missing/"), 0);
+  QCOMPARE(countRequests(server, "POST", "/dedup/manifest/"), 2);
+  QCOMPARE(countRequests(server, "PUT", "/dedup/chunks/"), 1);
+}
+
+void TestManualAppCore::downloadResumesPartAndReplacesFile()
+{
+  const QString path = m_dir.filePath("installer.exe");
+  const QByteArray data = randomBytes(1024 * 1024, 8);
+  QVERIFY(writeFile(path, "previous installer"));
+
+  DownloadServer state;
+  state.file = data;
+  MockHttpServer server([&state](const Request& request) { return state.handle(request); });
+  const QUrl url = server.url("/api/apps/download");
+
+  // An earlier attempt stopped after the first 300 KB
+  const qint64 kept = 300 * 1024;
+  QVERIFY(writeFile(path + ".part", data.left(kept)));
+  QVERIFY(writeFile(path + ".part.meta", QJsonDocument(QJsonObject{{"url", url.toString()},
+                                                                   {"validator", "\"v1\""},
+                                                                   {"sha256", QString(sha256Hex(data))}})
+                                             .toJson()));
+
+  HttpClient client;
+  FinishedSpy spy(&client);
+  client.download(url, path);
+  QVERIFY(spy.wait());
+  QVERIFY2(spy.response().success, qPrintable(spy.response().errorMessage));
+
+  QCOMPARE(server.requests().size(), 1);
+  QCOMPARE(server.requests().first().header("Range"), "bytes=" + QByteArray::number(kept) + "-");
+  QCOMPARE(server.requests().first().header("If-Range"), QByteArray("\"v1\""));
+  QFile file(path);
+  QVERIFY(file.open(QIODevice::ReadOnly));
+  QCOMPARE(file.readAll(), data);
+  QVERIFY(!QFile::exists(path + ".part"));
+  QVERIFY(!QFile::exists(path + ".part.meta"));
+}
+
+void TestManualAppCore::downloadFailsWithoutChecksum()
+{
+  const QString path = m_dir.filePath("unverified.exe");
+
+  DownloadServer state;
+  state.file = randomBytes(64 * 1024, 9);
+  state.announceChecksum = false;
+  MockHttpServer server([&state](const Request& request) { return state.handle(request); });
+
+  HttpClient client;
+  FinishedSpy spy(&client);
+  client.download(server.url("/api/apps/download"), path);
+  QVERIFY(spy.wait());
+  QVERIFY(!spy.response().success);
+
+  // Nothing unverified is left where installerExists() would find it
+  QVERIFY(!QFile::exists(path));
+  QVERIFY(!QFile::exists(path + ".part"));
+}
+
+QTEST_GUILESS_MAIN(TestManualAppCore)
+#include "tst_manualappcore.moc"